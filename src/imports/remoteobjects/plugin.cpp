@@ -40,7 +40,12 @@
 #include <QtRemoteObjects/qremoteobjectnode.h>
 #include <QtRemoteObjects/qremoteobjectsettingsstore.h>
 #include <QtRemoteObjects/qremoteobjectpendingcall.h>
-#include <QTimer>
+#include <QtRemoteObjects/private/qremoteobjectpendingcall_p.h>
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QMultiMap>
+#include <QPointer>
+#include <QTimerEvent>
 #include <QQmlExtensionPlugin>
 #include <QJSValue>
 #include <QtQml/private/qjsvalue_p.h>
@@ -52,7 +57,8 @@ QT_BEGIN_NAMESPACE
 
 struct QtQmlRemoteObjectsResponse {
     QJSValue promise;
-    QTimer *timer;
+    QRemoteObjectPendingCall call;
+    qint64 deadline;
 };
 
 
@@ -61,65 +67,89 @@ class QtQmlRemoteObjects : public QObject
 {
     Q_OBJECT
 public:
-    ~QtQmlRemoteObjects() {
-        auto i = m_callbacks.begin();
-        while (i != m_callbacks.end()) {
-            delete i.key();
-            delete i.value().timer;
-            i = m_callbacks.erase(i);
-        }
+    QtQmlRemoteObjects() {
+        m_clock.start();
     }
 
     Q_INVOKABLE QJSValue watch(const QRemoteObjectPendingCall &reply, int timeout = 30000) {
         if (m_accessiblePromise.isUndefined())
             m_accessiblePromise = qmlEngine(this)->evaluate("(function() { var obj = {}; obj.promise = new Promise(function(resolve, reject) { obj.resolve = resolve; obj.reject = reject; }); return obj; })");
 
-        QRemoteObjectPendingCallWatcher *watcher = new QRemoteObjectPendingCallWatcher(reply);
-
         QJSValue promise = m_accessiblePromise.call();
+        const quint64 id = ++m_lastId;
         QtQmlRemoteObjectsResponse response;
         response.promise = promise;
-        response.timer = new QTimer();
-        response.timer->setSingleShot(true);
-        m_callbacks.insert(watcher, response);
-
-        // handle timeout
-        connect(response.timer, &QTimer::timeout, [this, watcher]() {
-            auto i = m_callbacks.find(watcher);
-            if (i == m_callbacks.end()) {
-                qmlWarning(this) << "could not find callback for watcher.";
-                return;
-            }
+        response.call = reply;
+        response.deadline = m_clock.elapsed() + timeout;
+        m_callbacks.insert(id, response);
+
+        // handle success, replies are delivered queued like QRemoteObjectPendingCallWatcher does
+        auto data = QRemoteObjectPendingCallData::get(reply);
+        QPointer<QtQmlRemoteObjects> self(this);
+        const bool pending = data && data->addFinishedCallback([self, id]() {
+            if (self)
+                QMetaObject::invokeMethod(self.data(), [self, id]() { self->resolve(id); }, Qt::QueuedConnection);
+        });
+        if (!pending) {
+            QMetaObject::invokeMethod(this, [this, id]() { resolve(id); }, Qt::QueuedConnection);
+            return promise.property("promise");
+        }
 
-            QJSValue v(QLatin1String("timeout"));
-            i.value().promise.property("reject").call(QJSValueList() << v);
+        // handle timeout, all calls share a single timer firing for the earliest deadline
+        m_deadlines.insert(response.deadline, id);
+        if (m_deadlines.firstKey() == response.deadline)
+            scheduleTimeout();
+        return promise.property("promise");
+    }
 
-            delete i.key();
-            delete i.value().timer;
+protected:
+    void timerEvent(QTimerEvent *event) override {
+        if (event->timerId() != m_timeoutTimer.timerId())
+            return QObject::timerEvent(event);
+
+        m_timeoutTimer.stop();
+        const qint64 now = m_clock.elapsed();
+        while (!m_deadlines.isEmpty() && m_deadlines.firstKey() <= now) {
+            const quint64 id = m_deadlines.first();
+            m_deadlines.erase(m_deadlines.begin());
+            auto i = m_callbacks.find(id);
+            if (i == m_callbacks.end())
+                continue;
+            const QJSValue promise = i.value().promise;
             m_callbacks.erase(i);
-        });
+            QJSValue v(QLatin1String("timeout"));
+            promise.property("reject").call(QJSValueList() << v);
+        }
+        scheduleTimeout();
+    }
 
-        // handle success
-        connect(watcher, &QRemoteObjectPendingCallWatcher::finished, [this](QRemoteObjectPendingCallWatcher *self) {
-            auto i = m_callbacks.find(self);
-            if (i == m_callbacks.end()) {
-                qmlWarning(this) << "could not find callback for watcher.";
-                return;
-            }
-            QJSValue v =  qmlEngine(this)->toScriptValue(self->returnValue());
-            i.value().promise.property("resolve").call(QJSValueList() << v);
-
-            delete i.key();
-            delete i.value().timer;
-            m_callbacks.erase(i);
-        });
+private:
+    void resolve(quint64 id) {
+        auto i = m_callbacks.find(id);
+        if (i == m_callbacks.end())
+            return; // timed out already
+
+        const QtQmlRemoteObjectsResponse response = i.value();
+        m_callbacks.erase(i);
+        m_deadlines.remove(response.deadline, id);
+        QJSValue v =  qmlEngine(this)->toScriptValue(response.call.returnValue());
+        response.promise.property("resolve").call(QJSValueList() << v);
+    }
 
-        response.timer->start(timeout);
-        return promise.property("promise");
+    void scheduleTimeout() {
+        if (m_deadlines.isEmpty()) {
+            m_timeoutTimer.stop();
+            return;
+        }
+        const qint64 remaining = m_deadlines.firstKey() - m_clock.elapsed();
+        m_timeoutTimer.start(int(qMax<qint64>(0, remaining)), this);
     }
 
-private:
-    QHash<QRemoteObjectPendingCallWatcher*,QtQmlRemoteObjectsResponse> m_callbacks;
+    QHash<quint64, QtQmlRemoteObjectsResponse> m_callbacks;
+    QMultiMap<qint64, quint64> m_deadlines;
+    QBasicTimer m_timeoutTimer;
+    QElapsedTimer m_clock;
+    quint64 m_lastId = 0;
     QJSValue m_accessiblePromise;
 };
 
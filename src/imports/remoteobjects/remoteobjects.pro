@@ -3,7 +3,7 @@ TARGET = qtremoteobjects
 TARGETPATH = QtRemoteObjects
 IMPORT_VERSION = 5.$$QT_MINOR_VERSION
 
-QT += qml qml-private remoteobjects
+QT += qml qml-private remoteobjects remoteobjects-private
 
 SOURCES = \
     $$PWD/plugin.cpp \
@@ -0,0 +1,595 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtRemoteObjects module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qconnection_epoll_backend_p.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qsocketnotifier.h>
+#include <QtCore/private/qcore_unix_p.h>
+#include <QtNetwork/qhostinfo.h>
+
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+// Events handled per epoll_wait(), and bytes read from one connection in a
+// pass; what is left is handled in the next pass, as epoll is level triggered
+static const int maxEvents = 256;
+static const qsizetype readChunkSize = 64 * 1024;
+static const qsizetype maxReadPerPass = 4 * readChunkSize;
+
+EpollSocket::EpollSocket(int fd, bool local, const QString &peerAddress, EpollServerImpl *server)
+    : QIODevice(server)
+    , m_fd(fd)
+    , m_local(local)
+    , m_peerAddress(peerAddress)
+    , m_server(server)
+{
+    QIODevice::open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+
+EpollSocket::~EpollSocket()
+{
+    if (m_server)
+        m_server->closeSocket(this, false);
+    else if (m_fd >= 0)
+        qt_safe_close(m_fd);
+}
+
+bool EpollSocket::isSequential() const
+{
+    return true;
+}
+
+qint64 EpollSocket::bytesAvailable() const
+{
+    return m_readBuffer.size() - m_readOffset + QIODevice::bytesAvailable();
+}
+
+qint64 EpollSocket::bytesToWrite() const
+{
+    return m_writeBuffer.size() - m_writeOffset;
+}
+
+void EpollSocket::close()
+{
+    if (m_server && m_fd >= 0) {
+        // Like QAbstractSocket::disconnectFromHost(), try to send what is left,
+        // and tell the host the connection is gone
+        m_server->sendPending(this);
+        m_server->closeSocket(this, true);
+    }
+    QIODevice::close();
+}
+
+qint64 EpollSocket::readData(char *data, qint64 maxSize)
+{
+    const qint64 available = m_readBuffer.size() - m_readOffset;
+    if (available == 0)
+        return m_fd < 0 ? -1 : 0;
+    const qint64 size = qMin(maxSize, available);
+    memcpy(data, m_readBuffer.constData() + m_readOffset, size_t(size));
+    m_readOffset += size;
+    if (m_readOffset == m_readBuffer.size()) {
+        m_readBuffer.clear();
+        m_readOffset = 0;
+    }
+    return size;
+}
+
+qint64 EpollSocket::writeData(const char *data, qint64 size)
+{
+    if (m_fd < 0)
+        return -1;
+    m_writeBuffer.append(data, size);
+    if (!m_flushPending && m_server)
+        m_server->scheduleFlush(this);
+    return size;
+}
+
+
+EpollServerIo::EpollServerIo(EpollSocket *conn, QObject *parent)
+    : ServerIoDevice(parent), m_connection(conn)
+{
+    m_connection->setParent(this);
+    connect(conn, &QIODevice::readyRead, this, &ServerIoDevice::readyRead);
+    connect(conn, &EpollSocket::disconnected, this, &ServerIoDevice::disconnected);
+}
+
+QIODevice *EpollServerIo::connection() const
+{
+    return m_connection;
+}
+
+bool EpollServerIo::isLocal() const
+{
+    return m_connection->isLocal();
+}
+
+QString EpollServerIo::peerAddress() const
+{
+    return m_connection->peerAddress();
+}
+
+void EpollServerIo::doClose()
+{
+    m_connection->close();
+}
+
+
+
+EpollServerImpl::EpollServerImpl(QObject *parent)
+    : QConnectionAbstractServer(parent)
+    , m_epollFd(epoll_create1(EPOLL_CLOEXEC))
+{
+    if (m_epollFd < 0) {
+        qCWarning(QT_REMOTEOBJECT) << "Could not create an epoll instance:" << qt_error_string(errno);
+        setError(errno);
+        return;
+    }
+    m_notifier = new QSocketNotifier(m_epollFd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &EpollServerImpl::processEvents);
+}
+
+EpollServerImpl::~EpollServerImpl()
+{
+    close();
+    // Connections still open stop being served, as they have no event loop
+    // without the server
+    for (EpollSocket *socket : qAsConst(m_sockets)) {
+        qt_safe_close(socket->m_fd);
+        socket->m_fd = -1;
+        socket->m_server = nullptr;
+    }
+    if (m_epollFd >= 0)
+        qt_safe_close(m_epollFd);
+}
+
+ServerIoDevice *EpollServerImpl::configureNewConnection()
+{
+    if (m_listenFd < 0 || m_pending.isEmpty())
+        return nullptr;
+
+    return new EpollServerIo(m_pending.takeFirst());
+}
+
+bool EpollServerImpl::hasPendingConnections() const
+{
+    return !m_pending.isEmpty();
+}
+
+QUrl EpollServerImpl::address() const
+{
+    return m_address;
+}
+
+bool EpollServerImpl::listen(const QUrl &address)
+{
+    if (m_epollFd < 0)
+        return false;
+    close();
+
+    const bool local = address.scheme().startsWith(QRemoteObjectStringLiterals::local());
+    const int fd = local ? bindLocal(address) : bindTcp(address);
+    if (fd < 0)
+        return false;
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (::listen(fd, SOMAXCONN) < 0 || epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        setError(errno);
+        qt_safe_close(fd);
+        if (!m_localPath.isEmpty()) {
+            ::unlink(m_localPath.constData());
+            m_localPath.clear();
+        }
+        return false;
+    }
+    m_listenFd = fd;
+    return true;
+}
+
+int EpollServerImpl::bindTcp(const QUrl &address)
+{
+    QHostAddress host(address.host());
+    if (host.isNull()) {
+        if (address.host().isEmpty()) {
+            host = QHostAddress::Any;
+        } else {
+            qCWarning(QT_REMOTEOBJECT) << address.host() << " is not an IP address, trying to resolve it";
+            QHostInfo info = QHostInfo::fromName(address.host());
+            if (info.addresses().isEmpty())
+                host = QHostAddress::Any;
+            else
+                host = info.addresses().constFirst();
+        }
+    }
+
+    sockaddr_storage storage = {};
+    socklen_t length;
+    if (host.protocol() == QAbstractSocket::IPv4Protocol) {
+        auto addr = reinterpret_cast<sockaddr_in *>(&storage);
+        addr->sin_family = AF_INET;
+        addr->sin_port = htons(quint16(address.port()));
+        addr->sin_addr.s_addr = htonl(host.toIPv4Address());
+        length = sizeof(sockaddr_in);
+    } else {
+        auto addr = reinterpret_cast<sockaddr_in6 *>(&storage);
+        addr->sin6_family = AF_INET6;
+        addr->sin6_port = htons(quint16(address.port()));
+        if (host.protocol() == QAbstractSocket::IPv6Protocol) {
+            const Q_IPV6ADDR ip6 = host.toIPv6Address();
+            memcpy(&addr->sin6_addr, &ip6, sizeof(ip6));
+            addr->sin6_scope_id = host.scopeId().toUInt();
+        } else {
+            addr->sin6_addr = in6addr_any;
+        }
+        length = sizeof(sockaddr_in6);
+    }
+
+    const int fd = ::socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        setError(errno);
+        return -1;
+    }
+    const int on = 1;
+    const int off = 0;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (host.protocol() == QAbstractSocket::AnyIPProtocol)
+        ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&storage), length) < 0
+            || ::getsockname(fd, reinterpret_cast<sockaddr *>(&storage), &length) < 0) {
+        setError(errno);
+        qt_safe_close(fd);
+        return -1;
+    }
+
+    const quint16 port = ntohs(storage.ss_family == AF_INET
+                               ? reinterpret_cast<sockaddr_in *>(&storage)->sin_port
+                               : reinterpret_cast<sockaddr_in6 *>(&storage)->sin6_port);
+    m_address = QUrl();
+    m_address.setScheme(address.scheme());
+    m_address.setHost(host.toString());
+    m_address.setPort(port);
+    return fd;
+}
+
+int EpollServerImpl::bindLocal(const QUrl &address)
+{
+    // Names are resolved like QLocalServer does, so LocalClientIo connects
+    QString path = address.path();
+    if (!QDir::isAbsolutePath(path))
+        path = QDir::tempPath() + QLatin1Char('/') + path;
+    const QByteArray encodedPath = QFile::encodeName(path);
+
+    sockaddr_un addr = {};
+    if (address.path().isEmpty() || size_t(encodedPath.size()) >= sizeof(addr.sun_path)) {
+        qCWarning(QT_REMOTEOBJECT) << "Invalid local socket name" << address.path();
+        m_error = QAbstractSocket::HostNotFoundError;
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, encodedPath.constData(), size_t(encodedPath.size()));
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        setError(errno);
+        return -1;
+    }
+    int result = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    if (result < 0 && errno == EADDRINUSE) {
+        // Same as LocalServerImpl, a stale socket file is removed
+        ::unlink(encodedPath.constData());
+        result = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    }
+    if (result < 0) {
+        setError(errno);
+        qt_safe_close(fd);
+        return -1;
+    }
+
+    m_localPath = encodedPath;
+    m_address = QUrl();
+    m_address.setScheme(address.scheme());
+    m_address.setPath(address.path());
+    return fd;
+}
+
+QAbstractSocket::SocketError EpollServerImpl::serverError() const
+{
+    return m_error;
+}
+
+void EpollServerImpl::close()
+{
+    // Like QTcpServer, accepted connections stay open
+    if (m_listenFd >= 0) {
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, m_listenFd, nullptr);
+        qt_safe_close(m_listenFd);
+        m_listenFd = -1;
+    }
+    if (!m_localPath.isEmpty()) {
+        ::unlink(m_localPath.constData());
+        m_localPath.clear();
+    }
+}
+
+void EpollServerImpl::processEvents()
+{
+    epoll_event events[maxEvents];
+    int count;
+    EINTR_LOOP(count, epoll_wait(m_epollFd, events, maxEvents, 0));
+    if (count < 0) {
+        qCWarning(QT_REMOTEOBJECT) << "epoll_wait failed:" << qt_error_string(errno);
+        return;
+    }
+
+    QList<QPointer<EpollSocket>> readable;
+    QList<QPointer<EpollSocket>> lost;
+    for (int i = 0; i < count; ++i) {
+        const int fd = events[i].data.fd;
+        if (fd == m_listenFd) {
+            acceptConnections();
+            continue;
+        }
+        EpollSocket *socket = m_sockets.value(fd);
+        if (!socket)
+            continue;
+        bool open = true;
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            const qint64 available = socket->bytesAvailable();
+            open = readSocket(socket);
+            if (socket->bytesAvailable() > available)
+                readable << socket;
+        }
+        if (open && (events[i].events & EPOLLOUT))
+            open = writeSocket(socket);
+        if (!open)
+            lost << socket;
+    }
+
+    // Data that arrived with the end of a connection is delivered first
+    for (const QPointer<EpollSocket> &socket : qAsConst(readable)) {
+        if (socket)
+            emit socket->readyRead();
+    }
+    for (const QPointer<EpollSocket> &socket : qAsConst(lost)) {
+        if (socket)
+            closeSocket(socket, true);
+    }
+}
+
+void EpollServerImpl::acceptConnections()
+{
+    int accepted = 0;
+    forever {
+        int fd;
+        sockaddr_storage storage = {};
+        socklen_t length = sizeof(storage);
+        EINTR_LOOP(fd, ::accept4(m_listenFd, reinterpret_cast<sockaddr *>(&storage), &length,
+                                 SOCK_NONBLOCK | SOCK_CLOEXEC));
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                qCWarning(QT_REMOTEOBJECT) << "Could not accept a connection:" << qt_error_string(errno);
+            break;
+        }
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            qCWarning(QT_REMOTEOBJECT) << "Could not watch a connection:" << qt_error_string(errno);
+            qt_safe_close(fd);
+            continue;
+        }
+        const bool local = storage.ss_family == AF_UNIX;
+        QString peerAddress;
+        if (!local) {
+            const QHostAddress host(reinterpret_cast<sockaddr *>(&storage));
+            const quint16 port = ntohs(storage.ss_family == AF_INET
+                                       ? reinterpret_cast<sockaddr_in *>(&storage)->sin_port
+                                       : reinterpret_cast<sockaddr_in6 *>(&storage)->sin6_port);
+            peerAddress = QStringLiteral("%1:%2").arg(host.toString()).arg(port);
+        }
+        auto socket = new EpollSocket(fd, local, peerAddress, this);
+        m_sockets.insert(fd, socket);
+        m_pending.append(socket);
+        ++accepted;
+    }
+    while (accepted--)
+        emit newConnection();
+}
+
+bool EpollServerImpl::readSocket(EpollSocket *socket)
+{
+    QByteArray &buffer = socket->m_readBuffer;
+    if (socket->m_readOffset > 0) {
+        buffer.remove(0, socket->m_readOffset);
+        socket->m_readOffset = 0;
+    }
+
+    qsizetype received = 0;
+    while (received < maxReadPerPass) {
+        const qsizetype size = buffer.size();
+        buffer.resize(size + readChunkSize);
+        ssize_t result;
+        EINTR_LOOP(result, ::recv(socket->m_fd, buffer.data() + size, size_t(readChunkSize), 0));
+        buffer.resize(size + qMax<qsizetype>(result, 0));
+        if (result == 0)
+            return false;
+        if (result < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        received += result;
+        // A short read means the socket is drained, saves the EAGAIN round
+        if (result < readChunkSize)
+            break;
+    }
+    return true;
+}
+
+qint64 EpollServerImpl::sendPending(EpollSocket *socket)
+{
+    QByteArray &buffer = socket->m_writeBuffer;
+    qint64 written = 0;
+    while (socket->m_writeOffset < buffer.size()) {
+        ssize_t result;
+        EINTR_LOOP(result, ::send(socket->m_fd, buffer.constData() + socket->m_writeOffset,
+                                  size_t(buffer.size() - socket->m_writeOffset), MSG_NOSIGNAL));
+        if (result < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return -1;
+        }
+        socket->m_writeOffset += result;
+        written += result;
+    }
+    if (socket->m_writeOffset == buffer.size()) {
+        buffer.clear();
+        socket->m_writeOffset = 0;
+    } else if (socket->m_writeOffset > buffer.size() / 2) {
+        buffer.remove(0, socket->m_writeOffset);
+        socket->m_writeOffset = 0;
+    }
+    return written;
+}
+
+bool EpollServerImpl::writeSocket(EpollSocket *socket)
+{
+    if (socket->m_fd < 0)
+        return true;
+    const qint64 written = sendPending(socket);
+    if (written < 0)
+        return false;
+    // The rest is sent when the connection can take it again
+    watchWrite(socket, socket->bytesToWrite() > 0);
+    if (written > 0)
+        emit socket->bytesWritten(written);
+    return true;
+}
+
+void EpollServerImpl::watchWrite(EpollSocket *socket, bool watch)
+{
+    if (socket->m_watchesWrite == watch)
+        return;
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP | (watch ? EPOLLOUT : 0);
+    event.data.fd = socket->m_fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, socket->m_fd, &event) == 0)
+        socket->m_watchesWrite = watch;
+}
+
+void EpollServerImpl::scheduleFlush(EpollSocket *socket)
+{
+    socket->m_flushPending = true;
+    m_unflushed.append(socket);
+    if (m_flushScheduled)
+        return;
+    m_flushScheduled = true;
+    QMetaObject::invokeMethod(this, &EpollServerImpl::flushWrites, Qt::QueuedConnection);
+}
+
+void EpollServerImpl::flushWrites()
+{
+    // All packets written to a connection since the last pass go out with one
+    // send, and property changes fanned out to many listeners with one pass.
+    // Writes done while flushing, e.g. by bytesWritten(), go to the next pass.
+    m_flushScheduled = false;
+    const QList<EpollSocket *> unflushed = std::exchange(m_unflushed, {});
+    QList<QPointer<EpollSocket>> lost;
+    for (EpollSocket *socket : unflushed)
+        socket->m_flushPending = false;
+    for (EpollSocket *socket : unflushed) {
+        // Waiting for EPOLLOUT, there is no point in trying before
+        if (socket->m_watchesWrite)
+            continue;
+        if (!writeSocket(socket))
+            lost << socket;
+    }
+    for (const QPointer<EpollSocket> &socket : qAsConst(lost)) {
+        if (socket)
+            closeSocket(socket, true);
+    }
+}
+
+void EpollServerImpl::closeSocket(EpollSocket *socket, bool notify)
+{
+    m_pending.removeOne(socket);
+    m_unflushed.removeOne(socket);
+    if (socket->m_fd < 0)
+        return;
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, socket->m_fd, nullptr);
+    m_sockets.remove(socket->m_fd);
+    qt_safe_close(socket->m_fd);
+    socket->m_fd = -1;
+    if (notify)
+        emit socket->disconnected();
+}
+
+void EpollServerImpl::setError(int error)
+{
+    switch (error) {
+    case EADDRINUSE:
+        m_error = QAbstractSocket::AddressInUseError;
+        break;
+    case EACCES:
+    case EPERM:
+        m_error = QAbstractSocket::SocketAccessError;
+        break;
+    case EADDRNOTAVAIL:
+        m_error = QAbstractSocket::SocketAddressNotAvailableError;
+        break;
+    case EMFILE:
+    case ENFILE:
+    case ENOBUFS:
+    case ENOMEM:
+        m_error = QAbstractSocket::SocketResourceError;
+        break;
+    default:
+        m_error = QAbstractSocket::UnknownSocketError;
+        break;
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,172 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtRemoteObjects module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCONNECTIONEPOLLBACKEND_P_H
+#define QCONNECTIONEPOLLBACKEND_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qconnectionfactories_p.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qpointer.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSocketNotifier;
+class EpollServerImpl;
+
+// A connection accepted by an EpollServerImpl. Reading and writing only use
+// the buffers, the server moves the data of all its connections when its
+// epoll descriptor is ready and once per event loop pass.
+class EpollSocket final : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    EpollSocket(int fd, bool local, const QString &peerAddress, EpollServerImpl *server);
+    ~EpollSocket() override;
+
+    bool isSequential() const override;
+    qint64 bytesAvailable() const override;
+    qint64 bytesToWrite() const override;
+    void close() override;
+
+    // Accepted on a local+epoll server
+    bool isLocal() const { return m_local; }
+    QString peerAddress() const { return m_peerAddress; }
+
+Q_SIGNALS:
+    void disconnected();
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 size) override;
+
+private:
+    friend class EpollServerImpl;
+
+    int m_fd;
+    bool m_local;
+    QString m_peerAddress;
+    bool m_flushPending = false;
+    bool m_watchesWrite = false;
+    QPointer<EpollServerImpl> m_server;
+    QByteArray m_readBuffer;
+    qsizetype m_readOffset = 0;
+    QByteArray m_writeBuffer;
+    qsizetype m_writeOffset = 0;
+};
+
+class EpollServerIo final : public ServerIoDevice
+{
+    Q_OBJECT
+public:
+    explicit EpollServerIo(EpollSocket *conn, QObject *parent = nullptr);
+
+    QIODevice *connection() const override;
+    bool isLocal() const override;
+    QString peerAddress() const override;
+protected:
+    void doClose() override;
+
+private:
+    EpollSocket *m_connection;
+};
+
+// Serves the tcp+epoll and local+epoll schemes. All connections of the server
+// are watched by one epoll descriptor, which is the only descriptor the event
+// loop sees, and the writes of a pass are sent together.
+class EpollServerImpl final : public QConnectionAbstractServer
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(EpollServerImpl)
+
+public:
+    explicit EpollServerImpl(QObject *parent);
+    ~EpollServerImpl() override;
+
+    bool hasPendingConnections() const override;
+    ServerIoDevice *configureNewConnection() override;
+    QUrl address() const override;
+    bool listen(const QUrl &address) override;
+    QAbstractSocket::SocketError serverError() const override;
+    void close() override;
+
+private:
+    friend class EpollSocket;
+
+    int bindTcp(const QUrl &address);
+    int bindLocal(const QUrl &address);
+    void processEvents();
+    void acceptConnections();
+    // Both return false if the connection is lost
+    bool readSocket(EpollSocket *socket);
+    bool writeSocket(EpollSocket *socket);
+    qint64 sendPending(EpollSocket *socket);
+    void watchWrite(EpollSocket *socket, bool watch);
+    void scheduleFlush(EpollSocket *socket);
+    void flushWrites();
+    void closeSocket(EpollSocket *socket, bool notify);
+    void setError(int error);
+
+    int m_epollFd;
+    int m_listenFd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    QHash<int, EpollSocket *> m_sockets;
+    QList<EpollSocket *> m_pending;
+    QList<EpollSocket *> m_unflushed;
+    bool m_flushScheduled = false;
+    QUrl m_address;
+    QByteArray m_localPath;
+    QAbstractSocket::SocketError m_error = QAbstractSocket::UnknownSocketError;
+};
+
+QT_END_NAMESPACE
+#endif // QCONNECTIONEPOLLBACKEND_P_H
@@ -40,10 +40,17 @@
 #include "qconnectionfactories_p.h"
 #include "qconnectionfactories_p.h"
 
+#include <QtCore/qendian.h>
+
+#include <utility>
+
 // BEGIN: Backends
 #if defined(Q_OS_QNX)
 #include "qconnection_qnx_backend_p.h"
 #endif
+#if defined(Q_OS_LINUX)
+#include "qconnection_epoll_backend_p.h"
+#endif
 #include "qconnection_local_backend_p.h"
 #include "qconnection_tcpip_backend_p.h"
 // END: Backends
@@ -78,6 +85,13 @@ inline bool fromDataStream(QDataStream &in, QRemoteObjectPacketTypeEnum &type, Q
     case ObjectList: type = ObjectList; break;
     case Ping: type = Ping; break;
     case Pong: type = Pong; break;
+    case Pause: type = Pause; break;
+    case Resume: type = Resume; break;
+    case InvokeErrorPacket: type = InvokeErrorPacket; break;
+    case SharedStatePacket: type = SharedStatePacket; break;
+    case MulticastPacket: type = MulticastPacket; break;
+    case BatchInvokePacket: type = BatchInvokePacket; break;
+    case BatchReplyPacket: type = BatchReplyPacket; break;
     default:
         qCWarning(QT_REMOTEOBJECT_IO) << "Invalid packet received" << _type;
     }
@@ -106,36 +120,180 @@ IoDeviceBase::~IoDeviceBase()
 {
 }
 
+IoDeviceBase::ReadStatus IoDeviceBase::readNext()
+{
+    while (true) {
+        if (m_curReadSize == 0) {
+            if (bytesAvailable() < static_cast<int>(sizeof(quint32)))
+                return ReadStatus::Incomplete;
+
+            quint32 header;
+            m_dataStream >> header;
+            m_curFragmentFlags = header & (moreFragmentsFlag | lastFragmentFlag);
+            m_curReadSize = m_curFragmentFlags ? header & fragmentSizeMask : header;
+
+            // Checked before anything is buffered for the packet
+            const char *error = nullptr;
+            if (m_curFragmentFlags == (moreFragmentsFlag | lastFragmentFlag))
+                error = "Invalid fragment";
+            else if (m_curFragmentFlags && (m_curReadSize == 0 || m_curReadSize > m_maxFrameSize))
+                error = "Fragment exceeds the maximum frame size";
+            else if (!m_curFragmentFlags && !m_fragments.isEmpty())
+                error = "Packet received between fragments";
+            else if (!m_curFragmentFlags && m_curReadSize < sizeof(quint16))
+                error = "Packet too small";
+            else if (m_curFragmentFlags && m_maxMessageSize
+                     && quint64(m_fragments.size()) + m_curReadSize > m_maxMessageSize)
+                error = "Fragmented packet exceeds the maximum message size";
+            if (error) {
+                qCWarning(QT_REMOTEOBJECT_IO) << deviceType() << error << m_curReadSize << "closing connection";
+                m_curReadSize = 0;
+                m_fragments.clear();
+                close();
+                return ReadStatus::Error;
+            }
+        }
+
+        qCDebug(QT_REMOTEOBJECT_IO) << deviceType() << "read()-looking for map" << m_curReadSize << bytesAvailable();
+
+        if (bytesAvailable() < m_curReadSize)
+            return ReadStatus::Incomplete;
+
+        if (!m_curFragmentFlags)
+            return ReadStatus::Packet;
+
+        // Move the fragment out of the device, so only one frame is buffered there
+        m_fragments.append(connection()->read(m_curReadSize));
+        m_curReadSize = 0;
+        if (m_curFragmentFlags == lastFragmentFlag)
+            return ReadStatus::Reassembled;
+    }
+}
+
+void IoDeviceBase::releaseReassembled()
+{
+    if (m_dataStream.device() != &m_reassembled)
+        return;
+    m_reassembled.close();
+    m_reassembled.setData(QByteArray());
+    m_dataStream.setDevice(connection());
+}
+
 bool IoDeviceBase::read(QRemoteObjectPacketTypeEnum &type, QString &name)
 {
     qCDebug(QT_REMOTEOBJECT_IO) << deviceType() << "read()" << m_curReadSize << bytesAvailable();
 
-    if (m_curReadSize == 0) {
-        if (bytesAvailable() < static_cast<int>(sizeof(quint32)))
-            return false;
+    // The previous packet was reassembled and has been handled by now
+    releaseReassembled();
 
-        m_dataStream >> m_curReadSize;
+    switch (readNext()) {
+    case ReadStatus::Incomplete:
+    case ReadStatus::Error:
+        return false;
+    case ReadStatus::Packet:
+        m_curReadSize = 0;
+        return fromDataStream(m_dataStream, type, name);
+    case ReadStatus::Reassembled:
+        break;
     }
 
-    qCDebug(QT_REMOTEOBJECT_IO) << deviceType() << "read()-looking for map" << m_curReadSize << bytesAvailable();
-
-    if (bytesAvailable() < m_curReadSize)
+    // Parse the reassembled packet like one read from the device
+    m_reassembled.setData(std::exchange(m_fragments, QByteArray()));
+    m_reassembled.open(QIODevice::ReadOnly);
+    m_dataStream.setDevice(&m_reassembled);
+    quint32 size;
+    m_dataStream >> size;
+    if (size != m_reassembled.size() - qint64(sizeof(quint32))) {
+        qCWarning(QT_REMOTEOBJECT_IO) << deviceType() << "Invalid reassembled packet, closing connection";
+        releaseReassembled();
+        close();
         return false;
-
-    m_curReadSize = 0;
+    }
     return fromDataStream(m_dataStream, type, name);
 }
 
+bool IoDeviceBase::readPacket(QByteArray &packet)
+{
+    releaseReassembled();
+
+    switch (readNext()) {
+    case ReadStatus::Incomplete:
+    case ReadStatus::Error:
+        return false;
+    case ReadStatus::Packet:
+        packet.resize(qsizetype(sizeof(quint32)) + m_curReadSize);
+        qToBigEndian(m_curReadSize, packet.data());
+        connection()->read(packet.data() + sizeof(quint32), m_curReadSize);
+        m_curReadSize = 0;
+        return true;
+    case ReadStatus::Reassembled:
+        packet = std::exchange(m_fragments, QByteArray());
+        if (packet.size() >= qsizetype(sizeof(quint32))
+                && qFromBigEndian<quint32>(packet.constData()) == packet.size() - sizeof(quint32)) {
+            return true;
+        }
+        qCWarning(QT_REMOTEOBJECT_IO) << deviceType() << "Invalid reassembled packet, closing connection";
+        close();
+        return false;
+    }
+    return false;
+}
+
 void IoDeviceBase::write(const QByteArray &data)
 {
-    if (connection()->isOpen() && !m_isClosing)
-        connection()->write(data);
+    write(data, data.size());
 }
 
 void IoDeviceBase::write(const QByteArray &data, qint64 size)
 {
-    if (connection()->isOpen() && !m_isClosing)
-        connection()->write(data.data(), size);
+    if (!connection()->isOpen() || m_isClosing)
+        return;
+
+    if (!m_peerMaxFrameSize || size - qint64(sizeof(quint32)) <= m_peerMaxFrameSize) {
+        connection()->write(data.constData(), size);
+        return;
+    }
+
+    // data can hold more than one packet, only the large ones are fragmented
+    const char *packets = data.constData();
+    qint64 unwritten = 0;
+    qint64 pos = 0;
+    while (pos + qint64(sizeof(quint32)) <= size) {
+        const qint64 packetSize = qint64(sizeof(quint32)) + qFromBigEndian<quint32>(packets + pos);
+        if (packetSize - qint64(sizeof(quint32)) > m_peerMaxFrameSize) {
+            if (pos > unwritten)
+                connection()->write(packets + unwritten, pos - unwritten);
+            writeFragments(packets + pos, qMin(packetSize, size - pos));
+            unwritten = pos + packetSize;
+        }
+        pos += packetSize;
+    }
+    if (size > unwritten)
+        connection()->write(packets + unwritten, size - unwritten);
+}
+
+void IoDeviceBase::writeFragments(const char *data, qint64 size)
+{
+    qCDebug(QT_REMOTEOBJECT_IO) << deviceType() << "Fragmenting packet of" << size << "bytes";
+    while (size > 0) {
+        const quint32 fragmentSize = quint32(qMin(size, qint64(m_peerMaxFrameSize)));
+        size -= fragmentSize;
+        char header[sizeof(quint32)];
+        qToBigEndian(fragmentSize | (size ? moreFragmentsFlag : lastFragmentFlag), header);
+        connection()->write(header, sizeof(header));
+        connection()->write(data, fragmentSize);
+        data += fragmentSize;
+    }
+}
+
+void IoDeviceBase::setMaxFrameSize(quint32 size)
+{
+    m_maxFrameSize = size ? qMin(size, fragmentSizeMask) : defaultMaxFrameSize;
+}
+
+void IoDeviceBase::setPeerMaxFrameSize(quint32 size)
+{
+    m_peerMaxFrameSize = qMin(size, fragmentSizeMask);
 }
 
 void IoDeviceBase::close()
@@ -149,8 +307,27 @@ qint64 IoDeviceBase::bytesAvailable() const
     return connection()->bytesAvailable();
 }
 
+bool IoDeviceBase::isLocal() const
+{
+    return qobject_cast<QLocalSocket *>(connection());
+}
+
+QString IoDeviceBase::peerAddress() const
+{
+    if (auto socket = qobject_cast<QAbstractSocket *>(connection()))
+        return QStringLiteral("%1:%2").arg(socket->peerAddress().toString()).arg(socket->peerPort());
+    return QString();
+}
+
 void IoDeviceBase::initializeDataStream()
 {
+    // A new connection, its peer announces its frame size again
+    releaseReassembled();
+    m_fragments.clear();
+    m_peerMaxFrameSize = 0;
+    m_sequenced = false;
+    m_readsSharedState = false;
+    m_acceptsBatches = false;
     m_dataStream.setDevice(connection());
     m_dataStream.resetStatus();
 }
@@ -273,6 +450,10 @@ QtROServerFactory::QtROServerFactory()
 #endif
     registerType<LocalServerImpl>(QStringLiteral("local"));
     registerType<TcpServerImpl>(QStringLiteral("tcp"));
+#if defined(Q_OS_LINUX)
+    registerType<EpollServerImpl>(QStringLiteral("local+epoll"));
+    registerType<EpollServerImpl>(QStringLiteral("tcp+epoll"));
+#endif
 }
 
 QtROServerFactory *QtROServerFactory::instance()
@@ -292,6 +473,11 @@ QtROClientFactory::QtROClientFactory()
 #endif
     registerType<LocalClientIo>(QStringLiteral("local"));
     registerType<TcpClientIo>(QStringLiteral("tcp"));
+#if defined(Q_OS_LINUX)
+    // The epoll host uses the same wire format as the default backends
+    registerType<LocalClientIo>(QStringLiteral("local+epoll"));
+    registerType<TcpClientIo>(QStringLiteral("tcp+epoll"));
+#endif
 }
 
 QtROClientFactory *QtROClientFactory::instance()
@@ -52,6 +52,7 @@
 //
 
 #include <QtNetwork/qabstractsocket.h>
+#include <QtCore/qbuffer.h>
 #include <QtCore/qdatastream.h>
 #include <QtCore/qiodevice.h>
 #include <QtCore/qpointer.h>
@@ -64,6 +65,42 @@ namespace QtRemoteObjects {
 
 static const int dataStreamVersion = QDataStream::Qt_5_12;
 static const QLatin1String protocolVersion("QtRO 1.3");
+// Name of the Handshake packet announcing the maximum frame size of its sender
+static const QLatin1String frameSizeHandshake("QtRO max frame size ");
+// Name of the Handshake packet a node sends to get sequence numbers, and the
+// host sends back before the first sequenced packet
+static const QLatin1String sequenceHandshake("QtRO sequence numbers");
+// Name of the Handshake packet a node sends if it understands InvokeError
+// packets, else rejected calls are answered with an empty reply
+static const QLatin1String invokeErrorHandshake("QtRO invoke errors");
+// Name of the Handshake packet a node on a local socket sends if it can read
+// the property values of root objects from shared memory
+static const QLatin1String sharedStateHandshake("QtRO shared state");
+// Name of the Handshake packet a node sends if it can't attach to a shared
+// memory page, it then gets the values with the packets
+static const QLatin1String sharedStateUnavailableHandshake("QtRO shared state unavailable");
+// Name of the Handshake packet a node sends if it can receive property
+// changes as multicast datagrams
+static const QLatin1String multicastHandshake("QtRO multicast");
+// Name of the Handshake packet a node sends if it can send batches of calls,
+// and the host sends back if it runs them
+static const QLatin1String batchHandshake("QtRO batch calls");
+// Largest multicast datagram, the payload of an Ethernet frame. Larger
+// property changes are sent over the connections.
+static const int maxDatagramSize = 1472;
+// After a property change the host repeats the last sequence number this
+// often, so replicas see when the last datagrams were lost
+static const int multicastHeartbeatInterval = 500;
+static const int multicastHeartbeatCount = 3;
+
+// A packet larger than the maximum frame size of the peer is sent as fragments,
+// each with a 32-bit header holding its size and one of these flags
+static const quint32 moreFragmentsFlag = 0x80000000;
+static const quint32 lastFragmentFlag = 0x40000000;
+static const quint32 fragmentSizeMask = 0x3fffffff;
+// See QRemoteObjectNode::setMaxFrameSize() and setMaxMessageSize()
+static const quint32 defaultMaxFrameSize = 1024 * 1024;
+static const quint32 defaultMaxMessageSize = 64 * 1024 * 1024;
 
 }
 
@@ -77,6 +114,8 @@ public:
     ~IoDeviceBase() override;
 
     bool read(QtRemoteObjects::QRemoteObjectPacketTypeEnum &, QString &);
+    // Reads a whole packet, including its size, without parsing it
+    bool readPacket(QByteArray &packet);
 
     virtual void write(const QByteArray &data);
     virtual void write(const QByteArray &data, qint64);
@@ -84,6 +123,10 @@ public:
     virtual void close();
     virtual qint64 bytesAvailable() const;
     virtual QIODevice *connection() const = 0;
+    // The peer is on this machine, connected through a local socket
+    virtual bool isLocal() const;
+    // Address and port of a peer connected over the network, empty otherwise
+    virtual QString peerAddress() const;
     void initializeDataStream();
     QDataStream& stream() { return m_dataStream; }
     inline bool isClosing() const { return m_isClosing; }
@@ -91,6 +134,25 @@ public:
     void removeSource(const QString &);
     QSet<QString> remoteObjects() const;
 
+    // Packets larger than the frame size are received as fragments, if the
+    // peer supports them. Set before the handshake, the peer learns it then.
+    quint32 maxFrameSize() const { return m_maxFrameSize; }
+    void setMaxFrameSize(quint32 size);
+    // Bounds a reassembled packet, fragments are buffered until the last one
+    // arrives. 0 for no bound.
+    void setMaxMessageSize(quint32 size) { m_maxMessageSize = size; }
+    void setPeerMaxFrameSize(quint32 size);
+    // Property, signal, init and reply packets carry a sequence number
+    bool isSequenced() const { return m_sequenced; }
+    void setSequenced(bool sequenced) { m_sequenced = sequenced; }
+    // The peer reads root object properties from shared memory, see
+    // QRemoteObjectHostBase::setSharedStateEnabled(). On a node, it asked for them.
+    bool readsSharedState() const { return m_readsSharedState; }
+    void setReadsSharedState(bool reads) { m_readsSharedState = reads; }
+    // The peer runs batches of calls, see QRemoteObjectReplica::beginBatch()
+    bool acceptsBatches() const { return m_acceptsBatches; }
+    void setAcceptsBatches(bool accepts) { m_acceptsBatches = accepts; }
+
 Q_SIGNALS:
     void readyRead();
     void disconnected();
@@ -101,7 +163,21 @@ protected:
     bool m_isClosing;
 
 private:
+    enum class ReadStatus { Incomplete, Packet, Reassembled, Error };
+    ReadStatus readNext();
+    void releaseReassembled();
+    void writeFragments(const char *data, qint64 size);
+
     quint32 m_curReadSize;
+    quint32 m_curFragmentFlags = 0;
+    quint32 m_maxFrameSize = QtRemoteObjects::defaultMaxFrameSize;
+    quint32 m_maxMessageSize = QtRemoteObjects::defaultMaxMessageSize;
+    quint32 m_peerMaxFrameSize = 0; // 0 until the peer announces it reassembles fragments
+    bool m_sequenced = false;
+    bool m_readsSharedState = false;
+    bool m_acceptsBatches = false;
+    QByteArray m_fragments;
+    QBuffer m_reassembled;
     QDataStream m_dataStream;
     QSet<QString> m_remoteObjects;
 };
@@ -164,6 +240,7 @@ protected:
 
 private:
     friend class QtROClientFactory;
+    friend class SharedClientConnection;
 
     QUrl m_url;
 };
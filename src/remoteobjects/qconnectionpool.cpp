@@ -0,0 +1,790 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtRemoteObjects module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qconnectionpool_p.h"
+
+#include <QtCore/qendian.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+
+#include <algorithm>
+#include <climits>
+
+QT_BEGIN_NAMESPACE
+
+using namespace QtRemoteObjects;
+using namespace QRemoteObjectPackets;
+
+namespace {
+
+struct ConnectionPoolData
+{
+    QMutex mutex;
+    QMultiHash<QUrl, SharedClientConnection *> connections;
+};
+
+Q_GLOBAL_STATIC(ConnectionPoolData, pool)
+
+struct PacketHeader
+{
+    QRemoteObjectPacketTypeEnum type = Invalid;
+    QString name;
+    qint64 bodyOffset = 0; // first byte after the object name
+};
+
+bool readHeader(const QByteArray &packet, PacketHeader &header)
+{
+    QDataStream ds(packet);
+    ds.setVersion(dataStreamVersion);
+    quint32 size;
+    quint16 type;
+    ds >> size >> type;
+    header.type = QRemoteObjectPacketTypeEnum(type);
+    if (header.type != ObjectList)
+        ds >> header.name;
+    header.bodyOffset = ds.device()->pos();
+    return ds.status() == QDataStream::Ok && header.type > Invalid && header.type <= BatchReplyPacket;
+}
+
+struct InvokeTrailer
+{
+    qint64 offset = 0; // of the serial id
+    qint32 serialId = -1;
+    qint32 propertyIndex = -1;
+};
+
+// The serial id and property index of an InvokePacket follow its arguments,
+// which are decoded to find them
+bool readInvokeTrailer(const QByteArray &packet, const PacketHeader &header, InvokeTrailer &trailer)
+{
+    QDataStream ds(packet);
+    ds.setVersion(dataStreamVersion);
+    ds.skipRawData(int(header.bodyOffset));
+    qint32 call;
+    qint32 index;
+    QVariantList args;
+    ds >> call >> index;
+    if (ds.status() != QDataStream::Ok || !deserializeQVariantList(ds, args))
+        return false;
+    trailer.offset = ds.device()->pos();
+    ds >> trailer.serialId >> trailer.propertyIndex;
+    return ds.status() == QDataStream::Ok;
+}
+
+inline qint32 serialIdAt(const QByteArray &packet, qint64 offset)
+{
+    return qFromBigEndian<qint32>(packet.constData() + offset);
+}
+
+inline void setSerialIdAt(QByteArray &packet, qint64 offset, qint32 serialId)
+{
+    qToBigEndian<qint32>(serialId, packet.data() + offset);
+}
+
+inline QByteArray packetData(const DataStreamPacket &packet)
+{
+    return QByteArray(packet.array.constData(), packet.size);
+}
+
+} // namespace
+
+PacketQueueDevice::PacketQueueDevice(QObject *parent)
+    : QIODevice(parent)
+{
+    open(QIODevice::ReadOnly);
+}
+
+void PacketQueueDevice::enqueue(const QByteArray &packet)
+{
+    if (m_readPos == m_data.size()) {
+        m_data.clear();
+        m_readPos = 0;
+    }
+    m_data.append(packet);
+}
+
+void PacketQueueDevice::clear()
+{
+    m_data.clear();
+    m_readPos = 0;
+    // drop what QIODevice buffered already
+    skip(QIODevice::bytesAvailable());
+}
+
+qint64 PacketQueueDevice::bytesAvailable() const
+{
+    return m_data.size() - m_readPos + QIODevice::bytesAvailable();
+}
+
+qint64 PacketQueueDevice::readData(char *data, qint64 maxSize)
+{
+    const qint64 count = qMin(maxSize, qint64(m_data.size() - m_readPos));
+    memcpy(data, m_data.constData() + m_readPos, size_t(count));
+    m_readPos += count;
+    return count;
+}
+
+qint64 PacketQueueDevice::writeData(const char *, qint64)
+{
+    return -1;
+}
+
+void MultiplexedEndpoint::post(std::function<void(MultiplexedClientIo *)> fn)
+{
+    QMutexLocker locker(&mutex);
+    if (!client)
+        return;
+    MultiplexedClientIo *target = client;
+    if (target->thread() != QThread::currentThread()) {
+        // Events posted to the client are dropped if it is deleted first
+        QMetaObject::invokeMethod(target, [target, fn = std::move(fn)]() { fn(target); }, Qt::QueuedConnection);
+        return;
+    }
+    locker.unlock();
+    fn(target);
+}
+
+MultiplexedClientIo::MultiplexedClientIo(SharedClientConnection *shared, QObject *parent)
+    : ClientIoDevice(parent)
+    , m_shared(shared)
+    , m_endpoint(new MultiplexedEndpoint)
+    , m_queue(new PacketQueueDevice(this))
+{
+    m_endpoint->client = this;
+    initializeDataStream();
+}
+
+MultiplexedClientIo::~MultiplexedClientIo()
+{
+    close();
+    QMutexLocker locker(&m_endpoint->mutex);
+    m_endpoint->client = nullptr;
+}
+
+void MultiplexedClientIo::write(const QByteArray &data)
+{
+    write(data, data.size());
+}
+
+void MultiplexedClientIo::write(const QByteArray &data, qint64 size)
+{
+    if (isClosing() || !m_shared)
+        return;
+
+    // Nodes write complete packets, but nothing guarantees that
+    m_partialWrite.append(data.constData(), qsizetype(size));
+    while (m_partialWrite.size() >= qsizetype(sizeof(quint32))) {
+        const qsizetype packetSize = qsizetype(sizeof(quint32)) + qFromBigEndian<quint32>(m_partialWrite.constData());
+        if (m_partialWrite.size() < packetSize)
+            break;
+        SharedClientConnection *shared = m_shared;
+        shared->invoke([shared, endpoint = m_endpoint, packet = m_partialWrite.left(packetSize)]() {
+            shared->send(endpoint, packet);
+        });
+        m_partialWrite.remove(0, packetSize);
+    }
+}
+
+bool MultiplexedClientIo::isOpen() const
+{
+    return !isClosing() && m_shared && m_shared->isOpen();
+}
+
+QIODevice *MultiplexedClientIo::connection() const
+{
+    return m_queue;
+}
+
+void MultiplexedClientIo::connectToServer()
+{
+    if (SharedClientConnection *shared = m_shared)
+        shared->invoke([shared, endpoint = m_endpoint]() { shared->connectToServer(endpoint); });
+}
+
+void MultiplexedClientIo::doClose()
+{
+    if (SharedClientConnection *shared = qExchange(m_shared, nullptr))
+        shared->invoke([shared, endpoint = m_endpoint]() { shared->detach(endpoint); });
+    deleteLater();
+}
+
+void MultiplexedClientIo::doDisconnectFromServer()
+{
+    if (SharedClientConnection *shared = m_shared)
+        shared->invoke([shared]() { shared->disconnectFromServer(); });
+}
+
+QString MultiplexedClientIo::deviceType() const
+{
+    return QStringLiteral("MultiplexedClientIo");
+}
+
+SharedClientConnection::SharedClientConnection(ClientIoDevice *device)
+    : m_device(device)
+    , m_url(device->url())
+{
+    connect(device, &IoDeviceBase::readyRead, this, &SharedClientConnection::onReadyRead);
+    connect(device, &ClientIoDevice::shouldReconnect, this, &SharedClientConnection::onShouldReconnect);
+}
+
+SharedClientConnection::~SharedClientConnection()
+{
+    if (m_device && !m_device->isClosing())
+        m_device->close();
+}
+
+void SharedClientConnection::invoke(std::function<void()> fn)
+{
+    if (thread() == QThread::currentThread())
+        fn();
+    else
+        QMetaObject::invokeMethod(this, std::move(fn), Qt::QueuedConnection);
+}
+
+MultiplexedClientIo *SharedClientConnection::createClient(QObject *parent)
+{
+    auto client = new MultiplexedClientIo(this, parent);
+    client->m_url = m_url;
+    ++m_clientCount;
+    invoke([this, endpoint = client->m_endpoint]() { attach(endpoint); });
+    return client;
+}
+
+void SharedClientConnection::attach(const MultiplexedEndpointPtr &endpoint)
+{
+    m_clients.append(endpoint);
+    qCDebug(QT_REMOTEOBJECT_IO) << "Sharing connection to" << m_url << "between" << m_clients.size() << "nodes";
+}
+
+bool SharedClientConnection::hasClient(const MultiplexedEndpoint *endpoint) const
+{
+    return std::any_of(m_clients.cbegin(), m_clients.cend(),
+                       [endpoint](const MultiplexedEndpointPtr &e) { return e.data() == endpoint; });
+}
+
+void SharedClientConnection::detach(const MultiplexedEndpointPtr &endpoint)
+{
+    m_clients.removeOne(endpoint);
+    const QStringList names = m_subscribers.keys();
+    for (const QString &name : names)
+        unsubscribe(endpoint.data(), name, m_device && m_device->isOpen());
+    for (auto it = m_pendingReplies.begin(); it != m_pendingReplies.end(); ) {
+        if (it->endpoint == endpoint.data())
+            it = m_pendingReplies.erase(it);
+        else
+            ++it;
+    }
+
+    if (!pool.isDestroyed()) {
+        QMutexLocker locker(&pool->mutex);
+        // A node of another thread may be about to attach
+        if (--m_clientCount > 0)
+            return;
+        pool->connections.remove(m_url, this);
+    } else if (!m_clients.isEmpty()) {
+        return;
+    }
+    if (m_device)
+        m_device->close();
+    deleteLater();
+}
+
+void SharedClientConnection::connectToServer(const MultiplexedEndpointPtr &endpoint)
+{
+    if (!m_device)
+        return;
+    if (!m_device->isOpen()) {
+        m_device->connectToServer();
+        return;
+    }
+    if (m_handshake.isEmpty() || endpoint->synced)
+        return;
+
+    // The node joined an established connection, give it what the host sent when it was opened
+    QMetaObject::invokeMethod(this, [this, endpoint]() {
+        if (endpoint->synced || m_handshake.isEmpty() || !m_clients.contains(endpoint))
+            return;
+        endpoint->synced = true;
+        DataStreamPacket objectList;
+        serializeObjectListPacket(objectList, m_objects);
+        QSet<MultiplexedEndpoint *> touched;
+        deliver(endpoint.data(), m_handshake, touched);
+        if (!m_batchHandshake.isEmpty())
+            deliver(endpoint.data(), m_batchHandshake, touched);
+        deliver(endpoint.data(), packetData(objectList), touched);
+        flush(touched);
+    }, Qt::QueuedConnection);
+}
+
+void SharedClientConnection::disconnectFromServer()
+{
+    if (m_device)
+        m_device->disconnectFromServer();
+}
+
+void SharedClientConnection::send(const MultiplexedEndpointPtr &endpoint, QByteArray packet)
+{
+    if (!m_device || !m_clients.contains(endpoint))
+        return;
+
+    PacketHeader header;
+    if (!readHeader(packet, header)) {
+        qCWarning(QT_REMOTEOBJECT_IO) << "Not sending invalid packet to" << m_url;
+        return;
+    }
+
+    switch (header.type) {
+    case Handshake:
+        // The capabilities of the shared connection were announced already
+        return;
+    case AddObject:
+    {
+        const bool isDynamic = packet.at(header.bodyOffset) != 0;
+        QList<Subscriber> &subscribers = m_subscribers[header.name];
+        // A node asking again (i.e. after a reconnect) replaces its subscription
+        subscribers.removeIf([&endpoint](const Subscriber &s) { return s.endpoint == endpoint.data(); });
+        bool requested = false;
+        const bool attached = !subscribers.isEmpty();
+        for (const Subscriber &s : qAsConst(subscribers))
+            requested = requested || (!s.initialized && s.isDynamic == isDynamic);
+        subscribers.append(Subscriber{endpoint.data(), isDynamic, false});
+        if (requested) // the init packet on its way is routed to this node as well
+            return;
+        if (attached) {
+            // Initialize the node from what the host sent the other nodes, after
+            // the packets it wrote before
+            const QString name = header.name;
+            QMetaObject::invokeMethod(this, [this, endpoint, name, isDynamic]() {
+                replayState(endpoint, name, isDynamic);
+            }, Qt::QueuedConnection);
+            return;
+        }
+        break;
+    }
+    case RemoveObject:
+        if (!unsubscribe(endpoint.data(), header.name, false))
+            return;
+        break;
+    case Pause:
+    case Resume:
+    {
+        // The listener on the host is shared, it is paused while all nodes paused it
+        QList<Subscriber> &subscribers = m_subscribers[header.name];
+        const auto allPaused = [&subscribers]() {
+            return std::all_of(subscribers.cbegin(), subscribers.cend(), [](const Subscriber &s) { return s.paused; });
+        };
+        const bool wasPaused = allPaused();
+        for (Subscriber &s : subscribers) {
+            if (s.endpoint != endpoint.data())
+                continue;
+            s.paused = header.type == Pause;
+            if (s.paused)
+                continue;
+            // The outbox keeps what was held back for the node ahead of later packets
+            QSet<MultiplexedEndpoint *> touched;
+            for (auto it = s.missedProperties.cbegin(); it != s.missedProperties.cend(); ++it) {
+                deliver(s.endpoint, it.value(), touched);
+                if (const auto notify = s.missedNotifies.constFind(it.key()); notify != s.missedNotifies.cend())
+                    deliver(s.endpoint, notify.value(), touched);
+            }
+            s.missedProperties.clear();
+            s.missedNotifies.clear();
+            s.lastMissed = -1;
+        }
+        if (wasPaused != allPaused()) {
+            // The host holds back updates of a paused listener, what was sent goes stale
+            if (header.type == Pause)
+                m_states.remove(header.name);
+            break;
+        }
+        if (header.type == Resume) {
+            // Nothing was held back for this node, acknowledge right away
+            QMetaObject::invokeMethod(this, [this, endpoint, packet]() {
+                if (!m_clients.contains(endpoint))
+                    return;
+                QSet<MultiplexedEndpoint *> touched;
+                deliver(endpoint.data(), packet, touched);
+                flush(touched);
+            }, Qt::QueuedConnection);
+        }
+        return;
+    }
+    case InvokePacket:
+    {
+        // The arguments were encoded in this process, their types are known
+        InvokeTrailer trailer;
+        if (!readInvokeTrailer(packet, header, trailer)) {
+            qCWarning(QT_REMOTEOBJECT_IO) << "Not sending invalid packet to" << m_url;
+            return;
+        }
+        mapSerialId(endpoint, packet, trailer.offset);
+        break;
+    }
+    case BatchInvokePacket:
+        mapSerialId(endpoint, packet, header.bodyOffset);
+        break;
+    case MulticastPacket:
+        // The shared connection doesn't join multicast groups
+        return;
+    default:
+        break;
+    }
+    m_device->write(packet);
+}
+
+void SharedClientConnection::mapSerialId(const MultiplexedEndpointPtr &endpoint, QByteArray &packet, qint64 offset)
+{
+    // Serial ids are per replica, so map them to ids unique on this
+    // connection, and back when the reply arrives
+    const qint32 serialId = serialIdAt(packet, offset);
+    if (serialId <= 0)
+        return;
+    const qint32 sharedSerialId = m_nextSerialId;
+    m_nextSerialId = m_nextSerialId == INT_MAX ? 1 : m_nextSerialId + 1;
+    m_pendingReplies.insert(sharedSerialId, PendingReply{endpoint.data(), serialId});
+    setSerialIdAt(packet, offset, sharedSerialId);
+}
+
+void SharedClientConnection::replayState(const MultiplexedEndpointPtr &endpoint, const QString &name, bool isDynamic)
+{
+    if (!m_device || !m_clients.contains(endpoint))
+        return;
+    auto subscribers = m_subscribers.find(name);
+    if (subscribers == m_subscribers.end())
+        return;
+    auto subscriber = std::find_if(subscribers->begin(), subscribers->end(), [&endpoint, isDynamic](const Subscriber &s) {
+        return s.endpoint == endpoint.data() && !s.initialized && s.isDynamic == isDynamic;
+    });
+    if (subscriber == subscribers->end())
+        return;
+
+    const auto state = m_states.constFind(name);
+    const QByteArray init = state == m_states.cend() ? QByteArray() : (isDynamic ? state->dynamicInit : state->init);
+    if (init.isEmpty()) {
+        // No init of that kind was received, or the listener was paused
+        bool requested = false;
+        for (const Subscriber &s : qAsConst(*subscribers))
+            requested = requested || (&s != &*subscriber && !s.initialized && s.isDynamic == isDynamic);
+        if (!requested)
+            reacquire(name, isDynamic);
+        return;
+    }
+
+    qCDebug(QT_REMOTEOBJECT_IO) << "Initializing" << name << "from the state of the shared connection to" << m_url;
+    subscriber->initialized = true;
+    QSet<MultiplexedEndpoint *> touched;
+    deliver(endpoint.data(), init, touched);
+    for (auto it = state->properties.cbegin(), end = state->properties.cend(); it != end; ++it) {
+        deliver(endpoint.data(), it.value(), touched);
+        const QByteArray notify = state->notifies.value(it.key());
+        if (!notify.isEmpty())
+            deliver(endpoint.data(), notify, touched);
+    }
+    flush(touched);
+}
+
+void SharedClientConnection::reacquire(const QString &name, bool isDynamic)
+{
+    // Detach and attach again, back to back, the new init packet is routed to
+    // the nodes waiting for one only
+    qCDebug(QT_REMOTEOBJECT_IO) << "Acquiring" << name << "again on the shared connection to" << m_url;
+    m_states.remove(name);
+    DataStreamPacket packet;
+    serializeRemoveObjectPacket(packet, name);
+    m_device->write(packet.array, packet.size);
+    serializeAddObjectPacket(packet, name, isDynamic);
+    m_device->write(packet.array, packet.size);
+}
+
+bool SharedClientConnection::unsubscribe(MultiplexedEndpoint *endpoint, const QString &name, bool notifyHost)
+{
+    auto it = m_subscribers.find(name);
+    if (it == m_subscribers.end())
+        return false;
+    if (!it->removeIf([endpoint](const Subscriber &s) { return s.endpoint == endpoint; }))
+        return false;
+    if (!it->isEmpty())
+        return false;
+
+    m_subscribers.erase(it);
+    m_states.remove(name);
+    if (notifyHost && m_device) {
+        DataStreamPacket removePacket;
+        serializeRemoveObjectPacket(removePacket, name);
+        m_device->write(removePacket.array, removePacket.size);
+    }
+    return true;
+}
+
+void SharedClientConnection::onReadyRead()
+{
+    QSet<MultiplexedEndpoint *> touched;
+    QByteArray packet;
+    while (m_device && m_device->readPacket(packet))
+        route(packet, touched);
+    flush(touched);
+}
+
+void SharedClientConnection::onShouldReconnect()
+{
+    qCDebug(QT_REMOTEOBJECT_IO) << "Shared connection to" << m_url << "lost";
+    m_open.storeRelease(false);
+    m_subscribers.clear();
+    m_states.clear();
+    m_pendingReplies.clear();
+    m_handshake.clear();
+    m_batchHandshake.clear();
+    m_objects.clear();
+    const auto clients = m_clients;
+    for (const MultiplexedEndpointPtr &endpoint : clients) {
+        endpoint->synced = false;
+        endpoint->outbox.clear();
+        endpoint->post([](MultiplexedClientIo *client) {
+            client->m_queue->clear();
+            client->m_partialWrite.clear();
+            emit client->shouldReconnect(client);
+        });
+    }
+}
+
+void SharedClientConnection::route(QByteArray &packet, QSet<MultiplexedEndpoint *> &touched)
+{
+    PacketHeader header;
+    if (!readHeader(packet, header)) {
+        qCWarning(QT_REMOTEOBJECT_IO) << "Invalid packet received from" << m_url;
+        return;
+    }
+
+    switch (header.type) {
+    case Handshake:
+    {
+        quint32 maxFrameSize;
+        if (deserializeFrameSizeName(header.name, maxFrameSize)) {
+            m_device->setPeerMaxFrameSize(maxFrameSize);
+            break;
+        }
+        if (header.name == batchHandshake) {
+            // The host runs batches, so do the nodes
+            m_batchHandshake = packet;
+            for (const MultiplexedEndpointPtr &endpoint : qAsConst(m_clients)) {
+                if (endpoint->synced)
+                    deliver(endpoint.data(), packet, touched);
+            }
+            break;
+        }
+        // The shared connection announces its own capabilities, the nodes' are not forwarded
+        DataStreamPacket handshakePacket;
+        serializeFrameSizePacket(handshakePacket, m_device->maxFrameSize());
+        m_device->write(handshakePacket.array, handshakePacket.size);
+        serializeInvokeErrorHandshakePacket(handshakePacket);
+        m_device->write(handshakePacket.array, handshakePacket.size);
+        serializeBatchHandshakePacket(handshakePacket);
+        m_device->write(handshakePacket.array, handshakePacket.size);
+        m_handshake = packet;
+        m_open.storeRelease(true);
+        for (const MultiplexedEndpointPtr &endpoint : qAsConst(m_clients)) {
+            endpoint->synced = true;
+            deliver(endpoint.data(), packet, touched);
+        }
+        break;
+    }
+    case ObjectList:
+    {
+        QDataStream ds(packet);
+        ds.setVersion(dataStreamVersion);
+        ds.skipRawData(int(header.bodyOffset));
+        ObjectInfoList objects;
+        deserializeObjectListPacket(ds, objects);
+        for (const ObjectInfo &object : qAsConst(objects)) {
+            auto known = std::find_if(m_objects.begin(), m_objects.end(),
+                                      [&object](const ObjectInfo &o) { return o.name == object.name; });
+            if (known != m_objects.end())
+                *known = object;
+            else
+                m_objects.append(object);
+        }
+        for (const MultiplexedEndpointPtr &endpoint : qAsConst(m_clients)) {
+            if (endpoint->synced)
+                deliver(endpoint.data(), packet, touched);
+        }
+        break;
+    }
+    case RemoveObject:
+        m_objects.removeIf([&header](const ObjectInfo &o) { return o.name == header.name; });
+        m_subscribers.remove(header.name);
+        m_states.remove(header.name);
+        for (const MultiplexedEndpointPtr &endpoint : qAsConst(m_clients)) {
+            if (endpoint->synced)
+                deliver(endpoint.data(), packet, touched);
+        }
+        break;
+    case InitPacket:
+    case InitDynamicPacket:
+    {
+        const bool isDynamic = header.type == InitDynamicPacket;
+        auto subscribers = m_subscribers.find(header.name);
+        if (subscribers == m_subscribers.end())
+            break;
+        SourceState &state = m_states[header.name];
+        (isDynamic ? state.dynamicInit : state.init) = packet;
+        for (Subscriber &s : *subscribers) {
+            if (!s.initialized && s.isDynamic == isDynamic) {
+                s.initialized = true;
+                deliver(s.endpoint, packet, touched);
+            }
+        }
+        break;
+    }
+    case PropertyChangePacket:
+    case InvokePacket:
+    {
+        auto subscribers = m_subscribers.find(header.name);
+        if (subscribers == m_subscribers.end())
+            break;
+        // The property index leads a PropertyChangePacket
+        const int propertyIndex = header.type == PropertyChangePacket ? serialIdAt(packet, header.bodyOffset) : -1;
+        // A signal whose argument types are not registered yet is delivered
+        // as is, it is not kept as the notify signal of a property
+        InvokeTrailer trailer;
+        const bool isNotify = header.type == InvokePacket && readInvokeTrailer(packet, header, trailer)
+                && trailer.propertyIndex >= 0;
+        auto state = m_states.find(header.name);
+        if (state != m_states.end()) {
+            // Only the last value of a property is needed to initialize a node
+            if (propertyIndex >= 0) {
+                state->lastProperty = propertyIndex;
+                state->properties.insert(propertyIndex, packet);
+            } else if (isNotify && state->lastProperty >= 0) {
+                state->notifies.insert(qExchange(state->lastProperty, -1), packet);
+            }
+        }
+        for (Subscriber &s : *subscribers) {
+            if (!s.initialized)
+                continue;
+            // The host only holds back property changes while all nodes are paused,
+            // a node paused on its own gets the last values when it resumes
+            if (s.paused && propertyIndex >= 0) {
+                s.missedProperties.insert(propertyIndex, packet);
+                s.missedNotifies.remove(propertyIndex);
+                s.lastMissed = propertyIndex;
+            } else if (s.paused && isNotify) {
+                if (s.lastMissed >= 0)
+                    s.missedNotifies.insert(qExchange(s.lastMissed, -1), packet);
+            } else {
+                deliver(s.endpoint, packet, touched);
+            }
+        }
+        break;
+    }
+    case Pong:
+        for (const Subscriber &s : qAsConst(m_subscribers[header.name]))
+            deliver(s.endpoint, packet, touched);
+        break;
+    case Resume:
+        // Acknowledges the nodes that resumed, others are still paused
+        for (const Subscriber &s : qAsConst(m_subscribers[header.name])) {
+            if (!s.paused)
+                deliver(s.endpoint, packet, touched);
+        }
+        break;
+    case InvokeReplyPacket:
+    case InvokeErrorPacket:
+    case BatchReplyPacket:
+    {
+        // The acked serial id leads the reply
+        const PendingReply reply = m_pendingReplies.take(serialIdAt(packet, header.bodyOffset));
+        if (!reply.endpoint)
+            break;
+        setSerialIdAt(packet, header.bodyOffset, reply.serialId);
+        deliver(reply.endpoint, packet, touched);
+        break;
+    }
+    case SharedStatePacket:
+    case MulticastPacket:
+        // Not asked for by the shared connection
+        qCDebug(QT_REMOTEOBJECT_IO) << "Dropping" << header.type << "of" << header.name << "from" << m_url;
+        break;
+    default:
+        qCWarning(QT_REMOTEOBJECT_IO) << "Unexpected packet received from" << m_url << header.type;
+    }
+}
+
+void SharedClientConnection::deliver(MultiplexedEndpoint *endpoint, const QByteArray &packet, QSet<MultiplexedEndpoint *> &touched)
+{
+    endpoint->outbox.append(packet);
+    touched.insert(endpoint);
+}
+
+void SharedClientConnection::flush(const QSet<MultiplexedEndpoint *> &touched)
+{
+    for (MultiplexedEndpoint *endpoint : touched) {
+        // A node can close its connection while handling the packets of another one
+        if (!hasClient(endpoint))
+            continue;
+        endpoint->post([packets = qExchange(endpoint->outbox, {})](MultiplexedClientIo *client) {
+            for (const QByteArray &packet : packets)
+                client->m_queue->enqueue(packet);
+            emit client->readyRead();
+        });
+    }
+}
+
+ClientIoDevice *QtROConnectionPool::create(const QUrl &url, QObject *parent)
+{
+    QMutexLocker locker(&pool->mutex);
+    SharedClientConnection *shared = nullptr;
+    for (auto it = pool->connections.constFind(url); it != pool->connections.cend() && it.key() == url; ++it) {
+        // Nodes of any thread share the connection, as long as its thread runs
+        QThread *thread = (*it)->thread();
+        if (thread && !thread->isFinished()) {
+            shared = *it;
+            break;
+        }
+    }
+    if (!shared) {
+        ClientIoDevice *device = QtROClientFactory::instance()->create(url);
+        if (!device)
+            return nullptr;
+        shared = new SharedClientConnection(device);
+        pool->connections.insert(url, shared);
+    }
+    return shared->createClient(parent);
+}
+
+QT_END_NAMESPACE
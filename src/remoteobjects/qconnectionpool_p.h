@@ -0,0 +1,249 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtRemoteObjects module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCONNECTIONPOOL_P_H
+#define QCONNECTIONPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qconnectionfactories_p.h"
+#include "qremoteobjectpacket_p.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qset.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qthread.h>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+class SharedClientConnection;
+class MultiplexedClientIo;
+
+// Read side of a MultiplexedClientIo, holds the packets routed to one node
+class PacketQueueDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit PacketQueueDevice(QObject *parent = nullptr);
+
+    void enqueue(const QByteArray &packet);
+    void clear();
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    QByteArray m_data;
+    qsizetype m_readPos = 0;
+};
+
+// What a SharedClientConnection knows of one MultiplexedClientIo. The node of
+// the client can live in another thread than the connection, so the
+// connection only reaches the client through its endpoint.
+class MultiplexedEndpoint
+{
+public:
+    // Runs fn with the client, in the thread of the client, unless the client is gone
+    void post(std::function<void(MultiplexedClientIo *)> fn);
+
+    QMutex mutex;
+    MultiplexedClientIo *client = nullptr; // reset by the destructor of the client
+
+    // Only used in the thread of the connection
+    bool synced = false; // got the handshake and object list of the current connection
+    QList<QByteArray> outbox;
+};
+using MultiplexedEndpointPtr = QSharedPointer<MultiplexedEndpoint>;
+
+// The connection of one node to a host, when the host connection is shared
+// by all nodes of the process (see QtROConnectionPool)
+class MultiplexedClientIo final : public ClientIoDevice
+{
+    Q_OBJECT
+
+public:
+    explicit MultiplexedClientIo(SharedClientConnection *shared, QObject *parent = nullptr);
+    ~MultiplexedClientIo() override;
+
+    void write(const QByteArray &data) override;
+    void write(const QByteArray &data, qint64 size) override;
+    bool isOpen() const override;
+    QIODevice *connection() const override;
+    void connectToServer() override;
+
+protected:
+    void doClose() override;
+    void doDisconnectFromServer() override;
+    QString deviceType() const override;
+
+private:
+    friend class SharedClientConnection;
+
+    // Valid until the client detached, the connection is only deleted after
+    // its last client detached
+    SharedClientConnection *m_shared;
+    MultiplexedEndpointPtr m_endpoint;
+    PacketQueueDevice *m_queue;
+    QByteArray m_partialWrite;
+};
+
+// One ClientIoDevice to a host url, multiplexed between the nodes of the
+// process. Packets for objects are routed by object name, so the host sees a
+// single connection, and only one AddObject per name. The connection lives in
+// the thread of the node that opened it, nodes of other threads reach it
+// through queued calls.
+//
+// The connection negotiates its own capabilities with the host, the
+// handshakes of the nodes are not forwarded. Only batches of calls are asked
+// for and announced to the nodes; sequence numbers, shared state and
+// multicast are per node and are not available on a shared connection.
+class SharedClientConnection : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SharedClientConnection(ClientIoDevice *device);
+    ~SharedClientConnection() override;
+
+    // Called from any thread, with the mutex of the pool held
+    MultiplexedClientIo *createClient(QObject *parent);
+    QUrl url() const { return m_url; }
+    // Open once the host sent its handshake, can be called from any thread
+    bool isOpen() const { return m_open.loadAcquire(); }
+
+private:
+    friend class MultiplexedClientIo;
+
+    struct Subscriber
+    {
+        MultiplexedEndpoint *endpoint;
+        bool isDynamic;
+        bool initialized;
+        bool paused = false;
+        // Property packets held back while only this node is paused, with
+        // the notify InvokePacket that followed each
+        QMap<int, QByteArray> missedProperties;
+        QMap<int, QByteArray> missedNotifies;
+        int lastMissed = -1;
+    };
+    struct PendingReply
+    {
+        MultiplexedEndpoint *endpoint = nullptr;
+        qint32 serialId;
+    };
+    // What the host sent for an object since its listener was initialized,
+    // enough to initialize another node without asking the host again
+    struct SourceState
+    {
+        QByteArray init;
+        QByteArray dynamicInit;
+        // Last PropertyChangePacket per property, with the notify InvokePacket that followed it
+        QMap<int, QByteArray> properties;
+        QMap<int, QByteArray> notifies;
+        int lastProperty = -1;
+    };
+
+    // Runs fn in the thread of the connection
+    void invoke(std::function<void()> fn);
+
+    void attach(const MultiplexedEndpointPtr &endpoint);
+    void detach(const MultiplexedEndpointPtr &endpoint);
+    void connectToServer(const MultiplexedEndpointPtr &endpoint);
+    void disconnectFromServer();
+    void send(const MultiplexedEndpointPtr &endpoint, QByteArray packet);
+    // Replaces the serial id at offset by one unique on the connection
+    void mapSerialId(const MultiplexedEndpointPtr &endpoint, QByteArray &packet, qint64 offset);
+    void onReadyRead();
+    void onShouldReconnect();
+    void route(QByteArray &packet, QSet<MultiplexedEndpoint *> &touched);
+    void deliver(MultiplexedEndpoint *endpoint, const QByteArray &packet, QSet<MultiplexedEndpoint *> &touched);
+    // Hands the delivered packets to the clients
+    void flush(const QSet<MultiplexedEndpoint *> &touched);
+    void replayState(const MultiplexedEndpointPtr &endpoint, const QString &name, bool isDynamic);
+    // The host only initializes new listeners
+    void reacquire(const QString &name, bool isDynamic);
+    // true if the endpoint was the last subscriber of name
+    bool unsubscribe(MultiplexedEndpoint *endpoint, const QString &name, bool notifyHost);
+    bool hasClient(const MultiplexedEndpoint *endpoint) const;
+
+    QPointer<ClientIoDevice> m_device;
+    QUrl m_url;
+    QList<MultiplexedEndpointPtr> m_clients;
+    int m_clientCount = 0; // guarded by the mutex of the pool, includes clients not attached yet
+    QAtomicInteger<bool> m_open = false;
+    QHash<QString, QList<Subscriber>> m_subscribers;
+    QHash<QString, SourceState> m_states;
+    QHash<qint32, PendingReply> m_pendingReplies;
+    qint32 m_nextSerialId = 1;
+    QByteArray m_handshake;
+    QByteArray m_batchHandshake; // the reply of the host, if it runs batches
+    QRemoteObjectPackets::ObjectInfoList m_objects;
+};
+
+class QtROConnectionPool
+{
+public:
+    // See QRemoteObjectNode::setSharedConnectionsEnabled()
+    static ClientIoDevice *create(const QUrl &url, QObject *parent = nullptr);
+};
+
+QT_END_NAMESPACE
+
+#endif
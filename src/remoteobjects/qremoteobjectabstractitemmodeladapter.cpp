@@ -38,6 +38,7 @@
 ****************************************************************************/
 
 #include "qremoteobjectabstractitemmodeladapter_p.h"
+#include "qremoteobjectabstractitemmodelreplica_p.h"
 
 #include <QtCore/qitemselectionmodel.h>
 
@@ -169,12 +170,14 @@ DataEntries QAbstractItemModelSourceAdapter::replicaRowRequest(IndexList start,
 
     auto roleData = createModelRoleData(roles);
     for (int row = startRow; row <= endRow; ++row) {
+        // Every column carries whether the row has children, the requested
+        // columns need not include the first one
+        const bool hasChildren = m_model->hasChildren(m_model->index(row, 0, parent));
         for (int column = startColumn; column <= endColumn; ++column) {
             const QModelIndex current = m_model->index(row, column, parent);
             Q_ASSERT(current.isValid());
             const IndexList currentList = toModelIndexList(current, m_model);
             const QVariantList data = collectData(current, m_model, roleData);
-            const bool hasChildren = m_model->hasChildren(current);
             const Qt::ItemFlags flags = m_model->flags(current);
             qCDebug(QT_REMOTEOBJECT_MODELS) << Q_FUNC_INFO << "current=" << currentList << "data=" << data;
             entries.data << IndexValuePair(currentList, data, hasChildren, flags);
@@ -267,20 +270,108 @@ QList<IndexValuePair> QAbstractItemModelSourceAdapter::fetchTree(const QModelInd
         return entries;
     entries.reserve(std::min(rowCount * columnCount, int(size)));
     auto roleData = createModelRoleData(roles);
-    for (int row = 0; row < rowCount && size > 0; ++row)
+    for (int row = 0; row < rowCount && size > 0; ++row) {
+        const bool rowHasChildren = m_model->hasChildren(m_model->index(row, 0, parent));
         for (int column = 0; column < columnCount && size > 0; ++column) {
             const auto index = m_model->index(row, column, parent);
             const IndexList currentList = toModelIndexList(index, m_model);
             const QVariantList data = collectData(index, m_model, roleData);
-            const bool hasChildren = m_model->hasChildren(index);
+            const bool hasChildren = column == 0 ? rowHasChildren : m_model->hasChildren(index);
             const Qt::ItemFlags flags = m_model->flags(index);
             int rc = m_model->rowCount(index);
             int cc = m_model->columnCount(index);
-            IndexValuePair rowData(currentList, data, hasChildren, flags, QSize{cc, rc});
+            IndexValuePair rowData(currentList, data, rowHasChildren, flags, QSize{cc, rc});
             --size;
             if (hasChildren)
                 rowData.children = fetchTree(index, size, roles);
             entries.push_back(rowData);
         }
+    }
     return entries;
 }
+
+QAbstractItemModelReplicaSourceAdapter::QAbstractItemModelReplicaSourceAdapter(QAbstractItemModelReplica *replica, QItemSelectionModel *sel, const QList<int> &roles)
+    : QAbstractItemModelSourceAdapter(replica, sel, roles.isEmpty() ? replica->availableRoles() : roles),
+      m_replica(replica),
+      m_replicaImpl(replica->d.data())
+{
+}
+
+QRemoteObjectPendingCall QAbstractItemModelReplicaSourceAdapter::replicaSizeRequest(IndexList parentList)
+{
+    qCDebug(QT_REMOTEOBJECT_MODELS) << "Forwarding size request" << "parent" << parentList;
+    return m_replicaImpl->replicaSizeRequest(parentList);
+}
+
+QRemoteObjectPendingCall QAbstractItemModelReplicaSourceAdapter::replicaRowRequest(IndexList start, IndexList end, QList<int> roles)
+{
+    if (roles.isEmpty())
+        roles << availableRoles();
+
+    DataEntries entries;
+    if (cachedRows(start, end, roles, &entries)) {
+        qCDebug(QT_REMOTEOBJECT_MODELS) << "Requested rows are cached" << "start=" << start << "end=" << end << "roles=" << roles;
+        return QRemoteObjectPendingCall::fromCompletedCall(QVariant::fromValue(entries));
+    }
+
+    qCDebug(QT_REMOTEOBJECT_MODELS) << "Forwarding rows request" << "start=" << start << "end=" << end << "roles=" << roles;
+    QRemoteObjectPendingReply<DataEntries> reply = m_replicaImpl->replicaRowRequest(start, end, roles);
+    // Keep the rows in the replica cache, so they are answered locally for every client from now on
+    auto watcher = new QRemoteObjectPendingCallWatcher(reply, this);
+    connect(watcher, &QRemoteObjectPendingCallWatcher::finished, this, [this, roles](QRemoteObjectPendingCallWatcher *watcher) {
+        if (watcher->error() == QRemoteObjectPendingCall::NoError)
+            m_replicaImpl->fillCache(watcher->returnValue().value<DataEntries>(), roles);
+        watcher->deleteLater();
+    });
+    return reply;
+}
+
+QRemoteObjectPendingCall QAbstractItemModelReplicaSourceAdapter::replicaHeaderRequest(QList<Qt::Orientation> orientations, QList<int> sections, QList<int> roles)
+{
+    qCDebug(QT_REMOTEOBJECT_MODELS) << "Forwarding header request" << "orientations=" << orientations << "sections=" << sections << "roles=" << roles;
+    return m_replicaImpl->replicaHeaderRequest(orientations, sections, roles);
+}
+
+QRemoteObjectPendingCall QAbstractItemModelReplicaSourceAdapter::replicaCacheRequest(size_t size, const QList<int> &roles)
+{
+    qCDebug(QT_REMOTEOBJECT_MODELS) << "Forwarding cache request" << "size=" << size << "roles=" << roles;
+    return m_replicaImpl->replicaCacheRequest(size, roles);
+}
+
+bool QAbstractItemModelReplicaSourceAdapter::cachedRows(const IndexList &start, const IndexList &end, const QList<int> &roles, DataEntries *entries) const
+{
+    if (start.isEmpty() || start.size() != end.size())
+        return false;
+
+    IndexList parentList = start;
+    parentList.pop_back();
+    bool ok = true;
+    const QModelIndex parent = toQModelIndex(parentList, m_replica, &ok);
+    if (!ok)
+        return false;
+    const CacheData *parentItem = m_replicaImpl->cacheData(parent);
+    if (!parentItem || parentItem->rowCount <= 0 || parentItem->columnCount <= 0)
+        return false;
+
+    const int endRow = std::min(end.last().row, parentItem->rowCount - 1);
+    const int endColumn = std::min(end.last().column, parentItem->columnCount - 1);
+    for (int row = start.last().row; row <= endRow; ++row) {
+        const bool hasChildren = m_replica->hasChildren(m_replica->index(row, 0, parent));
+        for (int column = start.last().column; column <= endColumn; ++column) {
+            const QModelIndex current = m_replica->index(row, column, parent);
+            const CacheEntry *entry = m_replicaImpl->cacheEntry(current);
+            if (!entry)
+                return false;
+            QVariantList data;
+            data.reserve(roles.size());
+            for (int role : roles) {
+                const auto it = entry->data.constFind(role);
+                if (it == entry->data.cend())
+                    return false;
+                data << it.value();
+            }
+            entries->data << IndexValuePair(toModelIndexList(current, m_replica), data, hasChildren, entry->flags);
+        }
+    }
+    return true;
+}
@@ -52,6 +52,7 @@
 //
 
 #include "qremoteobjectabstractitemmodeltypes.h"
+#include "qremoteobjectpendingcall.h"
 #include "qremoteobjectsource.h"
 
 #include <QtCore/qsize.h>
@@ -59,6 +60,8 @@
 QT_BEGIN_NAMESPACE
 
 class QAbstractItemModel;
+class QAbstractItemModelReplica;
+class QAbstractItemModelReplicaImplementation;
 class QItemSelectionModel;
 
 class QAbstractItemModelSourceAdapter : public QObject
@@ -116,6 +119,28 @@ private:
     QList<int> m_availableRoles;
 };
 
+// Used when a QAbstractItemModelReplica is itself remoted (i.e. by proxy()).
+// Requests are answered from the replica's cache when possible and forwarded
+// upstream otherwise, the reply is sent once the upstream reply arrives.
+class QAbstractItemModelReplicaSourceAdapter : public QAbstractItemModelSourceAdapter
+{
+    Q_OBJECT
+public:
+    explicit QAbstractItemModelReplicaSourceAdapter(QAbstractItemModelReplica *replica, QItemSelectionModel *sel, const QList<int> &roles = QList<int>());
+
+public Q_SLOTS:
+    QRemoteObjectPendingCall replicaSizeRequest(IndexList parentList);
+    QRemoteObjectPendingCall replicaRowRequest(IndexList start, IndexList end, QList<int> roles);
+    QRemoteObjectPendingCall replicaHeaderRequest(QList<Qt::Orientation> orientations, QList<int> sections, QList<int> roles);
+    QRemoteObjectPendingCall replicaCacheRequest(size_t size, const QList<int> &roles);
+
+private:
+    bool cachedRows(const IndexList &start, const IndexList &end, const QList<int> &roles, DataEntries *entries) const;
+
+    QAbstractItemModelReplica *m_replica;
+    QAbstractItemModelReplicaImplementation *m_replicaImpl;
+};
+
 template <class ObjectType, class AdapterType>
 struct QAbstractItemAdapterSourceAPI : public SourceApiMap
 {
@@ -234,6 +259,12 @@ struct QAbstractItemAdapterSourceAPI : public SourceApiMap
     }
     const QByteArray typeName(int index) const override
     {
+        // Adapters forwarding to another node reply asynchronously
+        if (index >= 0 && index < m_methods[0]) {
+            const QByteArray adapterTypeName = AdapterType::staticMetaObject.method(m_methods[index + 1]).typeName();
+            if (adapterTypeName == QByteArrayLiteral("QRemoteObjectPendingCall"))
+                return adapterTypeName;
+        }
         switch (index) {
         case 0: return QByteArrayLiteral("QSize");
         case 1: return QByteArrayLiteral("DataEntries");
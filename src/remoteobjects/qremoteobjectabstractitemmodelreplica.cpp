@@ -41,10 +41,20 @@
 #include "qremoteobjectabstractitemmodelreplica_p.h"
 
 #include "qremoteobjectnode.h"
+#include "qremoteobjectnode_p.h"
 
+#include "qremoteobjectsource.h"
+
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qrect.h>
 #include <QtCore/qpoint.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qurl.h>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -96,6 +106,8 @@ QAbstractItemModelReplicaImplementation::QAbstractItemModelReplicaImplementation
 
 QAbstractItemModelReplicaImplementation::~QAbstractItemModelReplicaImplementation()
 {
+    if (m_initDone && !m_persistedCacheFile.isEmpty())
+        savePersistedCache();
     m_rootItem.clear();
     qDeleteAll(m_pendingRequests);
 }
@@ -371,6 +383,7 @@ void QAbstractItemModelReplicaImplementation::handleModelResetDone(QRemoteObject
 
     q->beginResetModel();
     m_rootItem.clear();
+    m_showingPersistedCache = false;
     if (size.height() > 0) {
         m_rootItem.rowCount = size.height();
         m_rootItem.hasChildren = true;
@@ -436,6 +449,8 @@ void QAbstractItemModelReplicaImplementation::handleSizeDone(QRemoteObjectPendin
 void QAbstractItemModelReplicaImplementation::init()
 {
     qCDebug(QT_REMOTEOBJECT_MODELS) << Q_FUNC_INFO << this->node()->objectName();
+    // The roles may have been taken from the persisted cache
+    m_availableRoles.clear();
     QRemoteObjectPendingCallWatcher *watcher = doModelReset();
     connect(watcher, &QRemoteObjectPendingCallWatcher::finished, this, &QAbstractItemModelReplicaImplementation::handleInitDone);
 }
@@ -477,25 +492,11 @@ inline void fillCacheEntry(CacheEntry *entry, const IndexValuePair &pair, const
 
 inline void fillRow(CacheData *item, const IndexValuePair &pair, const QAbstractItemModel *model, const QList<int> &roles)
 {
-    CachedRowEntry &rowRef = item->cachedRowEntry;
     const QModelIndex index = toQModelIndex(pair.index, model);
     Q_ASSERT(index.isValid());
     qCDebug(QT_REMOTEOBJECT_MODELS) << Q_FUNC_INFO << "row=" << index.row() << "column=" << index.column();
-    if (index.column() == 0)
-        item->hasChildren = pair.hasChildren;
-    bool existed = false;
-    for (int i = 0; i < rowRef.size(); ++i) {
-        if (i == index.column()) {
-            fillCacheEntry(&rowRef[i], pair, roles);
-            existed = true;
-        }
-    }
-    qCDebug(QT_REMOTEOBJECT_MODELS) << Q_FUNC_INFO << "existed=" << existed;
-    if (!existed) {
-        CacheEntry entries;
-        fillCacheEntry(&entries, pair, roles);
-        rowRef.append(entries);
-    }
+    item->hasChildren = pair.hasChildren;
+    fillCacheEntry(&item->ensureColumn(index.column()), pair, roles);
 }
 
 int collectEntriesForRow(DataEntries* filteredEntries, int row, const DataEntries &entries, int startIndex)
@@ -524,6 +525,19 @@ void QAbstractItemModelReplicaImplementation::fillCache(const IndexValuePair &pa
         fillCache(it, roles);
 }
 
+// Fills the rows without emitting dataChanged
+void QAbstractItemModelReplicaImplementation::fillCache(const DataEntries &entries, const QList<int> &roles)
+{
+    for (const IndexValuePair &pair : entries.data) {
+        bool ok = true;
+        toQModelIndex(pair.index, q, &ok);
+        if (!ok) // the rows changed while the request was pending
+            continue;
+        if (auto item = createCacheData(pair.index))
+            fillRow(item, pair, q, roles);
+    }
+}
+
 void QAbstractItemModelReplicaImplementation::requestedData(QRemoteObjectPendingCallWatcher *qobject)
 {
     RowWatcher *watcher = static_cast<RowWatcher *>(qobject);
@@ -551,22 +565,249 @@ void QAbstractItemModelReplicaImplementation::requestedData(QRemoteObjectPending
     Q_ASSERT_X(startRow >= 0 && startRow < parentItem->rowCount, __FUNCTION__, qPrintable(QString(QLatin1String("0 <= %1 < %2")).arg(startRow).arg(parentItem->rowCount)));
     Q_ASSERT_X(endRow >= 0 && endRow < parentItem->rowCount, __FUNCTION__, qPrintable(QString(QLatin1String("0 <= %1 < %2")).arg(endRow).arg(parentItem->rowCount)));
 
-    for (int i = 0; i < entries.data.size(); ++i) {
-        IndexValuePair pair = entries.data[i];
-        if (auto item = createCacheData(pair.index))
-            fillRow(item, pair, q, watcher->roles);
-    }
+    fillCache(entries, watcher->roles);
 
     const QModelIndex parentIndex = toQModelIndex(parentList, q);
     const QModelIndex startIndex = q->index(startRow, startColumn, parentIndex);
     const QModelIndex endIndex = q->index(endRow, endColumn, parentIndex);
     Q_ASSERT(startIndex.isValid());
     Q_ASSERT(endIndex.isValid());
-    emit q->dataChanged(startIndex, endIndex, watcher->roles);
+    queueDataChanged(startIndex, endIndex, watcher->roles);
     m_pendingRequests.removeAll(watcher);
     delete watcher;
 }
 
+void QAbstractItemModelReplicaImplementation::queueDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    if (m_pendingDataChanges.isEmpty())
+        QMetaObject::invokeMethod(this, [this]() { emitPendingDataChanged(); }, Qt::QueuedConnection);
+    QList<int> sortedRoles = roles;
+    std::sort(sortedRoles.begin(), sortedRoles.end());
+    m_pendingDataChanges.push_back({topLeft, bottomRight, sortedRoles});
+}
+
+static const quint32 persistedCacheMagic = 0x5154524d; // "QTRM"
+static const quint8 persistedCacheVersion = 3;
+
+// Identifies the data of the source name with these roles and columns
+static QByteArray persistedCacheKey(const QString &name, const QHash<int, QByteArray> &roleNames, int columnCount)
+{
+    QList<int> roles = roleNames.keys();
+    std::sort(roles.begin(), roles.end());
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QtRemoteObjects::dataStreamVersion);
+    out << name << qint32(columnCount);
+    for (int role : roles)
+        out << qint32(role) << roleNames.value(role);
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+static void writeCacheEntries(QDataStream &out, const QList<CacheEntry> &entries, qsizetype count)
+{
+    out << qint32(count);
+    for (qsizetype i = 0; i < count; ++i)
+        out << int(entries.at(i).flags) << entries.at(i).data;
+}
+
+// Reads at most maxCount entries, more means the cache is corrupt
+static void readCacheEntries(QDataStream &in, QList<CacheEntry> &entries, int maxCount)
+{
+    qint32 count;
+    in >> count;
+    if (in.status() != QDataStream::Ok)
+        return;
+    if (count < 0 || count > maxCount) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return;
+    }
+    entries.resize(count);
+    for (CacheEntry &entry : entries) {
+        int flags;
+        in >> flags >> entry.data;
+        if (in.status() != QDataStream::Ok)
+            return;
+        entry.flags = Qt::ItemFlags(flags);
+    }
+}
+
+void QAbstractItemModelReplicaImplementation::loadPersistedCache(const QString &name)
+{
+    if (!node())
+        return;
+    auto nodePrivate = static_cast<QRemoteObjectNodePrivate *>(QObjectPrivate::get(node()));
+    const QString dir = nodePrivate->m_modelCacheDirectory;
+    if (dir.isEmpty())
+        return;
+    m_persistedName = name;
+    m_persistedRows = nodePrivate->m_modelCacheRows;
+    m_persistedCacheFile = QDir(dir).filePath(QString::fromLatin1(QUrl::toPercentEncoding(name)) + QLatin1String(".qtromodel"));
+
+    QFile file(m_persistedCacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    // Decoding copies everything out of the mapping, it can go with the file
+    QByteArray data;
+    if (const uchar *mapped = file.map(0, file.size()))
+        data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), file.size());
+    else
+        data = file.readAll();
+    QDataStream in(data);
+    in.setVersion(QtRemoteObjects::dataStreamVersion);
+
+    // The cache is keyed on the name of the source it was filled from and the
+    // role names and columns of its data. It is shown until the source's data,
+    // with the same or other roles and columns, replaces it.
+    quint32 magic;
+    quint8 version;
+    QString sourceName;
+    QByteArray key;
+    QList<int> roles;
+    QHash<int, QByteArray> roleNames;
+    QSize size;
+    in >> magic >> version;
+    if (in.status() == QDataStream::Ok && magic == persistedCacheMagic && version == persistedCacheVersion)
+        in >> sourceName >> key >> roles >> roleNames >> size;
+    if (in.status() != QDataStream::Ok || magic != persistedCacheMagic || version != persistedCacheVersion
+        || sourceName != name || key != persistedCacheKey(name, roleNames, size.width())) {
+        qCDebug(QT_REMOTEOBJECT_MODELS) << "Ignoring incompatible model cache" << m_persistedCacheFile;
+        return;
+    }
+
+    QList<CacheEntry> headerData[2];
+    if (size.width() < 0 || size.height() < 0)
+        in.setStatus(QDataStream::ReadCorruptData);
+    // Only the top rows were written
+    const int maxRows = std::min(size.height(), m_persistedRows);
+    readCacheEntries(in, headerData[0], size.width());
+    readCacheEntries(in, headerData[1], maxRows);
+    qint32 rowCount = 0;
+    in >> rowCount;
+    if (in.status() == QDataStream::Ok && (rowCount < 0 || rowCount > maxRows))
+        in.setStatus(QDataStream::ReadCorruptData);
+    std::vector<std::pair<bool, CachedRowEntry>> rows;
+    for (qint32 row = 0; row < rowCount && in.status() == QDataStream::Ok; ++row) {
+        bool hasChildren;
+        CachedRowEntry columns;
+        in >> hasChildren;
+        readCacheEntries(in, columns, size.width());
+        rows.emplace_back(hasChildren, std::move(columns));
+    }
+    if (in.status() != QDataStream::Ok) {
+        qCWarning(QT_REMOTEOBJECT_MODELS) << "Ignoring corrupt model cache" << m_persistedCacheFile;
+        return;
+    }
+
+    qCDebug(QT_REMOTEOBJECT_MODELS) << Q_FUNC_INFO << name << "size=" << size << "rows=" << rows.size();
+    q->beginResetModel();
+    m_rootItem.clear();
+    m_rootItem.rowCount = size.height();
+    m_rootItem.hasChildren = size.height() > 0;
+    m_rootItem.columnCount = size.width();
+    m_headerData[0] = std::move(headerData[0]);
+    m_headerData[0].resize(size.width());
+    m_headerData[1] = std::move(headerData[1]);
+    m_headerData[1].resize(size.height());
+    for (int row = 0; row < int(rows.size()); ++row) {
+        m_rootItem.ensureChildren(row, row);
+        CacheData *item = m_rootItem.children.get(row);
+        item->hasChildren = rows[row].first;
+        item->columnCount = size.width();
+        item->cachedRowEntry = std::move(rows[row].second);
+    }
+    m_persistedRoles = roles;
+    m_persistedRoleNames = roleNames;
+    m_availableRoles.clear();
+    m_showingPersistedCache = true;
+    q->endResetModel();
+}
+
+void QAbstractItemModelReplicaImplementation::savePersistedCache()
+{
+    const int maxRows = m_persistedRows;
+
+    // Only the top rows, as far as they are cached
+    std::vector<CacheData *> rows;
+    for (int row = 0; row < std::min(maxRows, m_rootItem.rowCount); ++row) {
+        CacheData *item = m_rootItem.children.get(row);
+        if (!item)
+            break;
+        rows.push_back(item);
+    }
+
+    QSaveFile file(m_persistedCacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(QT_REMOTEOBJECT_MODELS) << "Cannot write model cache" << m_persistedCacheFile << file.errorString();
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QtRemoteObjects::dataStreamVersion);
+    const QHash<int, QByteArray> names = roleNames();
+    out << persistedCacheMagic << persistedCacheVersion << m_persistedName
+        << persistedCacheKey(m_persistedName, names, m_rootItem.columnCount);
+    out << availableRoles() << names << QSize(m_rootItem.columnCount, m_rootItem.rowCount);
+    writeCacheEntries(out, m_headerData[0], m_headerData[0].size());
+    writeCacheEntries(out, m_headerData[1], std::min(m_headerData[1].size(), qsizetype(rows.size())));
+    out << qint32(rows.size());
+    for (const CacheData *item : rows) {
+        out << item->hasChildren;
+        writeCacheEntries(out, item->cachedRowEntry, item->cachedRowEntry.size());
+    }
+    if (out.status() != QDataStream::Ok || !file.commit())
+        qCWarning(QT_REMOTEOBJECT_MODELS) << "Cannot write model cache" << m_persistedCacheFile << file.errorString();
+}
+
+// Two ranges can be merged if their union is a rectangle
+static bool canMergeRanges(const QRect &a, const QRect &b)
+{
+    if (a.contains(b) || b.contains(a))
+        return true;
+    if (a.left() == b.left() && a.right() == b.right())
+        return a.top() <= b.bottom() + 1 && b.top() <= a.bottom() + 1;
+    if (a.top() == b.top() && a.bottom() == b.bottom())
+        return a.left() <= b.right() + 1 && b.left() <= a.right() + 1;
+    return false;
+}
+
+void QAbstractItemModelReplicaImplementation::emitPendingDataChanged()
+{
+    struct Range
+    {
+        QModelIndex parent;
+        QRect rect; // x is the column, y the row
+        QList<int> roles;
+    };
+    std::vector<Range> ranges;
+    for (const PendingDataChange &change : qExchange(m_pendingDataChanges, {})) {
+        // The rows may have been removed since they were filled
+        if (!change.topLeft.isValid() || !change.bottomRight.isValid())
+            continue;
+        Range range{change.topLeft.parent(),
+                    QRect(QPoint(change.topLeft.column(), change.topLeft.row()),
+                          QPoint(change.bottomRight.column(), change.bottomRight.row())),
+                    change.roles};
+        // Merge with what is already collected, a merged range may now merge with others
+        auto it = ranges.begin();
+        while (it != ranges.end()) {
+            if (it->parent == range.parent && it->roles == range.roles && canMergeRanges(it->rect, range.rect)) {
+                range.rect = range.rect.united(it->rect);
+                ranges.erase(it);
+                it = ranges.begin();
+            } else {
+                ++it;
+            }
+        }
+        ranges.push_back(std::move(range));
+    }
+
+    qCDebug(QT_REMOTEOBJECT_MODELS) << Q_FUNC_INFO << "ranges=" << ranges.size();
+    for (const Range &range : ranges) {
+        emit q->dataChanged(q->index(range.rect.top(), range.rect.left(), range.parent),
+                            q->index(range.rect.bottom(), range.rect.right(), range.parent),
+                            range.roles);
+    }
+}
+
 void QAbstractItemModelReplicaImplementation::fetchPendingData()
 {
     if (m_requestedData.isEmpty())
@@ -755,6 +996,19 @@ void QAbstractItemModelReplicaImplementation::requestedHeaderData(QRemoteObjectP
     QAbstractItemModelReplica makes replicating QAbstractItemModels more
     efficient by employing caching and pre-fetching.
 
+    If the node has a \l {QRemoteObjectNode::}{modelCacheDirectory()}, the
+    replica stores its top \l {QRemoteObjectNode::}{modelCacheRows()} rows,
+    header data and role names there when it is destroyed, if it was
+    initialized. The next replica of the model acquired with that directory
+    shows this data immediately, before isInitialized() is \c true, and
+    replaces it with the \l {Source}'s data once initialized. The data is
+    stored with the name of the \l Source and a key of its role names and
+    column count, and is only shown for a replica of the same name.
+
+    Data missing from the cache is fetched a row at a time. For models with
+    more columns than columnWindowSize(), only the window of that many columns
+    containing the requested index is fetched.
+
     \sa QAbstractItemModel
 */
 
@@ -865,7 +1119,7 @@ void QAbstractItemModelReplica::multiData(const QModelIndex &index,
 {
     Q_ASSERT(checkIndex(index, CheckIndexOption::IndexIsValid));
 
-    if (!d->isInitialized()) {
+    if (!d->isInitialized() && !d->m_showingPersistedCache) {
         qCDebug(QT_REMOTEOBJECT_MODELS)<<"Data not initialized yet";
 
         for (auto &roleData : roleDataSpan)
@@ -902,16 +1156,26 @@ void QAbstractItemModelReplica::multiData(const QModelIndex &index,
         }
     }
 
-    if (rolesToFetch.empty())
+    // Nothing can be fetched while showing persisted data without a source
+    if (rolesToFetch.empty() || !d->isInitialized())
         return;
 
     auto parentItem = d->cacheData(index.parent());
     Q_ASSERT(parentItem);
     Q_ASSERT(index.row() < parentItem->rowCount);
     const int row = index.row();
+    // Narrow models fetch whole rows. Wide ones fetch the aligned window of
+    // columns containing the index, requests for neighbouring cells then
+    // end up in the same fetch and the rest of the window is read ahead.
+    int startColumn = 0;
+    int endColumn = std::max(0, parentItem->columnCount - 1);
+    if (parentItem->columnCount > d->m_columnWindow) {
+        startColumn = index.column() - index.column() % d->m_columnWindow;
+        endColumn = std::min(endColumn, startColumn + d->m_columnWindow - 1);
+    }
     IndexList parentList = toModelIndexList(index.parent(), this);
-    IndexList start = IndexList() << parentList << ModelIndex(row, 0);
-    IndexList end = IndexList() << parentList << ModelIndex(row, std::max(0, parentItem->columnCount - 1));
+    IndexList start = IndexList() << parentList << ModelIndex(row, startColumn);
+    IndexList end = IndexList() << parentList << ModelIndex(row, endColumn);
     Q_ASSERT(toQModelIndex(start, this).isValid());
 
     RequestedData data;
@@ -984,7 +1248,8 @@ bool QAbstractItemModelReplica::hasChildren(const QModelIndex &parent) const
 int QAbstractItemModelReplica::rowCount(const QModelIndex &parent) const
 {
     auto parentItem = d->cacheData(parent);
-    const bool canHaveChildren = parentItem && parentItem->hasChildren && !parentItem->rowCount && parent.column() == 0;
+    const bool canHaveChildren = parentItem && parentItem->hasChildren && !parentItem->rowCount && parent.column() == 0
+                                 && d->isInitialized();
     if (canHaveChildren) {
         IndexList parentList = toModelIndexList(parent, this);
         QRemoteObjectPendingReply<QSize> reply = d->replicaSizeRequest(parentList);
@@ -1031,6 +1296,8 @@ QVariant QAbstractItemModelReplica::headerData(int section, Qt::Orientation orie
     QHash<int, QVariant>::ConstIterator it = dat.constFind(role);
     if (it != dat.constEnd())
         return it.value();
+    if (!d->isInitialized())
+        return QVariant();
 
     RequestedHeaderData data;
     data.role = role;
@@ -1076,7 +1343,7 @@ bool QAbstractItemModelReplica::isInitialized() const
 */
 bool QAbstractItemModelReplica::hasData(const QModelIndex &index, int role) const
 {
-    if (!d->isInitialized() || !index.isValid())
+    if ((!d->isInitialized() && !d->m_showingPersistedCache) || !index.isValid())
         return false;
     auto item = d->cacheData(index);
     if (!item)
@@ -1111,6 +1378,32 @@ void QAbstractItemModelReplica::setRootCacheSize(size_t rootCacheSize)
     d->m_rootItem.children.setCacheSize(rootCacheSize);
 }
 
+/*!
+    \since 6.2
+
+    Returns the number of columns fetched at a time for rows missing from the
+    cache. The default is 64.
+
+    \sa setColumnWindowSize()
+*/
+int QAbstractItemModelReplica::columnWindowSize() const
+{
+    return d->m_columnWindow;
+}
+
+/*!
+    \since 6.2
+
+    Fetches rows missing from the cache in windows of \a columns columns,
+    for models with more columns than that. A value of 0 restores the default.
+
+    \sa columnWindowSize()
+*/
+void QAbstractItemModelReplica::setColumnWindowSize(int columns)
+{
+    d->m_columnWindow = columns > 0 ? columns : DefaultColumnWindow;
+}
+
 /*!
     Returns a list of available roles.
 
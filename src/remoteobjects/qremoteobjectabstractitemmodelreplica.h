@@ -76,6 +76,9 @@ public:
     size_t rootCacheSize() const;
     void setRootCacheSize(size_t rootCacheSize);
 
+    int columnWindowSize() const;
+    void setColumnWindowSize(int columns);
+
 Q_SIGNALS:
     void initialized();
 
@@ -83,6 +86,7 @@ private:
     explicit QAbstractItemModelReplica(QAbstractItemModelReplicaImplementation *rep, QtRemoteObjects::InitialAction action, const QList<int> &rolesHint);
     QScopedPointer<QAbstractItemModelReplicaImplementation> d;
     friend class QAbstractItemModelReplicaImplementation;
+    friend class QAbstractItemModelReplicaSourceAdapter;
     friend class QRemoteObjectNode;
 };
 
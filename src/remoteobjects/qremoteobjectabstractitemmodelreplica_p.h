@@ -63,6 +63,7 @@ QT_BEGIN_NAMESPACE
 
 namespace {
     const int DefaultNodesCacheSize = 1000;
+    const int DefaultColumnWindow = 64;
 }
 
 struct CacheEntry
@@ -235,6 +236,15 @@ struct CacheData
 
     ~CacheData();
 
+    // Wide rows are fetched in column windows, so columns are filled in any
+    // order. An entry without data is a column that has not been fetched yet.
+    CacheEntry &ensureColumn(int column)
+    {
+        if (column >= cachedRowEntry.size())
+            cachedRowEntry.resize(column + 1);
+        return cachedRowEntry[column];
+    }
+
     void ensureChildren(int start, int end)
     {
         for (int i = start; i <= end; ++i)
@@ -277,6 +287,13 @@ struct RequestedData
     QList<int> roles;
 };
 
+struct PendingDataChange
+{
+    QPersistentModelIndex topLeft;
+    QPersistentModelIndex bottomRight;
+    QList<int> roles;
+};
+
 struct RequestedHeaderData
 {
     int role;
@@ -336,13 +353,19 @@ public:
 
     inline const QList<int> &availableRoles() const
     {
-        if (m_availableRoles.isEmpty())
-            m_availableRoles = propAsVariant(0).value<QList<int>>();
+        if (m_availableRoles.isEmpty()) {
+            if (m_showingPersistedCache && !isInitialized())
+                m_availableRoles = m_persistedRoles;
+            else
+                m_availableRoles = propAsVariant(0).value<QList<int>>();
+        }
         return m_availableRoles;
     }
 
     QHash<int, QByteArray> roleNames() const
     {
+       if (m_showingPersistedCache && !isInitialized())
+           return m_persistedRoleNames;
        QIntHash roles = propAsVariant(1).value<QIntHash>();
        return roles;
     }
@@ -422,8 +445,20 @@ public Q_SLOTS:
     void handleSizeDone(QRemoteObjectPendingCallWatcher *watcher);
     void onReplicaCurrentChanged(const QModelIndex &current, const QModelIndex &previous);
     void fillCache(const IndexValuePair &pair,const QList<int> &roles);
+    void fillCache(const DataEntries &entries, const QList<int> &roles);
 
 public:
+    // dataChanged for fetched data is emitted once per event loop iteration,
+    // with the ranges filled in between merged
+    void queueDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+    void emitPendingDataChanged();
+
+    // Warm start from the cache file written by the last replica of the model,
+    // if the node has a model cache directory. The data is shown until the source's
+    // data replaces it on initialization.
+    void loadPersistedCache(const QString &name);
+    void savePersistedCache();
+
     QScopedPointer<QItemSelectionModel> m_selectionModel;
     QList<CacheEntry> m_headerData[2];
 
@@ -462,6 +497,7 @@ public:
 
     bool m_initDone = false;
     QList<RequestedData> m_requestedData;
+    QList<PendingDataChange> m_pendingDataChanges;
     QList<RequestedHeaderData> m_requestedHeaderData;
     QList<QRemoteObjectPendingCallWatcher*> m_pendingRequests;
     QAbstractItemModelReplica *q;
@@ -469,6 +505,15 @@ public:
     std::unordered_set<CacheData*> m_activeParents;
     QtRemoteObjects::InitialAction m_initialAction;
     QList<int> m_initialFetchRolesHint;
+    // Models with more columns than this fetch a window of columns around
+    // the requested index instead of the whole row
+    int m_columnWindow = DefaultColumnWindow;
+    QString m_persistedCacheFile;
+    QString m_persistedName;
+    int m_persistedRows = 0;
+    bool m_showingPersistedCache = false;
+    QList<int> m_persistedRoles;
+    QHash<int, QByteArray> m_persistedRoleNames;
 };
 
 QT_END_NAMESPACE
@@ -86,7 +86,7 @@ struct IndexValuePair
     IndexList index;
     QVariantList data;
     Qt::ItemFlags flags;
-    bool hasChildren;
+    bool hasChildren; // of the row, whatever the column of index
     QList<IndexValuePair> children;
     QSize size;
 };
@@ -50,7 +50,15 @@
 #include "qremoteobjectsource_p.h"
 #include "qremoteobjectabstractitemmodelreplica_p.h"
 #include "qremoteobjectabstractitemmodeladapter_p.h"
+#include "qconnectionpool_p.h"
 #include <QtCore/qabstractitemmodel.h>
+#if QT_CONFIG(sharedmemory)
+#include <QtCore/qsharedmemory.h>
+#endif
+#include <QtNetwork/qhostaddress.h>
+#if QT_CONFIG(udpsocket)
+#include <QtNetwork/qnetworkdatagram.h>
+#endif
 #include <memory>
 #include <algorithm>
 
@@ -59,11 +67,153 @@ QT_BEGIN_NAMESPACE
 using namespace QtRemoteObjects;
 using namespace QRemoteObjectStringLiterals;
 
-using GadgetType = QList<QVariant>;
+// Dynamic gadget values are stored in a contiguous layout computed from the
+// received definition: a pointer to the type's GadgetLayout, followed by each
+// property constructed in place at its aligned offset.
+struct GadgetField
+{
+    QMetaType metaType;
+    uint offset;
+    // What QVariant::save writes ahead of a value of this type, so the field can
+    // be streamed in the same format without creating a QVariant.  Empty if the
+    // field has to go through QVariant.
+    QByteArray variantHeader;
+};
+
+struct GadgetLayout
+{
+    QList<GadgetField> fields;
+    uint size = sizeof(const GadgetLayout *);
+    uint alignment = alignof(const GadgetLayout *);
+
+    static const GadgetLayout *of(const void *gadget)
+    {
+        return *static_cast<const GadgetLayout * const *>(gadget);
+    }
+
+    static void *fieldData(void *gadget, const GadgetField &field)
+    {
+        return static_cast<char *>(gadget) + field.offset;
+    }
+
+    static const void *fieldData(const void *gadget, const GadgetField &field)
+    {
+        return static_cast<const char *>(gadget) + field.offset;
+    }
+
+    void addField(QMetaType metaType)
+    {
+        GadgetField field{metaType, size, QRemoteObjectPackets::variantHeader(metaType)};
+        if (metaType.isValid()) {
+            const uint fieldAlignment = std::max(uint(metaType.alignOf()), 1u);
+            field.offset = (size + fieldAlignment - 1) & ~(fieldAlignment - 1);
+            size = field.offset + uint(metaType.sizeOf());
+            alignment = std::max(alignment, fieldAlignment);
+        }
+        fields.push_back(field);
+    }
+
+    void finalize()
+    {
+        size = (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    void construct(void *where) const
+    {
+        new (where) const GadgetLayout *(this);
+        for (const auto &field : fields) {
+            if (field.metaType.isValid())
+                field.metaType.construct(fieldData(where, field));
+        }
+    }
+
+    void copy(void *where, const void *from) const
+    {
+        new (where) const GadgetLayout *(this);
+        for (const auto &field : fields) {
+            if (field.metaType.isValid())
+                field.metaType.construct(fieldData(where, field), fieldData(from, field));
+        }
+    }
+
+    void move(void *where, void *from) const
+    {
+        new (where) const GadgetLayout *(this);
+        for (const auto &field : fields) {
+            if (!field.metaType.isValid())
+                continue;
+            const auto iface = field.metaType.iface();
+            if (iface->moveCtr)
+                iface->moveCtr(iface, fieldData(where, field), fieldData(from, field));
+            else
+                field.metaType.construct(fieldData(where, field), fieldData(from, field));
+        }
+    }
+
+    void destruct(void *gadget) const
+    {
+        for (const auto &field : fields) {
+            if (field.metaType.isValid())
+                field.metaType.destruct(fieldData(gadget, field));
+        }
+    }
+
+    bool equals(const void *a, const void *b) const
+    {
+        for (const auto &field : fields) {
+            if (field.metaType.isValid() && !field.metaType.equals(fieldData(a, field), fieldData(b, field)))
+                return false;
+        }
+        return true;
+    }
+
+    void save(QDataStream &ds, const void *gadget) const
+    {
+        for (const auto &field : fields) {
+            if (QRemoteObjectPackets::writeVariantHeader(ds, field.variantHeader))
+                field.metaType.save(ds, fieldData(gadget, field));
+            else if (field.metaType.isValid())
+                ds << QVariant(field.metaType, fieldData(gadget, field));
+            else
+                ds << QVariant();
+        }
+    }
+
+    void load(QDataStream &ds, void *gadget) const
+    {
+        for (const auto &field : fields) {
+            // Values sent with the expected type can be read straight into the field
+            if (QRemoteObjectPackets::skipVariantHeader(ds, field.variantHeader)) {
+                field.metaType.load(ds, fieldData(gadget, field));
+                continue;
+            }
+            QVariant value;
+            ds >> value;
+            if (!field.metaType.isValid() || !value.convert(field.metaType))
+                continue;
+            field.metaType.destruct(fieldData(gadget, field));
+            field.metaType.construct(fieldData(gadget, field), value.constData());
+        }
+    }
+};
+
+struct TypeInfo : public QtPrivate::QMetaTypeInterface
+{
+    const QMetaObject *metaObject;
+};
+static const QMetaObject *metaObjectFn(const QtPrivate::QMetaTypeInterface *self)
+{
+    return static_cast<const TypeInfo *>(self)->metaObject;
+}
+
+struct GadgetTypeInfo : public TypeInfo
+{
+    // Default constructed value new instances are copied from
+    const void *prototype;
+};
 
 struct ManagedGadgetTypeEntry
 {
-    GadgetType gadgetType;
     QMetaType gadgetMetaType;
     QList<QMetaType> enumMetaTypes;
     std::shared_ptr<QMetaObject> metaObject;
@@ -76,80 +226,78 @@ struct ManagedGadgetTypeEntry
     }
 };
 
+// Only guards type registration/unregistration, constructing values never locks
 static QMutex s_managedTypesMutex;
 static QHash<int, ManagedGadgetTypeEntry> s_managedTypes;
 static QHash<int, QSet<IoDeviceBase*>> s_trackedConnections;
 
 static void GadgetsStaticMetacallFunction(QObject *_o, QMetaObject::Call _c, int _id, void **_a)
 {
+    if (_c != QMetaObject::ReadProperty && _c != QMetaObject::WriteProperty)
+        return;
+
+    void *gadget = reinterpret_cast<void *>(_o);
+    const GadgetLayout *layout = GadgetLayout::of(gadget);
+    if (_id >= layout->fields.size())
+        return;
+    const auto &field = layout->fields.at(_id);
+    if (!field.metaType.isValid())
+        return;
+    void *data = GadgetLayout::fieldData(gadget, field);
     if (_c == QMetaObject::ReadProperty) {
-        GadgetType *_t = reinterpret_cast<GadgetType *>(_o);
-        if (_id < _t->size()) {
-            const auto &prop = _t->at(_id);
-            prop.metaType().destruct(_a[0]);
-            prop.metaType().construct(_a[0], prop.constData());
-        }
-    } else if (_c == QMetaObject::WriteProperty) {
-        GadgetType *_t = reinterpret_cast<GadgetType *>(_o);
-        if (_id < _t->size()) {
-            auto & prop = (*_t)[_id];
-            prop = QVariant(prop.metaType(), _a[0]);
-        }
+        field.metaType.destruct(_a[0]);
+        field.metaType.construct(_a[0], data);
+    } else {
+        field.metaType.destruct(data);
+        field.metaType.construct(data, _a[0]);
     }
 }
 
 static void GadgetTypedDestructor(const QtPrivate::QMetaTypeInterface *, void *ptr)
 {
-    reinterpret_cast<GadgetType*>(ptr)->~GadgetType();
+    GadgetLayout::of(ptr)->destruct(ptr);
 }
 
 static void GadgetTypedConstructor(const QtPrivate::QMetaTypeInterface *interface, void *where)
 {
-    GadgetType *gadget = new(where) GadgetType;
-    QMutexLocker lock(&s_managedTypesMutex);
-    auto it = s_managedTypes.find(interface->typeId);
-    if (it == s_managedTypes.end()) {
-        delete gadget;
-        gadget = nullptr;
-        return;
-    }
-    *gadget = it->gadgetType;
+    const void *prototype = static_cast<const GadgetTypeInfo *>(interface)->prototype;
+    GadgetLayout::of(prototype)->copy(where, prototype);
 }
 
 static void GadgetTypedCopyConstructor(const QtPrivate::QMetaTypeInterface *, void *where, const void *copy)
 {
-    new(where) GadgetType(*reinterpret_cast<const GadgetType*>(copy));
+    GadgetLayout::of(copy)->copy(where, copy);
 }
 
 static void GadgetTypedMoveConstructor(const QtPrivate::QMetaTypeInterface *, void *where, void *copy)
 {
-    new(where) GadgetType(std::move(*reinterpret_cast<GadgetType*>(copy)));
+    GadgetLayout::of(copy)->move(where, copy);
 }
 
 static bool GadgetEqualsFn(const QtPrivate::QMetaTypeInterface *, const void *a, const void *b)
 {
-    return *reinterpret_cast<const GadgetType*>(a) == *reinterpret_cast<const GadgetType*>(b);
+    return GadgetLayout::of(a)->equals(a, b);
 }
 
 static void GadgetDebugStreamFn(const QtPrivate::QMetaTypeInterface *, QDebug &dbg, const void *a)
 {
-    const GadgetType *gadgetProperties = reinterpret_cast<const GadgetType *>(a);
-    for (const auto &prop : *gadgetProperties)
-        dbg << prop;
+    const GadgetLayout *layout = GadgetLayout::of(a);
+    for (const auto &field : layout->fields) {
+        if (field.metaType.isValid())
+            dbg << QVariant(field.metaType, GadgetLayout::fieldData(a, field));
+        else
+            dbg << QVariant();
+    }
 }
 
 static void GadgetDataStreamOutFn(const QtPrivate::QMetaTypeInterface *, QDataStream &ds, const void *a)
 {
-    const GadgetType *gadgetProperties = reinterpret_cast<const GadgetType *>(a);
-    for (const auto &prop : *gadgetProperties)
-        ds << prop;
+    GadgetLayout::of(a)->save(ds, a);
 }
 
 static void GadgetDataStreamInFn(const QtPrivate::QMetaTypeInterface *, QDataStream &ds, void *a)
 {
-    GadgetType *gadgetProperties = reinterpret_cast<GadgetType *>(a);
-    for (auto &prop : *gadgetProperties)
-        ds >> prop;
+    GadgetLayout::of(a)->load(ds, a);
 }
 
 // Like the Q_GADGET static methods above, we need constructor/destructor methods
@@ -365,6 +513,238 @@ void QRemoteObjectNode::setHeartbeatInterval(int interval)
     emit heartbeatIntervalChanged(interval);
 }
 
+/*!
+    \since 6.2
+
+    Returns \c true if connections this node opens are shared with the other
+    nodes of the process.
+
+    \sa setSharedConnectionsEnabled()
+*/
+bool QRemoteObjectNode::sharedConnectionsEnabled() const
+{
+    Q_D(const QRemoteObjectNode);
+    return d->m_sharedConnections;
+}
+
+/*!
+    \since 6.2
+
+    If \a enabled is \c true, the connections opened by connectToNode()
+    afterwards are shared by the nodes of the process that enabled sharing
+    and connect to the same url, also when they live in different threads.
+    The host then sends each property change once per process rather than once
+    per node, and a node acquiring a Source another node already acquired is
+    initialized without asking the host again. Sharing is disabled by default.
+
+    A shared connection negotiates its capabilities with the host on its own.
+    Replicas acquired over it can send batches of calls, but don't get
+    sequence numbers, property values from a shared memory page, or property
+    changes over multicast, even if the node or the host enables them.
+
+    \sa sharedConnectionsEnabled(), connectToNode()
+*/
+void QRemoteObjectNode::setSharedConnectionsEnabled(bool enabled)
+{
+    Q_D(QRemoteObjectNode);
+    d->m_sharedConnections = enabled;
+}
+
+/*!
+    \since 6.2
+
+    Returns \c true if this node asks hosts to number the packets of each
+    Source.
+
+    \sa setSequenceNumbersEnabled()
+*/
+bool QRemoteObjectNode::sequenceNumbersEnabled() const
+{
+    Q_D(const QRemoteObjectNode);
+    return d->m_sequenceNumbers;
+}
+
+/*!
+    \since 6.2
+
+    If \a enabled is \c true, the node asks hosts it connects to afterwards to
+    number the packets of each Source. Replicas then drop duplicated updates,
+    and acquire their Source again to get all current values when updates went
+    missing. Sequence numbers are disabled by default.
+
+    Clients using sequence numbers don't read property values from shared
+    memory nor get them over multicast, see
+    QRemoteObjectHostBase::setSharedStateEnabled() and
+    QRemoteObjectHostBase::setMulticastUrl(). Shared connections don't use
+    them either, see setSharedConnectionsEnabled().
+*/
+void QRemoteObjectNode::setSequenceNumbersEnabled(bool enabled)
+{
+    Q_D(QRemoteObjectNode);
+    d->m_sequenceNumbers = enabled;
+}
+
+/*!
+    \since 6.2
+
+    Returns the size in bytes above which peers send packets to this node in
+    fragments.
+
+    \sa setMaxFrameSize()
+*/
+int QRemoteObjectNode::maxFrameSize() const
+{
+    Q_D(const QRemoteObjectNode);
+    return int(d->m_maxFrameSize);
+}
+
+/*!
+    \since 6.2
+
+    Sets the size in bytes above which peers send packets to this node in
+    fragments to \a bytes. The size is announced to the peer when a
+    connection is opened, so it applies to connections opened afterwards. A
+    value of 0 restores the default of 1 MiB.
+
+    Fragments are reassembled in memory before the packet is handled, so a
+    packet holding, for example, a large property value needs its full size in
+    memory at the receiver. Peers that don't support fragments send packets
+    whole, whatever their size.
+
+    \sa setMaxMessageSize()
+*/
+void QRemoteObjectNode::setMaxFrameSize(int bytes)
+{
+    Q_D(QRemoteObjectNode);
+    d->m_maxFrameSize = bytes > 0 ? qMin(quint32(bytes), QtRemoteObjects::fragmentSizeMask)
+                                  : QtRemoteObjects::defaultMaxFrameSize;
+}
+
+/*!
+    \since 6.2
+
+    Returns the size in bytes of the largest packet this node reassembles from
+    fragments.
+
+    \sa setMaxMessageSize()
+*/
+int QRemoteObjectNode::maxMessageSize() const
+{
+    Q_D(const QRemoteObjectNode);
+    return int(d->m_maxMessageSize);
+}
+
+/*!
+    \since 6.2
+
+    Sets the size in bytes of the largest packet this node reassembles from
+    fragments to \a bytes, for connections opened afterwards. A connection
+    receiving fragments of a larger packet is closed before they are buffered.
+    A value of 0 removes the limit. The default is 64 MiB.
+
+    Packets that are not fragmented are not limited, peers that don't support
+    fragments can send packets of any size.
+
+    \sa setMaxFrameSize()
+*/
+void QRemoteObjectNode::setMaxMessageSize(int bytes)
+{
+    Q_D(QRemoteObjectNode);
+    d->m_maxMessageSize = quint32(qMax(0, bytes));
+}
+
+/*!
+    \since 6.2
+
+    Returns the directory model replicas acquired from this node keep their
+    cache in, or an empty string if they don't keep one.
+
+    \sa setModelCacheDirectory(), acquireModel()
+*/
+QString QRemoteObjectNode::modelCacheDirectory() const
+{
+    Q_D(const QRemoteObjectNode);
+    return d->m_modelCacheDirectory;
+}
+
+/*!
+    \since 6.2
+
+    Sets the directory model replicas acquired from this node keep their cache
+    in to \a path. A \l QAbstractItemModelReplica stores its top rows there
+    when it is destroyed, and a replica of the same model acquired afterwards
+    shows them until it is initialized. An empty \a path, the default,
+    disables the cache.
+
+    \sa modelCacheRows(), acquireModel()
+*/
+void QRemoteObjectNode::setModelCacheDirectory(const QString &path)
+{
+    Q_D(QRemoteObjectNode);
+    d->m_modelCacheDirectory = path;
+}
+
+/*!
+    \since 6.2
+
+    Returns the number of top rows model replicas acquired from this node
+    store in their cache.
+
+    \sa setModelCacheRows()
+*/
+int QRemoteObjectNode::modelCacheRows() const
+{
+    Q_D(const QRemoteObjectNode);
+    return d->m_modelCacheRows;
+}
+
+/*!
+    \since 6.2
+
+    Sets the number of top rows model replicas acquired from this node store
+    in their cache to \a rows. Only rows the replica has fetched are stored.
+    The default is 100.
+
+    \sa setModelCacheDirectory()
+*/
+void QRemoteObjectNode::setModelCacheRows(int rows)
+{
+    Q_D(QRemoteObjectNode);
+    d->m_modelCacheRows = qMax(0, rows);
+}
+
+/*!
+    \since 6.2
+
+    Returns the number of replies to \c CACHED slots each replica acquired
+    from this node keeps.
+
+    \sa setReplyCacheSize()
+*/
+int QRemoteObjectNode::replyCacheSize() const
+{
+    Q_D(const QRemoteObjectNode);
+    return d->m_replyCacheSize;
+}
+
+/*!
+    \since 6.2
+
+    Sets the number of replies to \c CACHED slots each replica acquired from
+    this node keeps to \a size. When a replica reaches the limit, the least
+    recently used reply is dropped. A \a size of 0 disables the cache. The
+    default is 128.
+
+    The size applies to replicas acquired after this call.
+
+    \sa acquire()
+*/
+void QRemoteObjectNode::setReplyCacheSize(int size)
+{
+    Q_D(QRemoteObjectNode);
+    d->m_replyCacheSize = qMax(0, size);
+}
+
 /*!
     \since 5.12
     \typedef QRemoteObjectNode::RemoteObjectSchemaHandler
@@ -812,14 +1192,6 @@ static const char *strDup(const QByteArray &s)
 }
 
 using Gadgets = QHash<QByteArray, GadgetData>;
-struct TypeInfo : public QtPrivate::QMetaTypeInterface
-{
-    const QMetaObject *metaObject;
-};
-static const QMetaObject *metaObjectFn(const QtPrivate::QMetaTypeInterface *self)
-{
-    return static_cast<const TypeInfo *>(self)->metaObject;
-}
 
 template <class Int>
 static TypeInfo *enumMetaType(const QByteArray &name, uint size, const QMetaObject *meta=nullptr)
@@ -890,6 +1262,9 @@ static int registerGadgets(IoDeviceBase *connection, Gadgets &gadgets, QByteArra
     }
 
     ManagedGadgetTypeEntry entry;
+    // Like the TypeInfo, the layout and the prototype value are never freed:
+    // values of the type can outlive its registration.
+    auto layout = new GadgetLayout;
 
     QMetaObjectBuilder gadgetBuilder;
     gadgetBuilder.setClassName(typeName);
@@ -898,7 +1273,7 @@ static int registerGadgets(IoDeviceBase *connection, Gadgets &gadgets, QByteArra
         int propertyType = QMetaType::fromName(prop.type).id();
         if (!propertyType && gadgets.contains(prop.type))
             propertyType = registerGadgets(connection, gadgets, prop.type);
-        entry.gadgetType.push_back(QVariant(QMetaType(propertyType)));
+        layout->addField(QMetaType(propertyType));
         auto dynamicProperty = gadgetBuilder.addProperty(prop.name, prop.type);
         dynamicProperty.setWritable(true);
         dynamicProperty.setReadable(true);
@@ -929,33 +1304,40 @@ static int registerGadgets(IoDeviceBase *connection, Gadgets &gadgets, QByteArra
         qCDebug(QT_REMOTEOBJECT) << "Registering new gadget enum with id" << id << typeInfo->name << "size:" << typeInfo->size;
     }
 
+    layout->finalize();
+
     QMetaType::TypeFlags flags = QMetaType::IsGadget;
     if (meta->propertyCount()) {
         meta->d.static_metacall = &GadgetsStaticMetacallFunction;
         meta->d.superdata = nullptr;
         flags |= QMetaType::NeedsConstruction | QMetaType::NeedsDestruction;
-        auto typeInfo = new TypeInfo {
+        void *prototype = ::operator new(layout->size, std::align_val_t(layout->alignment));
+        layout->construct(prototype);
+        auto typeInfo = new GadgetTypeInfo {
             {
-                0, alignof(GadgetType), sizeof(GadgetType), uint(flags), 0, metaObjectFn,
-                strDup(typeName),
-                GadgetTypedConstructor,
-                GadgetTypedCopyConstructor,
-                GadgetTypedMoveConstructor,
-                GadgetTypedDestructor,
-                GadgetEqualsFn,
-                nullptr, /* LessThanFn */
-                GadgetDebugStreamFn,
-                GadgetDataStreamOutFn,
-                GadgetDataStreamInFn,
-                nullptr /* LegacyRegisterOp */
+                {
+                    0, ushort(layout->alignment), layout->size, uint(flags), 0, metaObjectFn,
+                    strDup(typeName),
+                    GadgetTypedConstructor,
+                    GadgetTypedCopyConstructor,
+                    GadgetTypedMoveConstructor,
+                    GadgetTypedDestructor,
+                    GadgetEqualsFn,
+                    nullptr, /* LessThanFn */
+                    GadgetDebugStreamFn,
+                    GadgetDataStreamOutFn,
+                    GadgetDataStreamInFn,
+                    nullptr /* LegacyRegisterOp */
+                },
+                meta
             },
-            meta
+            prototype
         };
         entry.gadgetMetaType = QMetaType(typeInfo);
     } else {
         auto typeInfo = new TypeInfo {
             {
-                0, alignof(GadgetType), sizeof(GadgetType), uint(flags), 0, metaObjectFn,
+                0, ushort(layout->alignment), layout->size, uint(flags), 0, metaObjectFn,
                 strDup(typeName),
                 nullptr,
                 nullptr,
@@ -1188,6 +1570,20 @@ void QRemoteObjectNodePrivate::connectReplica(QObject *object, QRemoteObjectRepl
         qROPrivDebug() << sig << res;
     }
 
+    // The in-process replica has no property storage to update, so follow the
+    // NOTIFY signals to keep propertySnapshotChanged() in sync. The snapshot is
+    // built again on the next read, before other slots see the signal.
+    QObject::connect(instance, &QRemoteObjectReplica::propertySnapshotChanged, instance, [instance]() {
+        static_cast<QRemoteObjectReplicaImplementation *>(instance->d_impl.data())->resetPropertySnapshot();
+    });
+    static const int snapshotChangedIndex = QRemoteObjectReplica::staticMetaObject.indexOfSignal("propertySnapshotChanged()");
+    static const int propertyOffset = QRemoteObjectReplica::staticMetaObject.propertyCount();
+    for (int idx = propertyOffset; idx < us->propertyCount(); ++idx) {
+        const int notifyIndex = us->property(idx).notifySignalIndex();
+        if (notifyIndex >= 0)
+            QMetaObject::connect(instance, notifyIndex, instance, snapshotChangedIndex, Qt::DirectConnection, nullptr);
+    }
+
     qROPrivDebug() << "# connections =" << nConnections;
 }
 
@@ -1218,11 +1614,14 @@ bool QRemoteObjectNodePrivate::initConnection(const QUrl &address)
         return true;
     }
 
-    ClientIoDevice *connection = QtROClientFactory::instance()->create(address, q);
+    ClientIoDevice *connection = m_sharedConnections ? QtROConnectionPool::create(address, q)
+                                                     : QtROClientFactory::instance()->create(address, q);
     if (!connection) {
         qROPrivWarning() << "Could not create ClientIoDevice for client. Invalid url/scheme provided?" << address;
         return false;
     }
+    connection->setMaxFrameSize(m_maxFrameSize);
+    connection->setMaxMessageSize(m_maxMessageSize);
     qROPrivDebug() << "Opening connection to" << address.toString();
     qROPrivDebug() << "Replica Connection isValid" << connection->isOpen();
     QObject::connect(connection, &ClientIoDevice::shouldReconnect, q, [this, connection]() {
@@ -1282,6 +1681,8 @@ void QRemoteObjectNodePrivate::onRemoteObjectSourceAdded(const QRemoteObjectSour
         initConnection(entry.second.hostUrl);
 
         qROPrivDebug() << "Called initConnection due to new RemoteObjectSource added via registry" << entry.first;
+    } else if (handleSlots.contains(entry.first)) {
+        initConnection(entry.second.hostUrl);
     }
 }
 
@@ -1310,6 +1711,8 @@ void QRemoteObjectNodePrivate::onRegistryInitialized()
 
             continue;
         }
+        if (handleSlots.contains(i.key()) && !requestedUrls.contains(i.value().hostUrl))
+            initConnection(i.value().hostUrl);
     }
 }
 
@@ -1321,6 +1724,7 @@ void QRemoteObjectNodePrivate::onShouldReconnect(ClientIoDevice *ioDevice)
     for (const QString &remoteObject : remoteObjects) {
         connectedSources.remove(remoteObject);
         ioDevice->removeSource(remoteObject);
+        handleLost(remoteObject);
         if (replicas.contains(remoteObject)) { //We have a replica waiting on this remoteObject
             QSharedPointer<QConnectedReplicaImplementation> rep = qSharedPointerCast<QConnectedReplicaImplementation>(replicas.value(remoteObject).toStrongRef());
             if (rep && !rep->connectionToSource.isNull()) {
@@ -1409,43 +1813,456 @@ QReplicaImplementationInterface *QRemoteObjectHostBasePrivate::handleNewAcquire(
     return QRemoteObjectNodePrivate::handleNewAcquire(meta, instance, name);
 }
 
-void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
+QRemoteObjectNodePrivate::HandleEntry *QRemoteObjectNodePrivate::handleEntry(int slot, quint32 generation)
 {
-    using namespace QRemoteObjectPackets;
-    IoDeviceBase *connection = qobject_cast<IoDeviceBase*>(obj);
-    QRemoteObjectPacketTypeEnum packetType;
-    Q_ASSERT(connection);
+    if (slot < 0 || slot >= handles.size())
+        return nullptr;
+    HandleEntry &entry = handles[slot];
+    if (entry.generation != generation || entry.name.isEmpty())
+        return nullptr;
+    return &entry;
+}
 
-    do {
-        if (!connection->read(packetType, rxName))
-            return;
+QRemoteObjectReplicaHandle QRemoteObjectNodePrivate::handle(int slot)
+{
+    Q_Q(QRemoteObjectNode);
+    return QRemoteObjectReplicaHandle(q, slot, handles.at(slot).generation);
+}
 
-        if (packetType != Handshake && !m_handshakeReceived) {
-            qROPrivWarning() << "Expected Handshake, got " << packetType;
-            setLastError(QRemoteObjectNode::ProtocolMismatch);
-            connection->close();
-            break;
-        }
+void QRemoteObjectNodePrivate::connectHandle(int slot)
+{
+    HandleEntry &entry = handles[slot];
+    if (entry.connection)
+        return;
+    const auto source = connectedSources.constFind(entry.name);
+    if (source == connectedSources.cend()) {
+        const auto sourceLocations = remoteObjectAddresses();
+        const auto it = sourceLocations.constFind(entry.name);
+        if (it != sourceLocations.constEnd())
+            initConnection(it.value().hostUrl);
+        return;
+    }
 
-        switch (packetType) {
-        case QRemoteObjectPacketTypeEnum::Pong:
-        {
-            QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
-            if (rep)
-                rep->notifyAboutReply(0, {});
-            else //replica has been deleted, remove from list
-                replicas.remove(rxName);
-            break;
+    entry.connection = source->device;
+    // Only the first handle of a type needs its definition. Sources without a
+    // signature, like plain QObjects and models, can't be told apart by it.
+    entry.meta = source->objectSignature.isEmpty() ? nullptr : handleTypes.value(source->objectSignature);
+    QRemoteObjectPackets::DataStreamPacket packet;
+    QRemoteObjectPackets::serializeAddObjectPacket(packet, entry.name, entry.meta == nullptr);
+    entry.connection->write(packet.array, packet.size);
+}
+
+void QRemoteObjectNodePrivate::releaseHandle(int slot)
+{
+    HandleEntry &entry = handles[slot];
+    if (entry.connection) {
+        QRemoteObjectPackets::DataStreamPacket packet;
+        QRemoteObjectPackets::serializeRemoveObjectPacket(packet, entry.name);
+        entry.connection->write(packet.array, packet.size);
+    }
+    handleSlots.remove(entry.name);
+    const quint32 generation = entry.generation + 1;
+    entry = HandleEntry();
+    entry.generation = generation;
+    freeHandles.append(slot);
+}
+
+void QRemoteObjectNodePrivate::handleLost(const QString &name)
+{
+    const int slot = handleSlots.value(name, -1);
+    if (slot < 0 || !handles.at(slot).connection)
+        return;
+    HandleEntry &entry = handles[slot];
+    entry.connection = nullptr;
+    // The values are kept, but no longer updated until the Source is back
+    entry.initialized = false;
+    if (entry.observer)
+        entry.observer->sourceLost(handle(slot));
+}
+
+QVariant QRemoteObjectNodePrivate::decodeHandleValue(IoDeviceBase *connection, const QMetaObject *meta, int index, QVariant value)
+{
+    using namespace QRemoteObjectPackets;
+
+    if (!meta)
+        return value;
+    if (value.canConvert<QRO_>()) {
+        const QRO_ typeInfo = value.value<QRO_>();
+        // Child objects are not acquired through handles
+        if (typeInfo.type != ObjectType::GADGET)
+            return QVariant();
+        QDataStream in(typeInfo.classDefinition);
+        parseGadgets(connection, in);
+        QDataStream ds(typeInfo.parameters);
+        ds >> value;
+    }
+    const QMetaProperty property = meta->property(index + meta->propertyOffset());
+    if (property.userType() == QMetaType::QVariant)
+        return value;
+    return decodeVariant(value, property.metaType());
+}
+
+bool QRemoteObjectNodePrivate::readSharedState(const QString &name, const QString &key, QByteArray &state)
+{
+#if QT_CONFIG(sharedmemory)
+    QSharedPointer<QSharedMemory> &page = sharedStates[name];
+    // A new key means the host moved the values to a larger page
+    if (!page || page->key() != key) {
+        page.reset(new QSharedMemory(key));
+        if (!page->attach(QSharedMemory::ReadOnly)) {
+            qROPrivWarning() << "Can't attach to the shared state of" << name << page->errorString();
+            sharedStates.remove(name);
+            return false;
         }
-        case QRemoteObjectPacketTypeEnum::Handshake:
-            if (rxName != QtRemoteObjects::protocolVersion) {
-                qWarning() << "*** Protocol Mismatch, closing connection ***. Got" << rxName << "expected" << QtRemoteObjects::protocolVersion;
+    }
+    if (QRemoteObjectPackets::readSharedState(page->constData(), page->size(), state))
+        return true;
+    qROPrivWarning() << "Can't read the shared state of" << name;
+#else
+    Q_UNUSED(key)
+    Q_UNUSED(state)
+    qROPrivWarning() << "Shared memory is not supported, can't read the shared state of" << name;
+#endif
+    return false;
+}
+
+void QRemoteObjectNodePrivate::setSharedProperty(IoDeviceBase *connection, QConnectedReplicaImplementation *rep, int index, QVariant &value)
+{
+    using namespace QRemoteObjectPackets;
+
+    if (index < 0 || index >= rep->m_propertyStorage.size())
+        return;
+    const QMetaProperty property = rep->m_metaObject->property(index + rep->m_metaObject->propertyOffset());
+    if (property.userType() == QMetaType::QVariant && value.canConvert<QRO_>()) {
+        // This is a type that requires registration
+        QRO_ typeInfo = value.value<QRO_>();
+        QDataStream in(typeInfo.classDefinition);
+        parseGadgets(connection, in);
+        QDataStream ds(typeInfo.parameters);
+        ds >> value;
+    }
+    rep->setProperty(index, decodeVariant(value, property.metaType()));
+    // The page has all values, only the changed ones are notified
+    if (rep->takeUnchangedProperty(index))
+        return;
+    const int notifyIndex = property.notifySignalIndex();
+    if (notifyIndex < 0)
+        return;
+    // The host sends signals with other arguments over the connection
+    const QMetaMethod notify = rep->m_metaObject->method(notifyIndex);
+    if (notify.parameterCount() > 1 || (notify.parameterCount() == 1 && notify.parameterMetaType(0) != property.metaType()))
+        return;
+    QVariant notifyValue = rep->getProperty(index);
+    void *args[] = {nullptr, notifyValue.data()};
+    QMetaObject::activate(rep, rep->metaObject(), notifyIndex, args);
+}
+
+bool QRemoteObjectNodePrivate::joinMulticastGroup(const QUrl &groupUrl)
+{
+#if QT_CONFIG(udpsocket)
+    if (multicastGroups.contains(groupUrl))
+        return true;
+    const QHostAddress address(groupUrl.host());
+    QSharedPointer<MulticastGroup> group(new MulticastGroup);
+    // Other nodes on this machine may be in the group as well
+    const QHostAddress any = address.protocol() == QAbstractSocket::IPv6Protocol ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4;
+    if (!group->socket.bind(any, quint16(groupUrl.port()), QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)
+        || !group->socket.joinMulticastGroup(address)) {
+        qROPrivWarning() << "Can't join multicast group" << groupUrl << group->socket.errorString();
+        return false;
+    }
+    MulticastGroup *g = group.data();
+    QObject::connect(&group->socket, &QUdpSocket::readyRead, q_ptr, [this, g, groupUrl]() {
+        onMulticastRead(g, groupUrl);
+    });
+    multicastGroups.insert(groupUrl, group);
+    qROPrivDebug() << "Joined multicast group" << groupUrl;
+    return true;
+#else
+    qROPrivWarning() << "UDP is not supported, can't join multicast group" << groupUrl;
+    return false;
+#endif
+}
+
+#if QT_CONFIG(udpsocket)
+void QRemoteObjectNodePrivate::onMulticastRead(MulticastGroup *group, const QUrl &groupUrl)
+{
+    while (group->socket.hasPendingDatagrams()) {
+        const QByteArray datagram = group->socket.receiveDatagram().data();
+        QString name;
+        quint64 sourceId;
+        quint32 sequence;
+        QByteArray packets;
+        if (!QRemoteObjectPackets::readMulticastDatagram(datagram, name, sourceId, sequence, packets))
+            continue;
+        // The group carries the sources of other nodes as well
+        QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(name).toStrongRef());
+        if (!rep || rep->isShortCircuit())
+            continue;
+        auto connectedRep = static_cast<QConnectedReplicaImplementation *>(rep.data());
+        // Another host can have a source of the same name in the group
+        if (connectedRep->m_multicastUrl != groupUrl || connectedRep->m_multicastId != sourceId)
+            continue;
+        if (packets.isEmpty()) {
+            connectedRep->checkMulticastHeartbeat(sequence);
+            continue;
+        }
+        if (!connectedRep->checkMulticastSequence(sequence))
+            continue;
+        // Paused replicas get what they missed on resume
+        if (connectedRep->isPaused())
+            continue;
+        readMulticastPackets(connectedRep, name, packets);
+    }
+}
+
+void QRemoteObjectNodePrivate::readMulticastPackets(QConnectedReplicaImplementation *rep, const QString &name, const QByteArray &packets)
+{
+    using namespace QRemoteObjectPackets;
+
+    // Anyone can send to the group, so the packets are not handled like those
+    // of a connection: only property changes of the source the datagram is
+    // from and their notify signals are taken
+    if (!rep->connectionToSource)
+        return;
+    QDataStream ds(packets);
+    ds.setVersion(QtRemoteObjects::dataStreamVersion);
+    const int propertyCount = rep->m_metaObject->propertyCount() - rep->m_metaObject->propertyOffset();
+    while (!ds.atEnd()) {
+        quint32 size = 0;
+        quint16 type = 0;
+        QString packetName;
+        ds >> size;
+        const qint64 end = ds.device()->pos() + size;
+        ds >> type >> packetName;
+        if (ds.status() != QDataStream::Ok || end > packets.size())
+            break;
+        if (packetName != name) {
+            qROPrivDebug() << "Dropping multicast packet of" << packetName << "in a datagram of" << name;
+        } else if (type == PropertyChangePacket) {
+            int propertyIndex;
+            QVariant value;
+            deserializePropertyChangePacket(ds, propertyIndex, value);
+            if (ds.status() == QDataStream::Ok && propertyIndex >= 0 && propertyIndex < propertyCount
+                && !rep->childIndices().contains(propertyIndex))
+                applyPropertyChange(rep->connectionToSource, rep, propertyIndex, value);
+        } else if (type == InvokePacket) {
+            int call, index, serialId, propertyIndex;
+            QVariantList args;
+            deserializeInvokePacket(ds, call, index, args, serialId, propertyIndex);
+            if (ds.status() != QDataStream::Ok)
+                break;
+            // Only the notify signal of a property, with its arguments
+            const bool notifiesProperty = call == QMetaObject::InvokeMetaMethod && propertyIndex >= 0 && propertyIndex < propertyCount
+                && rep->m_metaObject->property(propertyIndex + rep->m_metaObject->propertyOffset()).notifySignalIndex() == index + rep->m_signalOffset;
+            const QMetaMethod notify = rep->m_metaObject->method(index + rep->m_signalOffset);
+            if (!notifiesProperty
+                || (args.isEmpty() ? notify.parameterCount() > 1 : args.size() != notify.parameterCount())) {
+                qROPrivDebug() << "Dropping multicast call" << index << "of" << name;
+            } else if (rep->takeUnchangedProperty(propertyIndex)) {
+                qROPrivDebug() << "Dropping notify of unchanged property" << propertyIndex << "of" << name;
+            } else {
+                emitReplicaSignal(rep, index, args, propertyIndex);
+            }
+        } else {
+            qROPrivDebug() << "Dropping multicast packet of type" << type << "for" << name;
+        }
+        ds.device()->seek(end);
+    }
+}
+#endif
+
+void QRemoteObjectNodePrivate::applyPropertyChange(IoDeviceBase *connection, QRemoteObjectReplicaImplementation *rep, int propertyIndex, QVariant &value)
+{
+    QConnectedReplicaImplementation *connectedRep = nullptr;
+    if (!rep->isShortCircuit()) {
+        connectedRep = static_cast<QConnectedReplicaImplementation *>(rep);
+        if (!connectedRep->childIndices().contains(propertyIndex))
+            connectedRep = nullptr; //connectedRep will be a valid pointer only if propertyIndex is a child index
+    }
+    if (connectedRep) {
+        rep->setProperty(propertyIndex, handlePointerToQObjectProperty(connectedRep, propertyIndex, value));
+    } else {
+        const QMetaProperty property = rep->m_metaObject->property(propertyIndex + rep->m_metaObject->propertyOffset());
+        if (property.userType() == QMetaType::QVariant && value.canConvert<QRO_>()) {
+            // This is a type that requires registration
+            QRO_ typeInfo = value.value<QRO_>();
+            QDataStream in(typeInfo.classDefinition);
+            parseGadgets(connection, in);
+            QDataStream ds(typeInfo.parameters);
+            ds >> value;
+        }
+        rep->setProperty(propertyIndex, decodeVariant(value, property.metaType()));
+    }
+}
+
+void QRemoteObjectNodePrivate::emitReplicaSignal(QRemoteObjectReplicaImplementation *rep, int index, QVariantList &args, int propertyIndex)
+{
+    static QVariant null(QMetaType::fromType<QObject *>(), nullptr);
+    QVariant paramValue;
+    // Qt usually supports 9 arguments, so ten should be usually safe
+    QVarLengthArray<void*, 10> param(args.size() + 1);
+    param[0] = null.data(); //Never a return value
+    if (args.size()) {
+        auto signal = rep->m_metaObject->method(index+rep->m_signalOffset);
+        for (int i = 0; i < args.size(); i++) {
+            if (signal.parameterType(i) == QMetaType::QVariant)
+                param[i + 1] = const_cast<void*>(reinterpret_cast<const void*>(&args.at(i)));
+            else {
+                decodeVariant(args[i], signal.parameterMetaType(i));
+                param[i + 1] = const_cast<void *>(args.at(i).data());
+            }
+        }
+    } else if (propertyIndex != -1) {
+        param.resize(2);
+        paramValue = rep->getProperty(propertyIndex);
+        param[1] = paramValue.data();
+    }
+    qROPrivDebug() << "Replica Invoke-->" << rep->m_objectName << rep->m_metaObject->method(index+rep->m_signalOffset).name() << index << rep->m_signalOffset;
+    // We activate on rep->metaobject() so the private metacall is used, not m_metaobject (which
+    // is the class thie replica looks like)
+    QMetaObject::activate(rep, rep->metaObject(), index+rep->m_signalOffset, param.data());
+}
+
+void QRemoteObjectNodePrivate::initHandle(IoDeviceBase *connection, int slot, const QMetaObject *meta, const QVariantList &values)
+{
+    QVariantList decoded;
+    decoded.reserve(values.size());
+    for (int i = 0; i < values.size(); ++i)
+        decoded << decodeHandleValue(connection, meta, i, values.at(i));
+    HandleEntry &entry = handles[slot];
+    entry.connection = connection;
+    entry.meta = meta;
+    entry.values = std::move(decoded);
+    entry.initialized = true;
+    if (entry.observer)
+        entry.observer->initialized(handle(slot));
+}
+
+void QRemoteObjectNodePrivate::handlePropertyChange(IoDeviceBase *connection, int slot, int index, const QVariant &value)
+{
+    HandleEntry &entry = handles[slot];
+    if (!entry.initialized || index < 0 || index >= entry.values.size())
+        return;
+    const QVariant decoded = decodeHandleValue(connection, entry.meta, index, value);
+    if (entry.values.at(index) == decoded)
+        return;
+    entry.values[index] = decoded;
+    if (entry.observer)
+        entry.observer->propertyChanged(handle(slot), index, decoded);
+}
+
+void QRemoteObjectNodePrivate::handleSignal(int slot, int index, QVariantList &args)
+{
+    HandleEntry &entry = handles[slot];
+    if (!entry.initialized || !entry.observer)
+        return;
+    if (entry.meta) {
+        const QMetaMethod signal = entry.meta->method(index + entry.meta->methodOffset());
+        for (int i = 0; i < args.size() && i < signal.parameterCount(); ++i) {
+            if (signal.parameterType(i) != QMetaType::QVariant)
+                decodeVariant(args[i], signal.parameterMetaType(i));
+        }
+    }
+    entry.observer->signalEmitted(handle(slot), index, args);
+}
+
+// The sequence number trailing a packet of a sequenced connection, 0 otherwise
+static quint32 readSequence(IoDeviceBase *connection)
+{
+    quint32 sequence = 0;
+    if (connection->isSequenced())
+        connection->stream() >> sequence;
+    return sequence;
+}
+
+// The replica to check sequence numbers for, if any
+static QConnectedReplicaImplementation *sequencedReplica(QRemoteObjectReplicaImplementation *rep, quint32 sequence)
+{
+    if (!sequence || !rep || rep->isShortCircuit())
+        return nullptr;
+    return static_cast<QConnectedReplicaImplementation *>(rep);
+}
+
+void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
+{
+    using namespace QRemoteObjectPackets;
+    IoDeviceBase *connection = qobject_cast<IoDeviceBase*>(obj);
+    QRemoteObjectPacketTypeEnum packetType;
+    Q_ASSERT(connection);
+
+    do {
+        if (!connection->read(packetType, rxName))
+            return;
+
+        if (packetType != Handshake && !m_handshakeReceived) {
+            qROPrivWarning() << "Expected Handshake, got " << packetType;
+            setLastError(QRemoteObjectNode::ProtocolMismatch);
+            connection->close();
+            break;
+        }
+
+        switch (packetType) {
+        case QRemoteObjectPacketTypeEnum::Pong:
+        {
+            QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            if (rep)
+                rep->notifyAboutReply(0, {});
+            else //replica has been deleted, remove from list
+                replicas.remove(rxName);
+            break;
+        }
+        case QRemoteObjectPacketTypeEnum::Resume:
+        {
+            QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            if (rep && !rep->isShortCircuit())
+                static_cast<QConnectedReplicaImplementation *>(rep.data())->resumed();
+            else if (!rep) //replica has been deleted, remove from list
+                replicas.remove(rxName);
+            break;
+        }
+        case QRemoteObjectPacketTypeEnum::Handshake:
+        {
+            quint32 maxFrameSize;
+            if (deserializeFrameSizeName(rxName, maxFrameSize)) {
+                // The host replied to ours, it reassembles fragments
+                connection->setPeerMaxFrameSize(maxFrameSize);
+            } else if (rxName == QtRemoteObjects::sequenceHandshake) {
+                qROPrivDebug() << "Receiving sequence numbers";
+                connection->setSequenced(true);
+            } else if (rxName == QtRemoteObjects::batchHandshake) {
+                qROPrivDebug() << "Host runs batches of calls";
+                connection->setAcceptsBatches(true);
+            } else if (rxName != QtRemoteObjects::protocolVersion) {
+                qWarning() << "*** Protocol Mismatch, closing connection ***. Got" << rxName << "expected" << QtRemoteObjects::protocolVersion;
                 setLastError(QRemoteObjectNode::ProtocolMismatch);
                 connection->close();
             } else {
                 m_handshakeReceived = true;
+                DataStreamPacket packet;
+                serializeFrameSizePacket(packet, connection->maxFrameSize());
+                connection->write(packet.array, packet.size);
+                serializeInvokeErrorHandshakePacket(packet);
+                connection->write(packet.array, packet.size);
+                serializeBatchHandshakePacket(packet);
+                connection->write(packet.array, packet.size);
+                if (m_sequenceNumbers) {
+                    serializeSequenceHandshakePacket(packet);
+                    connection->write(packet.array, packet.size);
+                } else {
+                    if (connection->isLocal()) {
+                        serializeSharedStateHandshakePacket(packet);
+                        connection->write(packet.array, packet.size);
+                        connection->setReadsSharedState(true);
+                    }
+#if QT_CONFIG(udpsocket)
+                    serializeMulticastHandshakePacket(packet);
+                    connection->write(packet.array, packet.size);
+#endif
+                }
             }
             break;
+        }
         case QRemoteObjectPacketTypeEnum::ObjectList:
         {
             deserializeObjectListPacket(connection->stream(), rxObjects);
@@ -1466,6 +2283,8 @@ void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
             for (const auto &remoteObject : qAsConst(rxObjects)) {
                 if (replicas.contains(remoteObject.name)) //We have a replica waiting on this remoteObject
                     handleReplicaConnection(remoteObject.name);
+                else if (const int slot = handleSlots.value(remoteObject.name, -1); slot >= 0)
+                    connectHandle(slot);
             }
             break;
         }
@@ -1475,8 +2294,17 @@ void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
             QSharedPointer<QConnectedReplicaImplementation> rep = qSharedPointerCast<QConnectedReplicaImplementation>(replicas.value(rxName).toStrongRef());
             //Use m_rxArgs (a QVariantList to hold the properties QVariantList)
             deserializeInitPacket(connection->stream(), rxArgs);
+            const quint32 sequence = readSequence(connection);
+            // The shared state read after an init is decoded in full
+            sharedStateVersions.remove(rxName);
+            if (const int slot = handleSlots.value(rxName, -1); slot >= 0 && !rep) {
+                initHandle(connection, slot, handles.at(slot).meta, rxArgs);
+                break;
+            }
             if (rep)
             {
+                if (connection->isSequenced())
+                    rep->resetSequence(sequence);
                 handlePointerToQObjectProperties(rep.data(), rxArgs);
                 rep->initialize(rxArgs);
             } else { //replica has been deleted, remove from list
@@ -1489,9 +2317,20 @@ void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
             qROPrivDebug() << "InitDynamicPacket-->" << rxName << this;
             const QMetaObject *meta = dynamicTypeManager.addDynamicType(connection, connection->stream());
             deserializeInitPacket(connection->stream(), rxArgs);
+            const quint32 sequence = readSequence(connection);
+            sharedStateVersions.remove(rxName);
             QSharedPointer<QConnectedReplicaImplementation> rep = qSharedPointerCast<QConnectedReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            if (const int slot = handleSlots.value(rxName, -1); slot >= 0 && !rep) {
+                const QByteArray signature = connectedSources.value(rxName).objectSignature;
+                if (!signature.isEmpty())
+                    handleTypes.insert(signature, meta);
+                initHandle(connection, slot, meta, rxArgs);
+                break;
+            }
             if (rep)
             {
+                if (connection->isSequenced())
+                    rep->resetSequence(sequence);
                 rep->setDynamicMetaObject(meta);
                 handlePointerToQObjectProperties(rep.data(), rxArgs);
                 rep->setDynamicProperties(rxArgs);
@@ -1505,6 +2344,9 @@ void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
             qROPrivDebug() << "RemoveObject-->" << rxName << this;
             connectedSources.remove(rxName);
             connection->removeSource(rxName);
+            sharedStates.remove(rxName);
+            sharedStateVersions.remove(rxName);
+            handleLost(rxName);
             if (replicas.contains(rxName)) { //We have a replica using the removed source
                 QSharedPointer<QConnectedReplicaImplementation> rep = qSharedPointerCast<QConnectedReplicaImplementation>(replicas.value(rxName).toStrongRef());
                 if (rep && !rep->connectionToSource.isNull()) {
@@ -1520,28 +2362,16 @@ void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
         {
             int propertyIndex;
             deserializePropertyChangePacket(connection->stream(), propertyIndex, rxValue);
+            const quint32 sequence = readSequence(connection);
             QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            if (const int slot = handleSlots.value(rxName, -1); slot >= 0 && !rep) {
+                handlePropertyChange(connection, slot, propertyIndex, rxValue);
+                break;
+            }
+            if (auto sequenced = sequencedReplica(rep.data(), sequence); sequenced && !sequenced->checkSequence(sequence))
+                break;
             if (rep) {
-                QConnectedReplicaImplementation *connectedRep = nullptr;
-                if (!rep->isShortCircuit()) {
-                    connectedRep = static_cast<QConnectedReplicaImplementation *>(rep.data());
-                    if (!connectedRep->childIndices().contains(propertyIndex))
-                        connectedRep = nullptr; //connectedRep will be a valid pointer only if propertyIndex is a child index
-                }
-                if (connectedRep)
-                    rep->setProperty(propertyIndex, handlePointerToQObjectProperty(connectedRep, propertyIndex, rxValue));
-                else {
-                    const QMetaProperty property = rep->m_metaObject->property(propertyIndex + rep->m_metaObject->propertyOffset());
-                    if (property.userType() == QMetaType::QVariant && rxValue.canConvert<QRO_>()) {
-                        // This is a type that requires registration
-                        QRO_ typeInfo = rxValue.value<QRO_>();
-                        QDataStream in(typeInfo.classDefinition);
-                        parseGadgets(connection, in);
-                        QDataStream ds(typeInfo.parameters);
-                        ds >> rxValue;
-                    }
-                    rep->setProperty(propertyIndex, decodeVariant(rxValue, property.metaType()));
-                }
+                applyPropertyChange(connection, rep.data(), propertyIndex, rxValue);
             } else { //replica has been deleted, remove from list
                 replicas.remove(rxName);
             }
@@ -1551,32 +2381,23 @@ void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
         {
             int call, index, serialId, propertyIndex;
             deserializeInvokePacket(connection->stream(), call, index, rxArgs, serialId, propertyIndex);
+            const quint32 sequence = readSequence(connection);
             QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            if (const int slot = handleSlots.value(rxName, -1); slot >= 0 && !rep) {
+                // Handles report property changes when the value arrives, not with the notify signal
+                if (propertyIndex == -1)
+                    handleSignal(slot, index, rxArgs);
+                break;
+            }
+            if (auto sequenced = sequencedReplica(rep.data(), sequence); sequenced && !sequenced->checkSequence(sequence))
+                break;
+            if (rep && propertyIndex != -1 && !rep->isShortCircuit()
+                && static_cast<QConnectedReplicaImplementation *>(rep.data())->takeUnchangedProperty(propertyIndex)) {
+                qROPrivDebug() << "Dropping notify of unchanged property" << propertyIndex << "of" << rxName;
+                break;
+            }
             if (rep) {
-                static QVariant null(QMetaType::fromType<QObject *>(), nullptr);
-                QVariant paramValue;
-                // Qt usually supports 9 arguments, so ten should be usually safe
-                QVarLengthArray<void*, 10> param(rxArgs.size() + 1);
-                param[0] = null.data(); //Never a return value
-                if (rxArgs.size()) {
-                    auto signal = rep->m_metaObject->method(index+rep->m_signalOffset);
-                    for (int i = 0; i < rxArgs.size(); i++) {
-                        if (signal.parameterType(i) == QMetaType::QVariant)
-                            param[i + 1] = const_cast<void*>(reinterpret_cast<const void*>(&rxArgs.at(i)));
-                        else {
-                            decodeVariant(rxArgs[i], signal.parameterMetaType(i));
-                            param[i + 1] = const_cast<void *>(rxArgs.at(i).data());
-                        }
-                    }
-                } else if (propertyIndex != -1) {
-                    param.resize(2);
-                    paramValue = rep->getProperty(propertyIndex);
-                    param[1] = paramValue.data();
-                }
-                qROPrivDebug() << "Replica Invoke-->" << rxName << rep->m_metaObject->method(index+rep->m_signalOffset).name() << index << rep->m_signalOffset;
-                // We activate on rep->metaobject() so the private metacall is used, not m_metaobject (which
-                // is the class thie replica looks like)
-                QMetaObject::activate(rep.data(), rep->metaObject(), index+rep->m_signalOffset, param.data());
+                emitReplicaSignal(rep.data(), index, rxArgs, propertyIndex);
             } else { //replica has been deleted, remove from list
                 replicas.remove(rxName);
             }
@@ -1586,7 +2407,10 @@ void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
         {
             int ackedSerialId;
             deserializeInvokeReplyPacket(connection->stream(), ackedSerialId, rxValue);
+            const quint32 sequence = readSequence(connection);
             QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            if (auto sequenced = sequencedReplica(rep.data(), sequence))
+                sequenced->checkReplySequence(sequence);
             if (rep) {
                 qROPrivDebug() << "Received InvokeReplyPacket ack'ing serial id:" << ackedSerialId;
                 rep->notifyAboutReply(ackedSerialId, rxValue);
@@ -1595,6 +2419,110 @@ void QRemoteObjectNodePrivate::onClientRead(QObject *obj)
             }
             break;
         }
+        case QRemoteObjectPacketTypeEnum::BatchReplyPacket:
+        {
+            int ackedSerialId;
+            QList<BatchResult> results;
+            deserializeBatchReplyPacket(connection->stream(), ackedSerialId, results);
+            const quint32 sequence = readSequence(connection);
+            QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            if (auto sequenced = sequencedReplica(rep.data(), sequence))
+                sequenced->checkReplySequence(sequence);
+            if (rep) {
+                qROPrivDebug() << "Received BatchReplyPacket ack'ing serial id:" << ackedSerialId << "with" << results.size() << "results";
+                rep->notifyAboutBatchReply(ackedSerialId, results);
+            } else { //replica has been deleted, remove from list
+                replicas.remove(rxName);
+            }
+            break;
+        }
+        case QRemoteObjectPacketTypeEnum::InvokeErrorPacket:
+        {
+            int ackedSerialId;
+            QString reason;
+            deserializeInvokeErrorPacket(connection->stream(), ackedSerialId, reason);
+            const quint32 sequence = readSequence(connection);
+            QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            if (auto sequenced = sequencedReplica(rep.data(), sequence))
+                sequenced->checkReplySequence(sequence);
+            if (rep) {
+                qROPrivDebug() << "Host rejected call with serial id:" << ackedSerialId << reason;
+                rep->notifyAboutError(ackedSerialId);
+            } else { //replica has been deleted, remove from list
+                replicas.remove(rxName);
+            }
+            break;
+        }
+        case QRemoteObjectPacketTypeEnum::SharedStatePacket:
+        {
+            QString key;
+            QByteArray state;
+            deserializeSharedStatePacket(connection->stream(), key, state);
+            QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            const int slot = handleSlots.value(rxName, -1);
+            if (!rep && slot < 0) { //replica has been deleted, remove from list
+                replicas.remove(rxName);
+                sharedStates.remove(rxName);
+                sharedStateVersions.remove(rxName);
+                break;
+            }
+            if (!key.isEmpty() && !readSharedState(rxName, key, state)) {
+                // The host sends the values with the packets once it knows,
+                // the replica keeps its values until they arrive
+                if (connection->readsSharedState()) {
+                    DataStreamPacket packet;
+                    serializeSharedStateUnavailableHandshakePacket(packet);
+                    connection->write(packet.array, packet.size);
+                    connection->setReadsSharedState(false);
+                }
+                break;
+            }
+            QDataStream ds(state);
+            ds.setVersion(QtRemoteObjects::dataStreamVersion);
+            quint32 count = 0;
+            ds >> count;
+            QHash<qint32, quint32> &versions = sharedStateVersions[rxName];
+            if (rep)
+                rep->holdPropertySnapshotChanged();
+            for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; ++i) {
+                qint32 propertyIndex;
+                quint32 version;
+                quint32 size;
+                ds >> propertyIndex >> version >> size;
+                if (ds.status() != QDataStream::Ok)
+                    break;
+                // Only the values changed since the last read are decoded
+                if (versions.value(propertyIndex) == version) {
+                    ds.skipRawData(int(size));
+                    continue;
+                }
+                versions.insert(propertyIndex, version);
+                ds >> rxValue;
+                if (!rep)
+                    handlePropertyChange(connection, slot, propertyIndex, rxValue);
+                else if (!rep->isShortCircuit())
+                    setSharedProperty(connection, static_cast<QConnectedReplicaImplementation *>(rep.data()), propertyIndex, rxValue);
+            }
+            if (rep)
+                rep->releasePropertySnapshotChanged();
+            break;
+        }
+        case QRemoteObjectPacketTypeEnum::MulticastPacket:
+        {
+            QUrl groupUrl;
+            quint64 sourceId = 0;
+            deserializeMulticastPacket(connection->stream(), groupUrl, sourceId);
+            QSharedPointer<QRemoteObjectReplicaImplementation> rep = qSharedPointerCast<QRemoteObjectReplicaImplementation>(replicas.value(rxName).toStrongRef());
+            // Handles keep getting property changes over the connection, as
+            // does a replica if the group can't be joined
+            if (!rep || rep->isShortCircuit() || !joinMulticastGroup(groupUrl))
+                break;
+            static_cast<QConnectedReplicaImplementation *>(rep.data())->setMulticastGroup(groupUrl, sourceId);
+            DataStreamPacket packet;
+            serializeMulticastPacket(packet, rxName, groupUrl, sourceId);
+            connection->write(packet.array, packet.size);
+            break;
+        }
         case QRemoteObjectPacketTypeEnum::AddObject:
         case QRemoteObjectPacketTypeEnum::Invalid:
         case QRemoteObjectPacketTypeEnum::Ping:
@@ -2260,6 +3188,15 @@ bool QRemoteObjectNode::waitForRegistry(int timeout)
     Once a client is connected to a host, valid Replicas can then be acquired
     if the corresponding Source is being remoted.
 
+    Nodes of the process connecting to the same \a address can share a single
+    connection to the host, see setSharedConnectionsEnabled().
+
+    Hosts can number the packets of each Source, see
+    setSequenceNumbersEnabled().
+
+    Large packets are sent in fragments, see setMaxFrameSize() and
+    setMaxMessageSize().
+
     Return \c true on success, \c false otherwise (usually an unrecognized url,
     or connecting to already connected address).
 */
@@ -2294,6 +3231,8 @@ void QRemoteObjectNode::addClientSideConnection(QIODevice *ioDevice)
         return;
     }
     ExternalIoDevice *device = new ExternalIoDevice(ioDevice, this);
+    device->setMaxFrameSize(d->m_maxFrameSize);
+    device->setMaxMessageSize(d->m_maxMessageSize);
     connect(device, &IoDeviceBase::readyRead, this, [d, device]() {
         d->onClientRead(device);
     });
@@ -2368,6 +3307,39 @@ QStringList QRemoteObjectNode::instances(QStringView typeName) const
     return names;
 }
 
+/*!
+    \since 6.2
+
+    Returns a handle to watch the Source \a name, with changes reported to
+    \a observer. Handles are much smaller than replicas and meant for
+    watching very many Sources, see QRemoteObjectReplicaHandle.
+
+    Returns an invalid handle if \a name is empty, or if this node already
+    has a replica or a handle for \a name.
+
+    \sa acquireDynamic()
+*/
+QRemoteObjectReplicaHandle QRemoteObjectNode::acquireHandle(const QString &name, QRemoteObjectReplicaObserver *observer)
+{
+    Q_D(QRemoteObjectNode);
+    if (name.isEmpty() || d->handleSlots.contains(name) || d->hasInstance(name))
+        return QRemoteObjectReplicaHandle();
+
+    int slot;
+    if (!d->freeHandles.isEmpty()) {
+        slot = d->freeHandles.takeLast();
+    } else {
+        slot = int(d->handles.size());
+        d->handles.append(QRemoteObjectNodePrivate::HandleEntry());
+    }
+    QRemoteObjectNodePrivate::HandleEntry &entry = d->handles[slot];
+    entry.name = name;
+    entry.observer = observer;
+    d->handleSlots.insert(name, slot);
+    d->connectHandle(slot);
+    return d->handle(slot);
+}
+
 /*!
     \keyword dynamic acquire
     Returns a QRemoteObjectDynamicReplica of the Source \a name.
@@ -2458,6 +3430,16 @@ bool QRemoteObjectHostBase::enableRemoting(QObject *object, const QString &name)
  */
 bool QRemoteObjectHostBase::enableRemoting(QAbstractItemModel *model, const QString &name, const QList<int> roles, QItemSelectionModel *selectionModel)
 {
+    // A replica (i.e. when proxying) answers from its cache or forwards requests to its source,
+    // instead of replying with whatever data() returns before the data arrives
+    if (auto replica = qobject_cast<QAbstractItemModelReplica *>(model)) {
+        QObject *adapter = new QAbstractItemModelReplicaSourceAdapter(replica, selectionModel, roles);
+        auto api = new QAbstractItemAdapterSourceAPI<QAbstractItemModel, QAbstractItemModelReplicaSourceAdapter>(name);
+        if (!this->objectName().isEmpty())
+            adapter->setObjectName(this->objectName().append(QLatin1String("Adapter")));
+        return enableRemoting(model, api, adapter);
+    }
+
     //This looks complicated, but hopefully there is a way to have an adapter be a template
     //parameter and this makes sure that is supported.
     QObject *adapter = QAbstractItemModelSourceAdapter::staticMetaObject.newInstance(Q_ARG(QAbstractItemModel*, model),
@@ -2554,6 +3536,316 @@ bool QRemoteObjectHostBase::disableRemoting(QObject *remoteObject)
     return true;
 }
 
+/*!
+    \since 6.2
+
+    Returns an approximation of the memory this host node holds for remoting,
+    to find which Source or which slow client is responsible for it.
+
+    The returned map contains:
+    \list
+    \li \c totalBytes: the sum of the bytes counted below.
+    \li \c queuedInits: the number of acquired Sources whose initial state
+        waits to be sent, see setMaxConcurrentInits().
+    \li \c initsInFlight: the number of initial states sent but not yet
+        written out to the client.
+    \li \c connections: a list with one map per connected client, holding
+        the bytes still queued for sending (\c queuedBytes), the bytes received
+        but not yet processed (\c receivedBytes), the number of replies waiting
+        for a forwarded call (\c pendingReplies), the names of the Sources the
+        client acquired (\c sources) and, for sockets, the \c peer address.
+    \li \c sources: a map from the name of every remoted object to a map
+        holding the bytes of its packet buffer (\c packetBytes), of the types
+        already sent to dynamic replicas (\c sentTypesBytes) and of marshalled
+        signal arguments (\c marshalledArgsBytes), their sum (\c bytes), the
+        number of \c listeners, of listeners getting property changes by
+        multicast (\c multicastListeners), of child Sources (\c children), of
+        model adapters (\c modelAdapters) and of model requests forwarded
+        upstream by a proxied model (\c modelPendingReplies).
+    \endlist
+
+    The map is empty if this node doesn't host any Source. The same
+    information can be logged periodically, see setMemoryReportInterval().
+*/
+QVariantMap QRemoteObjectHostBase::memoryUsage() const
+{
+    Q_D(const QRemoteObjectHostBase);
+    if (!d->remoteObjectIo)
+        return QVariantMap();
+    return d->remoteObjectIo->memoryUsage();
+}
+
+/*!
+    \since 6.2
+
+    Logs what memoryUsage() returns to the \c qt.remoteobjects category every
+    \a msecs milliseconds. A value of 0, the default, stops logging.
+
+    Returns \c false if this node doesn't host any Source.
+
+    \sa memoryUsage()
+*/
+bool QRemoteObjectHostBase::setMemoryReportInterval(int msecs)
+{
+    Q_D(QRemoteObjectHostBase);
+    if (!d->remoteObjectIo) {
+        d->setLastError(OperationNotValidOnClientNode);
+        return false;
+    }
+    d->remoteObjectIo->setMemoryReportInterval(msecs);
+    return true;
+}
+
+/*!
+    \since 6.2
+
+    Limits every connected client to \a callsPerSecond slot calls and property
+    writes per second, or, if \a name is given, to \a callsPerSecond calls of
+    the Source remoted as \a name. Clients may use up a whole second's worth of
+    calls in a burst. A value of 0 removes the limit, which is the default.
+
+    Calls over a limit wait in a per-client queue, see setMaxQueuedInvokes(),
+    and are run in the order they arrived as the limits allow. Calls arriving
+    when the queue is full are rejected: the client's
+    QRemoteObjectPendingCall finishes with the
+    QRemoteObjectPendingCall::Rejected error. Clients built with an earlier
+    version of Qt Remote Objects get an invalid return value instead.
+
+    A batch of calls (see QRemoteObjectReplica::beginBatch()) is admitted or
+    rejected as a whole. It runs once the limits allow one call, and each of
+    its calls counts against the rate; the calls over it delay the client's
+    next calls. The batch counts as one call against setMaxPendingInvokes().
+
+    Returns \c false if this node doesn't host any Source.
+
+    \sa setMaxPendingInvokes(), invokeStatistics()
+*/
+bool QRemoteObjectHostBase::setMaxInvokeRate(int callsPerSecond, const QString &name)
+{
+    Q_D(QRemoteObjectHostBase);
+    if (!d->remoteObjectIo) {
+        d->setLastError(OperationNotValidOnClientNode);
+        return false;
+    }
+    d->remoteObjectIo->setMaxInvokeRate(callsPerSecond, name);
+    return true;
+}
+
+/*!
+    \since 6.2
+
+    Limits the number of calls per client whose reply is still pending to
+    \a count. Only slots returning a QRemoteObjectPendingCall, such as those
+    of a proxied replica, stay pending after being called. Further calls wait
+    in the client's queue until a reply is sent. A value of 0, the default,
+    removes the limit.
+
+    Returns \c false if this node doesn't host any Source.
+
+    \sa setMaxInvokeRate(), setMaxQueuedInvokes()
+*/
+bool QRemoteObjectHostBase::setMaxPendingInvokes(int count)
+{
+    Q_D(QRemoteObjectHostBase);
+    if (!d->remoteObjectIo) {
+        d->setLastError(OperationNotValidOnClientNode);
+        return false;
+    }
+    d->remoteObjectIo->setMaxPendingInvokes(count);
+    return true;
+}
+
+/*!
+    \since 6.2
+
+    Sets the number of calls per client that wait for the limits set with
+    setMaxInvokeRate() and setMaxPendingInvokes() to \a count. Calls beyond
+    it are rejected. With 0, calls over a limit are rejected right away. The
+    default is 100.
+
+    Returns \c false if this node doesn't host any Source.
+*/
+bool QRemoteObjectHostBase::setMaxQueuedInvokes(int count)
+{
+    Q_D(QRemoteObjectHostBase);
+    if (!d->remoteObjectIo) {
+        d->setLastError(OperationNotValidOnClientNode);
+        return false;
+    }
+    d->remoteObjectIo->setMaxQueuedInvokes(count);
+    return true;
+}
+
+/*!
+    \since 6.2
+
+    Returns how the calls of connected clients went through the limits set
+    with setMaxInvokeRate() and setMaxPendingInvokes().
+
+    The returned map contains the number of calls that were run
+    (\c invoked), queued (\c queued) and rejected (\c rejected) for all
+    clients, and in \c connections one map per client with the same counters,
+    the calls still \c pending and waiting (\c queueLength), the longest time
+    in milliseconds a call waited (\c maxQueueDelay), the calls run per
+    Source name (\c sources) and, for sockets, the \c peer address.
+
+    Calls to the registry are never limited and not counted.
+*/
+QVariantMap QRemoteObjectHostBase::invokeStatistics() const
+{
+    Q_D(const QRemoteObjectHostBase);
+    if (!d->remoteObjectIo)
+        return QVariantMap();
+    return d->remoteObjectIo->invokeStatistics();
+}
+
+/*!
+    \since 6.2
+
+    Sets the number of initial states being sent at the same time to
+    \a count. The initial state of a Source is sent when a client acquires
+    it, and counts as being sent until the client's connection wrote it out.
+    Further clients wait in a queue, so a host that many clients reconnect to
+    at once (i.e. after it restarted) doesn't buffer all initial states in
+    memory. Each connection is sent one initial state at a time, so updates
+    for the Sources a client already has are not held up by several of them.
+    The queue is served in the order the Sources were acquired, except for
+    the registry, which goes first.
+
+    A value of 0 removes the limit. The default is 16.
+
+    Returns \c false if this node doesn't host any Source.
+
+    \sa setMaxInitRate(), memoryUsage()
+*/
+bool QRemoteObjectHostBase::setMaxConcurrentInits(int count)
+{
+    Q_D(QRemoteObjectHostBase);
+    if (!d->remoteObjectIo) {
+        d->setLastError(OperationNotValidOnClientNode);
+        return false;
+    }
+    d->remoteObjectIo->setMaxConcurrentInits(count);
+    return true;
+}
+
+/*!
+    \since 6.2
+
+    Limits the initial states sent to all clients to \a bytesPerSecond bytes
+    per second, so they take a bounded share of the host's bandwidth. Updates
+    of already initialized replicas are not limited. A value of 0, the
+    default, removes the limit.
+
+    Returns \c false if this node doesn't host any Source.
+
+    \sa setMaxConcurrentInits()
+*/
+bool QRemoteObjectHostBase::setMaxInitRate(int bytesPerSecond)
+{
+    Q_D(QRemoteObjectHostBase);
+    if (!d->remoteObjectIo) {
+        d->setLastError(OperationNotValidOnClientNode);
+        return false;
+    }
+    d->remoteObjectIo->setMaxInitRate(bytesPerSecond);
+    return true;
+}
+
+/*!
+    \since 6.2
+
+    If \a enabled is \c true, the property values of the Sources on this
+    host are shared with clients connecting through a local socket (the
+    \c local: schema) in shared memory, instead of being sent to each of
+    them. When properties of a Source change, the host serializes the changed
+    values, writes them with the others to a page of shared memory once, and
+    sends each of these clients a short notification. Each value on the page
+    carries a version. The clients copy the page, decode only the values of a
+    new version and emit the notify signals of the properties that changed. This
+    makes updates cheaper for the host when many processes on the same
+    machine replicate the same Source. Changes made in one pass of the event
+    loop reach the clients together, after the signals of the Source emitted
+    before them and before the reply of a call that made them.
+
+    Only the properties of the Source itself are shared, properties that
+    hold child objects and the properties of those are sent as before, as are
+    properties whose notify signal has arguments other than the new value.
+    Clients using sequence numbers (see
+    QRemoteObjectNode::setSequenceNumbersEnabled()) don't read shared memory. If the host can't create the shared
+    memory, the changed values are sent to these clients with the notification. A
+    client that can't attach to it gets the values with the notifications
+    from then on.
+
+    The setting applies to clients that connect afterwards. It is disabled by
+    default.
+
+    Returns \c false if this node doesn't host any Source.
+
+    \sa QSharedMemory
+*/
+bool QRemoteObjectHostBase::setSharedStateEnabled(bool enabled)
+{
+    Q_D(QRemoteObjectHostBase);
+    if (!d->remoteObjectIo) {
+        d->setLastError(OperationNotValidOnClientNode);
+        return false;
+    }
+    d->remoteObjectIo->setSharedStateEnabled(enabled);
+    return true;
+}
+
+/*!
+    \since 6.2
+
+    Sends the property changes of the Source \a name as UDP datagrams to the
+    multicast group \a groupUrl, such as \c{udp://239.255.0.1:65500},
+    instead of writing them to every client. This makes updates cheaper for
+    the host when many clients on the same network replicate the Source.
+
+    Clients are told about the group when they acquire the Source. Once a
+    client joined the group, it gets the property changes of the Source from
+    there. Everything else, i.e. the initial state, signals, calls and their
+    replies, and the Source's child objects, still goes over its connection.
+    Property changes can therefore arrive out of order with signals and
+    replies. Each datagram carries a sequence number: a replica that misses
+    datagrams keeps the newest values and acquires the Source again to get the
+    ones it missed. For a short while after a change the host repeats the last
+    sequence number, so the loss of the last datagrams is noticed as well.
+    Datagrams also carry an id of the Source, so Sources of the same name on
+    other hosts can share the group. Clients that can't join the group, that use sequence
+    numbers (see QRemoteObjectNode::setSequenceNumbersEnabled()) or that read
+    shared memory (see setSharedStateEnabled()) get the property changes over
+    their connection, as do all clients for changes that don't fit an
+    Ethernet frame.
+
+    The group must be reachable from the clients; datagrams are sent with
+    the system's default interface and time to live. An empty \a groupUrl
+    disables multicasting. The setting can be made before \a name is
+    remoted, and applies to clients acquiring the Source afterwards.
+
+    Returns \c false if this node doesn't host any Source, or if
+    \a groupUrl is not empty and not a \c udp URL with a multicast address
+    and a port.
+
+    \sa memoryUsage()
+*/
+bool QRemoteObjectHostBase::setMulticastUrl(const QString &name, const QUrl &groupUrl)
+{
+    Q_D(QRemoteObjectHostBase);
+    if (!d->remoteObjectIo) {
+        d->setLastError(OperationNotValidOnClientNode);
+        return false;
+    }
+    if (!groupUrl.isEmpty() && (groupUrl.scheme() != QLatin1String("udp") || groupUrl.port() <= 0
+                                || !QHostAddress(groupUrl.host()).isMulticast())) {
+        d->setLastError(HostUrlInvalid);
+        return false;
+    }
+    d->remoteObjectIo->setMulticastUrl(name, groupUrl);
+    return true;
+}
+
 /*!
     \since 5.12
 
@@ -2593,12 +3885,15 @@ void QRemoteObjectHostBase::addHostSideConnection(QIODevice *ioDevice)
     roles in the \a rolesHint will be prefetched. If \a rolesHint is empty, then
     the data for all the roles exposed by \l Source will be prefetched.
 
-    The returned model will be empty until it is initialized with the \l Source.
+    The returned model will be empty until it is initialized with the \l Source,
+    unless the node has a modelCacheDirectory() holding data of the model.
 */
 QAbstractItemModelReplica *QRemoteObjectNode::acquireModel(const QString &name, QtRemoteObjects::InitialAction action, const QList<int> &rolesHint)
 {
     QAbstractItemModelReplicaImplementation *rep = acquire<QAbstractItemModelReplicaImplementation>(name);
-    return new QAbstractItemModelReplica(rep, action, rolesHint);
+    QAbstractItemModelReplica *model = new QAbstractItemModelReplica(rep, action, rolesHint);
+    rep->loadPersistedCache(name);
+    return model;
 }
 
 QRemoteObjectHostBasePrivate::QRemoteObjectHostBasePrivate()
@@ -2716,7 +4011,7 @@ void ProxyInfo::proxyObject(const QRemoteObjectSourceLocation &entry, ProxyDirec
             QAbstractItemModelReplica *rep = proxyNode->acquireModel(name);
             proxiedReplicas.insert(name, new ProxyReplicaInfo{rep, direction});
             connect(rep, &QAbstractItemModelReplica::initialized, this,
-                    [rep, name, this]() { this->parentNode->enableRemoting(rep, name, QList<int>()); });
+                    [rep, name, this]() { this->parentNode->enableRemoting(rep, name, rep->availableRoles()); });
         } else {
             QRemoteObjectDynamicReplica *rep = proxyNode->acquireDynamic(name);
             proxiedReplicas.insert(name, new ProxyReplicaInfo{rep, direction});
@@ -2744,7 +4039,7 @@ void ProxyInfo::proxyObject(const QRemoteObjectSourceLocation &entry, ProxyDirec
             {
                 QRemoteObjectHostBase *host = qobject_cast<QRemoteObjectHostBase *>(this->proxyNode);
                 Q_ASSERT(host);
-                host->enableRemoting(rep, name, QList<int>());
+                host->enableRemoting(rep, name, rep->availableRoles());
             });
         } else {
             QRemoteObjectDynamicReplica *rep = this->parentNode->acquireDynamic(name);
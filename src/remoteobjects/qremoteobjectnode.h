@@ -45,6 +45,7 @@
 #include <QtRemoteObjects/qtremoteobjectglobal.h>
 #include <QtRemoteObjects/qremoteobjectregistry.h>
 #include <QtRemoteObjects/qremoteobjectdynamicreplica.h>
+#include <QtRemoteObjects/qremoteobjectreplicahandle.h>
 
 #include <functional>
 
@@ -128,6 +129,7 @@ public:
     QStringList instances(QStringView typeName) const;
 
     QRemoteObjectDynamicReplica *acquireDynamic(const QString &name);
+    QRemoteObjectReplicaHandle acquireHandle(const QString &name, QRemoteObjectReplicaObserver *observer);
     QAbstractItemModelReplica *acquireModel(const QString &name, QtRemoteObjects::InitialAction action = QtRemoteObjects::FetchRootSize, const QList<int> &rolesHint = {});
     QUrl registryUrl() const;
     virtual bool setRegistryUrl(const QUrl &registryAddress);
@@ -142,6 +144,21 @@ public:
     int heartbeatInterval() const;
     void setHeartbeatInterval(int interval);
 
+    bool sharedConnectionsEnabled() const;
+    void setSharedConnectionsEnabled(bool enabled);
+    bool sequenceNumbersEnabled() const;
+    void setSequenceNumbersEnabled(bool enabled);
+    int maxFrameSize() const;
+    void setMaxFrameSize(int bytes);
+    int maxMessageSize() const;
+    void setMaxMessageSize(int bytes);
+    QString modelCacheDirectory() const;
+    void setModelCacheDirectory(const QString &path);
+    int modelCacheRows() const;
+    void setModelCacheRows(int rows);
+    int replyCacheSize() const;
+    void setReplyCacheSize(int size);
+
     typedef std::function<void (QUrl)> RemoteObjectSchemaHandler;
     void registerExternalSchema(const QString &schema, RemoteObjectSchemaHandler handler);
 
@@ -193,6 +210,19 @@ public:
     // reverse aspect requires the registry.
     bool reverseProxy(RemoteObjectNameFilter filter=[](QStringView, QStringView) {return true; });
 
+    QVariantMap memoryUsage() const;
+    bool setMemoryReportInterval(int msecs);
+
+    bool setMaxInvokeRate(int callsPerSecond, const QString &name = QString());
+    bool setMaxPendingInvokes(int count);
+    bool setMaxQueuedInvokes(int count);
+    QVariantMap invokeStatistics() const;
+
+    bool setMaxConcurrentInits(int count);
+    bool setMaxInitRate(int bytesPerSecond);
+    bool setSharedStateEnabled(bool enabled);
+    bool setMulticastUrl(const QString &name, const QUrl &groupUrl);
+
 protected:
     virtual QUrl hostUrl() const;
     virtual bool setHostUrl(const QUrl &hostAddress, AllowedSchemas allowedSchemas=BuiltInSchemasOnly);
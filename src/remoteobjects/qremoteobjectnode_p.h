@@ -58,6 +58,9 @@
 
 #include <QtCore/qbasictimer.h>
 #include <QtCore/qmutex.h>
+#if QT_CONFIG(udpsocket)
+#include <QtNetwork/qudpsocket.h>
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -73,6 +76,7 @@ QT_BEGIN_NAMESPACE
 class QRemoteObjectRegistry;
 class QRegistrySource;
 class QConnectedReplicaImplementation;
+class QSharedMemory;
 
 class QRemoteObjectAbstractPersistedStorePrivate : public QObjectPrivate
 {
@@ -162,6 +166,49 @@ public:
     void handleReplicaConnection(const QString &name);
     void handleReplicaConnection(const QByteArray &sourceSignature, QConnectedReplicaImplementation *rep, IoDeviceBase *connection);
     void initialize();
+
+    // Table of the replica handles, see QRemoteObjectNode::acquireHandle()
+    struct HandleEntry
+    {
+        QString name;
+        QRemoteObjectReplicaObserver *observer = nullptr;
+        // Shared with every dynamic replica and handle of the type
+        const QMetaObject *meta = nullptr;
+        IoDeviceBase *connection = nullptr;
+        QVariantList values;
+        quint32 generation = 0;
+        bool initialized = false;
+    };
+    HandleEntry *handleEntry(int slot, quint32 generation);
+    QRemoteObjectReplicaHandle handle(int slot);
+    void connectHandle(int slot);
+    void releaseHandle(int slot);
+    void handleLost(const QString &name);
+    void initHandle(IoDeviceBase *connection, int slot, const QMetaObject *meta, const QVariantList &values);
+    void handlePropertyChange(IoDeviceBase *connection, int slot, int index, const QVariant &value);
+    void handleSignal(int slot, int index, QVariantList &args);
+    QVariant decodeHandleValue(IoDeviceBase *connection, const QMetaObject *meta, int index, QVariant value);
+
+    // Copies the values from the shared state page with key into state
+    bool readSharedState(const QString &name, const QString &key, QByteArray &state);
+    void setSharedProperty(IoDeviceBase *connection, QConnectedReplicaImplementation *rep, int index, QVariant &value);
+
+    // Multicast groups replicas get property changes from, see
+    // QRemoteObjectHostBase::setMulticastUrl()
+#if QT_CONFIG(udpsocket)
+    struct MulticastGroup
+    {
+        QUdpSocket socket;
+    };
+    void onMulticastRead(MulticastGroup *group, const QUrl &groupUrl);
+    // Applies the property changes and notify signals of name in packets,
+    // other packets are dropped
+    void readMulticastPackets(QConnectedReplicaImplementation *rep, const QString &name, const QByteArray &packets);
+#endif
+    void applyPropertyChange(IoDeviceBase *connection, QRemoteObjectReplicaImplementation *rep, int propertyIndex, QVariant &value);
+    void emitReplicaSignal(QRemoteObjectReplicaImplementation *rep, int index, QVariantList &args, int propertyIndex);
+    bool joinMulticastGroup(const QUrl &groupUrl);
+
 private:
     bool checkSignatures(const QByteArray &a, const QByteArray &b);
 
@@ -191,7 +238,29 @@ public:
     QRemoteObjectAbstractPersistedStore *persistedStore;
     bool m_handshakeReceived = false;
     int m_heartbeatInterval = 0;
+    bool m_sharedConnections = false;
+    bool m_sequenceNumbers = false;
+    quint32 m_maxFrameSize = QtRemoteObjects::defaultMaxFrameSize;
+    quint32 m_maxMessageSize = QtRemoteObjects::defaultMaxMessageSize;
+    QString m_modelCacheDirectory;
+    int m_modelCacheRows = 100;
+    int m_replyCacheSize = 128;
     QRemoteObjectMetaObjectManager dynamicTypeManager;
+    QList<HandleEntry> handles;
+    QList<int> freeHandles;
+    QHash<QString, int> handleSlots;
+    // Types handles were initialized with, by object signature. Further
+    // handles of a known type skip the type definition. Sources without a
+    // signature always send it.
+    QHash<QByteArray, const QMetaObject *> handleTypes;
+    // Shared state pages of the sources replicated from local hosts, by name
+    QHash<QString, QSharedPointer<QSharedMemory>> sharedStates;
+    // Versions of the values read from the shared state of each source, by
+    // internal index. Values of a known version are skipped.
+    QHash<QString, QHash<qint32, quint32>> sharedStateVersions;
+#if QT_CONFIG(udpsocket)
+    QHash<QUrl, QSharedPointer<MulticastGroup>> multicastGroups;
+#endif
     Q_DECLARE_PUBLIC(QRemoteObjectNode)
 };
 
@@ -40,10 +40,13 @@
 #include "qremoteobjectpacket_p.h"
 
 #include <QtCore/qabstractitemmodel.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qthread.h>
 
 #include "qremoteobjectpendingcall.h"
 #include "qremoteobjectsource.h"
 #include "qremoteobjectsource_p.h"
+#include <atomic>
 #include <cstring>
 
 //#define QTRO_VERBOSE_PROTOCOL
@@ -116,13 +119,62 @@ QVariant &decodeVariant(QVariant &value, QMetaType metaType)
     return value;
 }
 
+QByteArray variantHeader(QMetaType metaType)
+{
+    if (!metaType.isValid() || !metaType.hasRegisteredDataStreamOperators())
+        return QByteArray();
+
+    const QVariant defaultValue(metaType);
+    const QVariant value(metaType, defaultValue.constData());
+    QByteArray variantData;
+    QByteArray valueData;
+    {
+        QDataStream ds(&variantData, QIODevice::WriteOnly);
+        ds.setVersion(dataStreamVersion);
+        ds << value;
+    }
+    {
+        QDataStream ds(&valueData, QIODevice::WriteOnly);
+        ds.setVersion(dataStreamVersion);
+        metaType.save(ds, value.constData());
+    }
+    if (!variantData.endsWith(valueData))
+        return QByteArray();
+    variantData.chop(valueData.size());
+    return variantData;
+}
+
+bool writeVariantHeader(QDataStream &ds, const QByteArray &header)
+{
+    if (header.isEmpty() || ds.version() != dataStreamVersion)
+        return false;
+    ds.writeRawData(header.constData(), int(header.size()));
+    return true;
+}
+
+bool skipVariantHeader(QDataStream &ds, const QByteArray &header)
+{
+    if (header.isEmpty() || ds.version() != dataStreamVersion || !ds.device()
+            || ds.device()->peek(header.size()) != header) {
+        return false;
+    }
+    ds.skipRawData(int(header.size()));
+    return true;
+}
+
 void serializeProperty(QDataStream &ds, const QRemoteObjectSourceBase *source, int internalIndex)
 {
     const int propertyIndex = source->m_api->sourcePropertyIndex(internalIndex);
     Q_ASSERT (propertyIndex >= 0);
     const auto target = source->m_api->isAdapterProperty(internalIndex) ? source->m_adapter : source->m_object;
+    serializeProperty(ds, source, internalIndex, target->metaObject()->property(propertyIndex).read(target));
+}
+
+void serializeProperty(QDataStream &ds, const QRemoteObjectSourceBase *source, int internalIndex, const QVariant &value)
+{
+    const int propertyIndex = source->m_api->sourcePropertyIndex(internalIndex);
+    const auto target = source->m_api->isAdapterProperty(internalIndex) ? source->m_adapter : source->m_object;
     const auto property = target->metaObject()->property(propertyIndex);
-    const QVariant value = property.read(target);
     if (property.metaType().flags().testFlag(QMetaType::PointerToQObject)) {
         auto const childSource = source->m_children.value(internalIndex);
         auto valueAsPointerToQObject = qvariant_cast<QObject *>(value);
@@ -168,6 +220,86 @@ void serializeHandshakePacket(DataStreamPacket &ds)
     ds.finishPacket();
 }
 
+void serializeFrameSizePacket(DataStreamPacket &ds, quint32 maxFrameSize)
+{
+    // Only the name, peers that don't know this packet skip it without
+    // leaving anything in the stream
+    ds.setId(Handshake);
+    ds << QString(frameSizeHandshake) + QString::number(maxFrameSize);
+    ds.finishPacket();
+}
+
+void serializeSequenceHandshakePacket(DataStreamPacket &ds)
+{
+    ds.setId(Handshake);
+    ds << QString(sequenceHandshake);
+    ds.finishPacket();
+}
+
+void serializeInvokeErrorHandshakePacket(DataStreamPacket &ds)
+{
+    ds.setId(Handshake);
+    ds << QString(invokeErrorHandshake);
+    ds.finishPacket();
+}
+
+void serializeSharedStateHandshakePacket(DataStreamPacket &ds)
+{
+    ds.setId(Handshake);
+    ds << QString(sharedStateHandshake);
+    ds.finishPacket();
+}
+
+void serializeSharedStateUnavailableHandshakePacket(DataStreamPacket &ds)
+{
+    ds.setId(Handshake);
+    ds << QString(sharedStateUnavailableHandshake);
+    ds.finishPacket();
+}
+
+void serializeMulticastHandshakePacket(DataStreamPacket &ds)
+{
+    ds.setId(Handshake);
+    ds << QString(multicastHandshake);
+    ds.finishPacket();
+}
+
+void serializeBatchHandshakePacket(DataStreamPacket &ds)
+{
+    ds.setId(Handshake);
+    ds << QString(batchHandshake);
+    ds.finishPacket();
+}
+
+QByteArray sequencedPackets(const QByteArray &data, qint64 size, quint32 &sequence, bool advance)
+{
+    QByteArray result;
+    result.reserve(size + 2 * qsizetype(sizeof(quint32)));
+    char number[sizeof(quint32)];
+    qint64 pos = 0;
+    while (pos + qint64(sizeof(quint32)) <= size) {
+        const quint32 packetSize = qFromBigEndian<quint32>(data.constData() + pos);
+        qToBigEndian(quint32(packetSize + sizeof(quint32)), number);
+        result.append(number, sizeof(number));
+        result.append(data.constData() + pos + sizeof(quint32), packetSize);
+        if (advance)
+            sequence = nextSequence(sequence);
+        qToBigEndian(sequence, number);
+        result.append(number, sizeof(number));
+        pos += qint64(sizeof(quint32)) + packetSize;
+    }
+    return result;
+}
+
+bool deserializeFrameSizeName(const QString &name, quint32 &maxFrameSize)
+{
+    if (!name.startsWith(frameSizeHandshake))
+        return false;
+    bool ok;
+    maxFrameSize = QStringView(name).mid(frameSizeHandshake.size()).toUInt(&ok);
+    return ok && maxFrameSize > 0;
+}
+
 void serializeInitPacket(DataStreamPacket &ds, const QRemoteObjectRootSource *source)
 {
     ds.setId(InitPacket);
@@ -188,6 +320,74 @@ void serializeProperties(DataStreamPacket &ds, const QRemoteObjectSourceBase *so
         serializeProperty(ds, source, internalIndex);
 }
 
+void serializeSharedStateValue(QByteArray &data, const QRemoteObjectSourceBase *source, int internalIndex)
+{
+    data.clear();
+    QDataStream ds(&data, QIODevice::WriteOnly);
+    ds.setVersion(dataStreamVersion);
+    serializeProperty(ds, source, internalIndex);
+}
+
+void serializeSharedState(QByteArray &state, const QMap<int, SharedStateValue> &values, quint32 sinceVersion)
+{
+    state.clear();
+    QDataStream ds(&state, QIODevice::WriteOnly);
+    ds.setVersion(dataStreamVersion);
+    ds << quint32(0);
+    quint32 count = 0;
+    for (auto it = values.cbegin(), end = values.cend(); it != end; ++it) {
+        if (sinceVersion && qint32(it->version - sinceVersion) <= 0)
+            continue;
+        ds << qint32(it.key()) << it->version << quint32(it->data.size());
+        ds.writeRawData(it->data.constData(), int(it->data.size()));
+        ++count;
+    }
+    ds.device()->seek(0);
+    ds << count;
+}
+
+bool writeSharedState(void *page, qsizetype pageSize, const QByteArray &state)
+{
+    if (qsizetype(sizeof(SharedStateHeader)) + state.size() > pageSize)
+        return false;
+    auto header = static_cast<SharedStateHeader *>(page);
+    const quint32 sequence = header->sequence.loadRelaxed();
+    header->sequence.storeRelaxed(sequence + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->size = quint32(state.size());
+    memcpy(header + 1, state.constData(), size_t(state.size()));
+    header->sequence.storeRelease(sequence + 2);
+    return true;
+}
+
+bool readSharedState(const void *page, qsizetype pageSize, QByteArray &state)
+{
+    if (qsizetype(sizeof(SharedStateHeader)) > pageSize)
+        return false;
+    // Only loads, the page is mapped read-only
+    auto header = static_cast<SharedStateHeader *>(const_cast<void *>(page));
+    // The host writes the page in one go, readers rarely have to wait
+    for (int attempt = 0; attempt < 1000; ++attempt) {
+        const quint32 sequence = header->sequence.loadAcquire();
+        if (sequence & 1) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        const qsizetype size = qsizetype(header->size);
+        if (qsizetype(sizeof(SharedStateHeader)) + size > pageSize) {
+            if (header->sequence.loadAcquire() == sequence)
+                return false;
+            continue;
+        }
+        state.resize(size);
+        memcpy(state.data(), header + 1, size_t(size));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->sequence.loadRelaxed() == sequence)
+            return true;
+    }
+    return false;
+}
+
 bool deserializeQVariantList(QDataStream &s, QList<QVariant> &l)
 {
     // note: optimized version of: QDataStream operator>>(QDataStream& s, QList<T>& l)
@@ -619,14 +819,90 @@ void deserializeInvokeReplyPacket(QDataStream& in, int &ackedSerialId, QVariant
     in >> value;
 }
 
-void serializePropertyChangePacket(QRemoteObjectSourceBase *source, int signalIndex)
+void serializeInvokeErrorPacket(DataStreamPacket &ds, const QString &name, int ackedSerialId, const QString &reason)
+{
+    ds.setId(InvokeErrorPacket);
+    ds << name;
+    ds << ackedSerialId;
+    ds << reason;
+    ds.finishPacket();
+}
+
+void deserializeInvokeErrorPacket(QDataStream& in, int &ackedSerialId, QString &reason)
+{
+    in >> ackedSerialId;
+    in >> reason;
+}
+
+void serializeBatchInvokePacket(DataStreamPacket &ds, const QString &name, int serialId, const QList<BatchCall> &calls)
+{
+    ds.setId(BatchInvokePacket);
+    ds << name;
+    ds << serialId;
+    ds << quint32(calls.size());
+    for (const BatchCall &call : calls) {
+        ds << call.call;
+        ds << call.index;
+        ds << quint32(call.args.size());
+        for (const auto &arg : call.args)
+            ds << encodeVariant(arg);
+    }
+    ds.finishPacket();
+}
+
+void deserializeBatchInvokePacket(QDataStream &in, int &serialId, QList<BatchCall> &calls)
+{
+    quint32 count;
+    in >> serialId;
+    in >> count;
+    calls.clear();
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        BatchCall call;
+        in >> call.call;
+        in >> call.index;
+        if (!deserializeQVariantList(in, call.args))
+            break;
+        calls.append(std::move(call));
+    }
+}
+
+void serializeBatchReplyPacket(DataStreamPacket &ds, const QString &name, int ackedSerialId, const QList<BatchResult> &results)
+{
+    ds.setId(BatchReplyPacket);
+    ds << name;
+    ds << ackedSerialId;
+    ds << quint32(results.size());
+    for (const BatchResult &result : results) {
+        ds << quint8(result.error);
+        ds << result.value;
+    }
+    ds.finishPacket();
+}
+
+void deserializeBatchReplyPacket(QDataStream &in, int &ackedSerialId, QList<BatchResult> &results)
+{
+    quint32 count;
+    in >> ackedSerialId;
+    in >> count;
+    results.clear();
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        quint8 error;
+        BatchResult result;
+        in >> error;
+        in >> result.value;
+        result.error = error;
+        results.append(std::move(result));
+    }
+}
+
+void serializePropertyChangePacket(QRemoteObjectSourceBase *source, int signalIndex, const QVariant &value)
 {
     int internalIndex = source->m_api->propertyRawIndexFromSignal(signalIndex);
     auto &ds = source->d->m_packet;
     ds.setId(PropertyChangePacket);
     ds << source->name();
     ds << internalIndex;
-    serializeProperty(ds, source, internalIndex);
+    serializeProperty(ds, source, internalIndex, value);
     ds.finishPacket();
 }
 
@@ -648,6 +924,59 @@ void deserializeObjectListPacket(QDataStream &in, ObjectInfoList &objects)
     in >> objects;
 }
 
+void serializeSharedStatePacket(DataStreamPacket &ds, const QString &name, const QString &key, const QByteArray &state)
+{
+    ds.setId(SharedStatePacket);
+    ds << name;
+    ds << key;
+    ds << state;
+    ds.finishPacket();
+}
+
+void deserializeSharedStatePacket(QDataStream &in, QString &key, QByteArray &state)
+{
+    in >> key;
+    in >> state;
+}
+
+void serializeMulticastPacket(DataStreamPacket &ds, const QString &name, const QUrl &groupUrl, quint64 sourceId)
+{
+    ds.setId(MulticastPacket);
+    ds << name;
+    ds << groupUrl;
+    ds << sourceId;
+    ds.finishPacket();
+}
+
+void deserializeMulticastPacket(QDataStream &in, QUrl &groupUrl, quint64 &sourceId)
+{
+    in >> groupUrl;
+    in >> sourceId;
+}
+
+QByteArray multicastDatagram(const QString &name, quint64 sourceId, quint32 sequence, const QByteArray &data, qint64 size)
+{
+    QByteArray datagram;
+    QDataStream ds(&datagram, QIODevice::WriteOnly);
+    ds.setVersion(dataStreamVersion);
+    ds << sequence << name << sourceId;
+    if (size > 0)
+        datagram.append(data.constData(), size);
+    return datagram;
+}
+
+bool readMulticastDatagram(const QByteArray &datagram, QString &name, quint64 &sourceId, quint32 &sequence, QByteArray &packets)
+{
+    QDataStream ds(datagram);
+    ds.setVersion(dataStreamVersion);
+    ds >> sequence >> name >> sourceId;
+    if (ds.status() != QDataStream::Ok || name.isEmpty())
+        return false;
+    // Empty for a heartbeat
+    packets = datagram.mid(ds.device()->pos());
+    return true;
+}
+
 void serializePingPacket(DataStreamPacket &ds, const QString &name)
 {
     ds.setId(Ping);
@@ -662,6 +991,20 @@ void serializePongPacket(DataStreamPacket &ds, const QString &name)
     ds.finishPacket();
 }
 
+void serializePausePacket(DataStreamPacket &ds, const QString &name)
+{
+    ds.setId(Pause);
+    ds << name;
+    ds.finishPacket();
+}
+
+void serializeResumePacket(DataStreamPacket &ds, const QString &name)
+{
+    ds.setId(Resume);
+    ds << name;
+    ds.finishPacket();
+}
+
 QRO_::QRO_(QRemoteObjectSourceBase *source)
     : name(source->name())
     , typeName(source->m_api->typeName())
@@ -55,6 +55,7 @@
 #include "qremoteobjectsource.h"
 #include "qconnectionfactories_p.h"
 
+#include <QtCore/qatomic.h>
 #include <QtCore/qhash.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qpair.h>
@@ -171,9 +172,34 @@ private:
 const QVariant encodeVariant(const QVariant &value);
 QVariant &decodeVariant(QVariant &value, QMetaType metaType);
 
+// What QVariant::save writes ahead of a value of metaType with dataStreamVersion,
+// so values can be streamed in the QVariant format without creating a QVariant.
+// Empty if the value has to go through QVariant.
+QByteArray variantHeader(QMetaType metaType);
+// Both return false if the header can't be used with the stream's version
+bool writeVariantHeader(QDataStream &ds, const QByteArray &header);
+bool skipVariantHeader(QDataStream &ds, const QByteArray &header);
+
 void serializeProperty(QDataStream &, const QRemoteObjectSourceBase *source, int internalIndex);
+// value is the current value of the property
+void serializeProperty(QDataStream &, const QRemoteObjectSourceBase *source, int internalIndex, const QVariant &value);
 
 void serializeHandshakePacket(DataStreamPacket &);
+// Handshake packet sent by both sides after the protocol version matched,
+// packets larger than maxFrameSize are then sent to the sender as fragments
+void serializeFrameSizePacket(DataStreamPacket &, quint32 maxFrameSize);
+bool deserializeFrameSizeName(const QString &name, quint32 &maxFrameSize);
+void serializeSequenceHandshakePacket(DataStreamPacket &);
+void serializeInvokeErrorHandshakePacket(DataStreamPacket &);
+void serializeSharedStateHandshakePacket(DataStreamPacket &);
+void serializeSharedStateUnavailableHandshakePacket(DataStreamPacket &);
+// Sequence numbers wrap around, skipping 0, which replicas use for unknown.
+// They are compared with serial number arithmetic, qint32(a - b) > 0 if a is
+// after b.
+inline quint32 nextSequence(quint32 sequence) { return sequence + 1 ? sequence + 1 : 1; }
+// Copy of the packets in data with a sequence number appended to each. With
+// advance, every packet gets the next number, else all get sequence.
+QByteArray sequencedPackets(const QByteArray &data, qint64 size, quint32 &sequence, bool advance = true);
 void serializeInitPacket(DataStreamPacket &, const QRemoteObjectRootSource*);
 void serializeProperties(DataStreamPacket &, const QRemoteObjectSourceBase*);
 void deserializeInitPacket(QDataStream &, QVariantList&);
@@ -189,18 +215,93 @@ void serializeRemoveObjectPacket(DataStreamPacket&, const QString &name);
 
 void serializeInvokePacket(DataStreamPacket&, const QString &name, int call, int index, const QVariantList &args, int serialId = -1, int propertyIndex = -1);
 void deserializeInvokePacket(QDataStream& in, int &call, int &index, QVariantList &args, int &serialId, int &propertyIndex);
+// false if the stream ends before all values of the list were read
+bool deserializeQVariantList(QDataStream &, QList<QVariant> &);
 
 void serializeInvokeReplyPacket(DataStreamPacket&, const QString &name, int ackedSerialId, const QVariant &value);
 void deserializeInvokeReplyPacket(QDataStream& in, int &ackedSerialId, QVariant &value);
 
+// Sent instead of a reply when the host did not run the call
+void serializeInvokeErrorPacket(DataStreamPacket&, const QString &name, int ackedSerialId, const QString &reason);
+void deserializeInvokeErrorPacket(QDataStream& in, int &ackedSerialId, QString &reason);
+
 //TODO do we need the object name or could we go with an id in backend code, this could be a costly allocation
-void serializePropertyChangePacket(QRemoteObjectSourceBase *source, int signalIndex);
+void serializePropertyChangePacket(QRemoteObjectSourceBase *source, int signalIndex, const QVariant &value);
 void deserializePropertyChangePacket(QDataStream& in, int &index, QVariant &value);
 
+// A shared state page is this header followed by size bytes of property
+// values. The writer makes sequence odd while it changes the page, a reader's
+// copy is consistent if it saw the same even sequence before and after.
+struct SharedStateHeader
+{
+    QBasicAtomicInteger<quint32> sequence;
+    quint32 size;
+};
+
+// A property value of a root source on the shared state page, with the
+// version of its last change. Versions are never 0.
+struct SharedStateValue
+{
+    quint32 version = 0;
+    QByteArray data;
+};
+
+// The serialized value of the property internalIndex of source
+void serializeSharedStateValue(QByteArray &data, const QRemoteObjectSourceBase *source, int internalIndex);
+// The values newer than sinceVersion, or all values if it is 0, each as
+// internal index, version, size and value. Readers skip the values of a
+// version they have seen without decoding them.
+void serializeSharedState(QByteArray &state, const QMap<int, SharedStateValue> &values, quint32 sinceVersion = 0);
+// Both return false if the state doesn't fit the page
+bool writeSharedState(void *page, qsizetype pageSize, const QByteArray &state);
+bool readSharedState(const void *page, qsizetype pageSize, QByteArray &state);
+
+// Tells a listener reading shared state that the page with key changed. If
+// the host has no page, the state is sent with the packet and key is empty.
+void serializeSharedStatePacket(DataStreamPacket &, const QString &name, const QString &key, const QByteArray &state = QByteArray());
+void deserializeSharedStatePacket(QDataStream &, QString &key, QByteArray &state);
+
+void serializeMulticastHandshakePacket(DataStreamPacket &);
+// Sent by the host with the group a listener can receive property changes
+// from and the id its datagrams carry, and back by the node once it joined
+// the group
+void serializeMulticastPacket(DataStreamPacket &, const QString &name, const QUrl &groupUrl, quint64 sourceId);
+void deserializeMulticastPacket(QDataStream &, QUrl &groupUrl, quint64 &sourceId);
+// A multicast datagram is the sequence number of the source, its name and
+// id, followed by the packets of one property change. A heartbeat has no
+// packets and repeats the last sequence number sent.
+QByteArray multicastDatagram(const QString &name, quint64 sourceId, quint32 sequence, const QByteArray &data, qint64 size);
+bool readMulticastDatagram(const QByteArray &datagram, QString &name, quint64 &sourceId, quint32 &sequence, QByteArray &packets);
+
+void serializeBatchHandshakePacket(DataStreamPacket &);
+// One call of a batch, the host runs the calls of a batch in order
+struct BatchCall
+{
+    int call;
+    int index;
+    QVariantList args;
+};
+// The result of one call of a batch, error is a QRemoteObjectPendingCall::Error
+struct BatchResult
+{
+    int error;
+    QVariant value;
+};
+void serializeBatchInvokePacket(DataStreamPacket &, const QString &name, int serialId, const QList<BatchCall> &calls);
+void deserializeBatchInvokePacket(QDataStream &, int &serialId, QList<BatchCall> &calls);
+// A single reply with the results of all calls of a batch, in order
+void serializeBatchReplyPacket(DataStreamPacket &, const QString &name, int ackedSerialId, const QList<BatchResult> &results);
+void deserializeBatchReplyPacket(QDataStream &, int &ackedSerialId, QList<BatchResult> &results);
+
 // Heartbeat packets
 void serializePingPacket(DataStreamPacket &ds, const QString &name);
 void serializePongPacket(DataStreamPacket &ds, const QString &name);
 
+// Pause and resume updates of a root object. The host acknowledges a resume
+// with a Resume packet after the updates the replica missed.
+void serializePausePacket(DataStreamPacket &ds, const QString &name);
+void serializeResumePacket(DataStreamPacket &ds, const QString &name);
+
 
 } // namespace QRemoteObjectPackets
 
@@ -127,6 +127,12 @@ QVariant QRemoteObjectPendingCall::returnValue() const
            No error occurred.
     \value InvalidMessage
            The default error state prior to the remote call finishing.
+    \value Rejected
+           The host did not run the call because the client exceeded its
+           invoke limits, see QRemoteObjectHostBase::setMaxInvokeRate(), or
+           the call of a batch could not be sent, see
+           QRemoteObjectReplica::submitBatch(). This value was introduced in
+           Qt 6.2.
 */
 
 /*!
@@ -54,7 +54,8 @@ class Q_REMOTEOBJECTS_EXPORT QRemoteObjectPendingCall
 public:
     enum Error {
         NoError,
-        InvalidMessage
+        InvalidMessage,
+        Rejected
     };
 
     QRemoteObjectPendingCall();
@@ -80,6 +81,7 @@ protected:
 
 private:
     friend class QConnectedReplicaImplementation;
+    friend class QRemoteObjectPendingCallData;
 };
 
 QT_END_NAMESPACE
@@ -55,6 +55,8 @@
 
 #include <QtCore/qmutex.h>
 
+#include <functional>
+
 QT_BEGIN_NAMESPACE
 
 class QRemoteObjectPendingCallWatcherHelper;
@@ -65,9 +67,25 @@ class QRemoteObjectPendingCallData : public QSharedData
 public:
     typedef QExplicitlySharedDataPointer<QRemoteObjectPendingCallData> Ptr;
 
+    using FinishedCallback = std::function<void()>;
+
     explicit QRemoteObjectPendingCallData(int serialId = -1, QRemoteObjectReplicaImplementation *replica = nullptr);
     ~QRemoteObjectPendingCallData();
 
+    static QRemoteObjectPendingCallData *get(const QRemoteObjectPendingCall &call) { return call.d.data(); }
+
+    // A lighter alternative to QRemoteObjectPendingCallWatcher: the callback is
+    // invoked once, from the thread receiving the reply, without the mutex held.
+    // Returns false, without storing the callback, if the call already finished.
+    bool addFinishedCallback(FinishedCallback callback)
+    {
+        QMutexLocker locker(&mutex);
+        if (error != QRemoteObjectPendingCall::InvalidMessage)
+            return false;
+        finishedCallbacks.append(std::move(callback));
+        return true;
+    }
+
     QRemoteObjectReplicaImplementation *replica;
     int serialId;
 
@@ -77,6 +95,7 @@ public:
     mutable QMutex mutex;
 
     mutable QScopedPointer<QRemoteObjectPendingCallWatcherHelper> watcherHelper;
+    QList<FinishedCallback> finishedCallbacks;
 };
 
 class QRemoteObjectPendingCallWatcherHelper: public QObject
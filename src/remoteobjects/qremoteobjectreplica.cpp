@@ -97,6 +97,8 @@ QConnectedReplicaImplementation::QConnectedReplicaImplementation(const QString &
     m_heartbeatTimer.setSingleShot(true);
     m_heartbeatTimer.setInterval(node->heartbeatInterval());
 
+    m_replyCache.setMaxCost(node->replyCacheSize());
+
     connect(node, &QRemoteObjectNode::heartbeatIntervalChanged, this, [this](int interval) {
         m_heartbeatTimer.stop();
         m_heartbeatTimer.setInterval(interval);
@@ -185,6 +187,57 @@ void QRemoteObjectReplicaImplementation::emitNotified()
     QMetaObject::activate(this, metaObject(), notifiedIndex, args);
 }
 
+void QRemoteObjectReplicaImplementation::emitPropertySnapshotChanged()
+{
+    if (m_snapshotChangedHolds > 0) {
+        m_snapshotChangedHeld = true;
+        return;
+    }
+    const static int snapshotChangedIndex = QRemoteObjectReplica::staticMetaObject.indexOfMethod("propertySnapshotChanged()");
+    Q_ASSERT(snapshotChangedIndex != -1);
+    void *args[] = {nullptr};
+    QMetaObject::activate(this, metaObject(), snapshotChangedIndex, args);
+}
+
+QVariantMap QRemoteObjectReplicaImplementation::propertySnapshot()
+{
+    if (!m_hasPropertySnapshot && m_metaObject) {
+        QVariantMap snapshot;
+        for (int index = m_propertyOffset; index < m_metaObject->propertyCount(); ++index)
+            snapshot.insert(QString::fromLatin1(m_metaObject->property(index).name()), getProperty(index - m_propertyOffset));
+        m_propertySnapshot = snapshot;
+        m_hasPropertySnapshot = true;
+    }
+    return m_propertySnapshot;
+}
+
+// Only touches the one entry, maps handed out earlier keep their values (copy on write)
+void QRemoteObjectReplicaImplementation::updatePropertySnapshot(int i)
+{
+    if (!m_hasPropertySnapshot)
+        return;
+    m_propertySnapshot.insert(QString::fromLatin1(m_metaObject->property(i + m_propertyOffset).name()), getProperty(i));
+}
+
+void QRemoteObjectReplicaImplementation::resetPropertySnapshot()
+{
+    m_propertySnapshot.clear();
+    m_hasPropertySnapshot = false;
+}
+
+void QRemoteObjectReplicaImplementation::holdPropertySnapshotChanged()
+{
+    ++m_snapshotChangedHolds;
+}
+
+void QRemoteObjectReplicaImplementation::releasePropertySnapshotChanged()
+{
+    Q_ASSERT(m_snapshotChangedHolds > 0);
+    if (--m_snapshotChangedHolds > 0 || !qExchange(m_snapshotChangedHeld, false))
+        return;
+    emitPropertySnapshotChanged();
+}
+
 bool QConnectedReplicaImplementation::sendCommand()
 {
     if (connectionToSource.isNull() || !connectionToSource->isOpen()) {
@@ -221,7 +274,8 @@ void QConnectedReplicaImplementation::initialize(QVariantList &values)
         qCDebug(QT_REMOTEOBJECT) << "SETPROPERTY" << i << m_metaObject->property(i+offset).name() << values.at(i).typeName() << values.at(i).toString();
     }
 
-    Q_ASSERT(m_state.loadAcquire() < QRemoteObjectReplica::Valid || m_state.loadAcquire() == QRemoteObjectReplica::Suspect);
+    // A resync initializes a valid replica again
+    Q_ASSERT(m_state.loadAcquire() <= QRemoteObjectReplica::Suspect);
     setState(QRemoteObjectReplica::Valid);
 
     void *args[] = {nullptr, nullptr};
@@ -235,6 +289,15 @@ void QConnectedReplicaImplementation::initialize(QVariantList &values)
         args[1] = m_propertyStorage[i].data();
         QMetaObject::activate(this, metaObject(), notifyIndex, args);
     }
+    bool snapshotChanged = false;
+    for (int i = 0; i < nParam; ++i) {
+        if (changedProperties[i] < 0)
+            continue;
+        updatePropertySnapshot(i);
+        snapshotChanged = true;
+    }
+    if (snapshotChanged)
+        emitPropertySnapshotChanged();
     emitNotified();
 
     qCDebug(QT_REMOTEOBJECT) << "isSet = true for" << m_objectName;
@@ -316,6 +379,8 @@ void QConnectedReplicaImplementation::setDynamicProperties(const QVariantList &v
             QMetaObject::activate(this, metaObject(), mp.notifySignalIndex(), args);
         }
     }
+    resetPropertySnapshot();
+    emitPropertySnapshotChanged();
     emitNotified();
 
     qCDebug(QT_REMOTEOBJECT) << "isSet = true for" << m_objectName;
@@ -369,7 +434,10 @@ void QConnectedReplicaImplementation::_q_send(QMetaObject::Call call, int index,
         }
         if (index < m_methodOffset) //index - m_methodOffset < 0 is invalid, and can't be resolved on the Source side
             qCWarning(QT_REMOTEOBJECT) << "Skipping invalid method invocation.  Index not found:" << index << "( offset =" << m_methodOffset << ") object:" << m_objectName << this->m_metaObject->method(index).name();
-        else {
+        else if (m_batching) {
+            m_batch.append(BatchCall{call, index - m_methodOffset, args});
+            m_batchCalls.append(QRemoteObjectPendingCall(nullptr));
+        } else {
             serializeInvokePacket(m_packet, m_objectName, call, index - m_methodOffset, args);
             sendCommand();
         }
@@ -377,7 +445,10 @@ void QConnectedReplicaImplementation::_q_send(QMetaObject::Call call, int index,
         qCDebug(QT_REMOTEOBJECT) << "Send" << call << this->m_metaObject->property(index).name() << index << args << connectionToSource;
         if (index < m_propertyOffset) //index - m_propertyOffset < 0 is invalid, and can't be resolved on the Source side
             qCWarning(QT_REMOTEOBJECT) << "Skipping invalid property invocation.  Index not found:" << index << "( offset =" << m_propertyOffset << ") object:" << m_objectName << this->m_metaObject->property(index).name();
-        else {
+        else if (m_batching) {
+            m_batch.append(BatchCall{call, index - m_propertyOffset, args});
+            m_batchCalls.append(QRemoteObjectPendingCall(nullptr));
+        } else {
             serializeInvokePacket(m_packet, m_objectName, call, index - m_propertyOffset, args);
             sendCommand();
         }
@@ -389,11 +460,156 @@ QRemoteObjectPendingCall QConnectedReplicaImplementation::_q_sendWithReply(QMeta
     Q_ASSERT(call == QMetaObject::InvokeMetaMethod);
 
     qCDebug(QT_REMOTEOBJECT) << "Send" << call << this->m_metaObject->method(index).name() << index << args << connectionToSource;
+    if (m_batching) {
+        QRemoteObjectPendingCall pendingCall(new QRemoteObjectPendingCallData(-1, this));
+        m_batch.append(BatchCall{call, index - m_methodOffset, args});
+        m_batchCalls.append(pendingCall);
+        return pendingCall;
+    }
     int serialId = (m_curSerialId == std::numeric_limits<int>::max() ? 1 : m_curSerialId++);
     serializeInvokePacket(m_packet, m_objectName, call, index - m_methodOffset, args, serialId);
     return sendCommandWithReply(serialId);
 }
 
+QRemoteObjectPendingCall QConnectedReplicaImplementation::_q_sendWithCachedReply(int index, const QVariantList &args, int ttl, int invalidatingSignal)
+{
+    QByteArray key;
+    QDataStream ds(&key, QIODevice::WriteOnly);
+    ds.setVersion(QtRemoteObjects::dataStreamVersion);
+    ds << index;
+    for (const QVariant &arg : args)
+        ds << encodeVariant(arg);
+
+    if (CachedReply *cached = m_replyCache.object(key)) {
+        if (!cached->expiry.hasExpired()) {
+            qCDebug(QT_REMOTEOBJECT) << "Cached reply for" << this->m_metaObject->method(index).name() << index << m_objectName;
+            return cached->call;
+        }
+        m_replyCache.remove(key);
+    }
+
+    QRemoteObjectPendingCall call = _q_sendWithReply(QMetaObject::InvokeMetaMethod, index, args);
+    QRemoteObjectPendingCallData *d = QRemoteObjectPendingCallData::get(call);
+    // Calls that could not be sent never get a reply
+    if (d->replica != this)
+        return call;
+    if (invalidatingSignal >= 0 && !m_cacheInvalidators.contains(invalidatingSignal))
+        m_cacheInvalidators.insert(invalidatingSignal, new QRemoteObjectReplyCacheInvalidator(this, invalidatingSignal));
+    if (!m_replyCache.insert(key, new CachedReply{call, QDeadlineTimer(QDeadlineTimer::Forever), invalidatingSignal}))
+        return call;
+
+    // The ttl starts with the reply, failed calls are not cached
+    d->addFinishedCallback([this, key, d, ttl] {
+        CachedReply *cached = m_replyCache.object(key);
+        if (!cached || QRemoteObjectPendingCallData::get(cached->call) != d)
+            return; // invalidated while in flight
+        if (cached->call.error() != QRemoteObjectPendingCall::NoError)
+            m_replyCache.remove(key);
+        else if (ttl > 0)
+            cached->expiry.setRemainingTime(ttl, Qt::CoarseTimer);
+    });
+    return call;
+}
+
+void QConnectedReplicaImplementation::invalidateCachedReplies(int signalIndex)
+{
+    if (signalIndex == -1) {
+        m_replyCache.clear();
+        return;
+    }
+    const auto keys = m_replyCache.keys();
+    for (const QByteArray &key : keys) {
+        if (m_replyCache.object(key)->invalidatingSignal == signalIndex)
+            m_replyCache.remove(key);
+    }
+}
+
+QRemoteObjectReplyCacheInvalidator::QRemoteObjectReplyCacheInvalidator(QConnectedReplicaImplementation *replica, int signalIndex)
+    : QObject(replica), m_replica(replica), m_signalIndex(signalIndex)
+{
+    // Signals of the replica are activated on its implementation, see configurePrivate()
+    static const int invalidateIndex = staticMetaObject.indexOfSlot("invalidate()");
+    const bool res = QMetaObject::connect(replica, signalIndex, this, invalidateIndex, Qt::DirectConnection, nullptr);
+    qCDebug(QT_REMOTEOBJECT) << "  Cache invalidator connect" << signalIndex << res;
+    Q_UNUSED(res)
+}
+
+void QRemoteObjectReplyCacheInvalidator::invalidate()
+{
+    m_replica->invalidateCachedReplies(m_signalIndex);
+}
+
+void QConnectedReplicaImplementation::beginBatch()
+{
+    m_batching = true;
+}
+
+QRemoteObjectPendingCall QConnectedReplicaImplementation::submitBatch()
+{
+    m_batching = false;
+    const QList<BatchCall> batch = qExchange(m_batch, {});
+    QList<QRemoteObjectPendingCall> calls = qExchange(m_batchCalls, {});
+    if (batch.isEmpty())
+        return QRemoteObjectPendingCall::fromCompletedCall(QVariant());
+    // The calls of a batch that wasn't sent are never answered
+    const auto dropCalls = [this](QList<QRemoteObjectPendingCall> &dropped) {
+        for (QRemoteObjectPendingCall &call : dropped) {
+            if (call.d)
+                finishPendingCall(call, QRemoteObjectPendingCall::Rejected, QVariant());
+        }
+    };
+    if (connectionToSource.isNull() || !connectionToSource->isOpen()) {
+        qCWarning(QT_REMOTEOBJECT) << "Dropping a batch of" << batch.size() << "calls to" << m_objectName << "without connection";
+        dropCalls(calls);
+        return QRemoteObjectPendingCall(); // invalid
+    }
+
+    if (connectionToSource->acceptsBatches()) {
+        qCDebug(QT_REMOTEOBJECT) << "Send batch of" << batch.size() << "calls" << connectionToSource;
+        const int serialId = (m_curSerialId == std::numeric_limits<int>::max() ? 1 : m_curSerialId++);
+        serializeBatchInvokePacket(m_packet, m_objectName, serialId, batch);
+        QRemoteObjectPendingCall pendingCall = sendCommandWithReply(serialId);
+        if (pendingCall.d->serialId == serialId)
+            m_submittedBatches.insert(serialId, calls);
+        else
+            dropCalls(calls);
+        return pendingCall;
+    }
+
+    // A host of an earlier version gets the calls one by one, the batch
+    // finishes with the last of them
+    QRemoteObjectPendingCall batchCall(new QRemoteObjectPendingCallData(-1, this));
+    QList<QRemoteObjectPendingCall> pendingCalls;
+    for (int i = 0; i < batch.size(); ++i) {
+        const BatchCall &call = batch.at(i);
+        if (!calls.at(i).d) {
+            serializeInvokePacket(m_packet, m_objectName, call.call, call.index, call.args);
+            sendCommand();
+            continue;
+        }
+        const int serialId = (m_curSerialId == std::numeric_limits<int>::max() ? 1 : m_curSerialId++);
+        serializeInvokePacket(m_packet, m_objectName, call.call, call.index, call.args, serialId);
+        if (!sendCommand()) {
+            finishPendingCall(calls[i], QRemoteObjectPendingCall::Rejected, QVariant());
+            continue;
+        }
+        calls[i].d->serialId = serialId;
+        m_pendingCalls[serialId] = calls.at(i);
+        pendingCalls.append(calls.at(i));
+    }
+    auto remaining = QSharedPointer<qsizetype>::create(pendingCalls.size());
+    for (const QRemoteObjectPendingCall &call : qAsConst(pendingCalls)) {
+        // Called by finishPendingCall(), with this replica alive
+        QRemoteObjectPendingCallData::get(call)->addFinishedCallback([this, batchCall, remaining]() mutable {
+            if (--*remaining == 0)
+                finishPendingCall(batchCall, QRemoteObjectPendingCall::NoError, QVariant());
+        });
+    }
+    if (pendingCalls.isEmpty())
+        finishPendingCall(batchCall, QRemoteObjectPendingCall::NoError, QVariant());
+    return batchCall;
+}
+
 QRemoteObjectPendingCall QConnectedReplicaImplementation::sendCommandWithReply(int serialId)
 {
     bool success = sendCommand();
@@ -418,15 +634,52 @@ void QConnectedReplicaImplementation::notifyAboutReply(int ackedSerialId, const
         return;
     }
 
+    finishPendingCall(call, QRemoteObjectPendingCall::NoError, value);
+}
+
+void QConnectedReplicaImplementation::notifyAboutError(int ackedSerialId)
+{
+    QRemoteObjectPendingCall call = m_pendingCalls.take(ackedSerialId);
+    // None of the calls of a rejected batch ran
+    QList<QRemoteObjectPendingCall> calls = m_submittedBatches.take(ackedSerialId);
+    for (QRemoteObjectPendingCall &batchedCall : calls) {
+        if (batchedCall.d)
+            finishPendingCall(batchedCall, QRemoteObjectPendingCall::Rejected, QVariant());
+    }
+    finishPendingCall(call, QRemoteObjectPendingCall::Rejected, QVariant());
+}
+
+void QConnectedReplicaImplementation::notifyAboutBatchReply(int ackedSerialId, const QList<BatchResult> &results)
+{
+    QRemoteObjectPendingCall call = m_pendingCalls.take(ackedSerialId);
+    QList<QRemoteObjectPendingCall> calls = m_submittedBatches.take(ackedSerialId);
+    for (int i = 0; i < calls.size(); ++i) {
+        if (!calls.at(i).d)
+            continue;
+        if (i < results.size() && results.at(i).error == QRemoteObjectPendingCall::NoError)
+            finishPendingCall(calls[i], QRemoteObjectPendingCall::NoError, results.at(i).value);
+        else
+            finishPendingCall(calls[i], QRemoteObjectPendingCall::Rejected, QVariant());
+    }
+
+    finishPendingCall(call, QRemoteObjectPendingCall::NoError, QVariant());
+}
+
+void QConnectedReplicaImplementation::finishPendingCall(QRemoteObjectPendingCall &call, QRemoteObjectPendingCall::Error error, const QVariant &value)
+{
     QMutexLocker mutex(&call.d->mutex);
 
-    // clear error flag
-    call.d->error = QRemoteObjectPendingCall::NoError;
+    call.d->error = error;
     call.d->returnValue = value;
 
     // notify watchers if needed
     if (call.d->watcherHelper)
         call.d->watcherHelper->emitSignals();
+
+    const auto callbacks = qExchange(call.d->finishedCallbacks, {});
+    mutex.unlock();
+    for (const auto &callback : callbacks)
+        callback();
 }
 
 bool QConnectedReplicaImplementation::waitForFinished(const QRemoteObjectPendingCall& call, int timeout)
@@ -464,7 +717,31 @@ void QConnectedReplicaImplementation::setProperties(const QVariantList &properti
 
 void QConnectedReplicaImplementation::setProperty(int i, const QVariant &prop)
 {
+    m_unchangedProperty = -1;
+    if (state() != QRemoteObjectReplica::Uninitialized && prop.isValid() && m_propertyStorage.at(i) == prop) {
+        // The notify signal following the change is dropped as well, see takeUnchangedProperty()
+        m_unchangedProperty = i;
+        return;
+    }
     m_propertyStorage[i] = prop;
+    if (m_metaObject && state() != QRemoteObjectReplica::Uninitialized) {
+        updatePropertySnapshot(i);
+        emitPropertySnapshotChanged();
+    }
+}
+
+bool QConnectedReplicaImplementation::takeUnchangedProperty(int i)
+{
+    const bool unchanged = m_unchangedProperty == i;
+    m_unchangedProperty = -1;
+    return unchanged;
+}
+
+QVariantMap QConnectedReplicaImplementation::propertySnapshot()
+{
+    if (m_propertyStorage.isEmpty())
+        return QVariantMap();
+    return QRemoteObjectReplicaImplementation::propertySnapshot();
 }
 
 void QConnectedReplicaImplementation::setConnection(IoDeviceBase *conn)
@@ -479,6 +756,9 @@ void QConnectedReplicaImplementation::setConnection(IoDeviceBase *conn)
 void QConnectedReplicaImplementation::setDisconnected()
 {
     connectionToSource.clear();
+    m_multicastUrl.clear();
+    // The source may have changed until the replica is connected again
+    invalidateCachedReplies();
     setState(QRemoteObjectReplica::State::Suspect);
     for (const int index : childIndices()) {
         auto pointerToQObject = qvariant_cast<QObject *>(getProperty(index));
@@ -490,6 +770,148 @@ void QConnectedReplicaImplementation::setDisconnected()
 
 void QConnectedReplicaImplementation::requestRemoteObjectSource()
 {
+    m_lastSequence = 0;
+    m_resyncPending = false;
+    m_resumePending = false;
+    m_multicastUrl.clear();
+    serializeAddObjectPacket(m_packet, m_objectName, needsDynamicInitialization());
+    sendCommand();
+    // A new listener is not paused
+    if (m_paused) {
+        serializePausePacket(m_packet, m_objectName);
+        sendCommand();
+    }
+}
+
+void QConnectedReplicaImplementation::setPaused(bool paused)
+{
+    if (m_paused == paused)
+        return;
+    qCDebug(QT_REMOTEOBJECT) << (paused ? "Pausing" : "Resuming") << m_objectName;
+    if (paused)
+        serializePausePacket(m_packet, m_objectName);
+    else
+        serializeResumePacket(m_packet, m_objectName);
+    const bool sent = sendCommand();
+    setPausedState(paused, sent && !paused);
+}
+
+void QConnectedReplicaImplementation::resumed()
+{
+    setPausedState(m_paused, false);
+}
+
+void QConnectedReplicaImplementation::setPausedState(bool paused, bool resumePending)
+{
+    m_paused = paused;
+    m_resumePending = resumePending;
+    for (int index : qAsConst(m_childIndices)) {
+        auto child = qobject_cast<QRemoteObjectReplica *>(m_propertyStorage.at(index).value<QObject *>());
+        // Stub implementations are not initialized
+        if (!child || !child->d_impl->isInitialized())
+            continue;
+        auto childImpl = static_cast<QRemoteObjectReplicaImplementation *>(child->d_impl.data());
+        if (!childImpl->isShortCircuit())
+            static_cast<QConnectedReplicaImplementation *>(childImpl)->setPausedState(paused, resumePending);
+    }
+}
+
+bool QConnectedReplicaImplementation::checkSequence(quint32 sequence)
+{
+    // The host doesn't number the property changes for a paused replica
+    if (m_paused || m_resumePending) {
+        m_lastSequence = sequence;
+        return true;
+    }
+    if (m_lastSequence == 0 || sequence == nextSequence(m_lastSequence)) {
+        m_lastSequence = sequence;
+        return true;
+    }
+    // Serial number arithmetic, the numbers wrap around
+    const qint32 distance = qint32(sequence - m_lastSequence);
+    if (distance <= 0) {
+        qCDebug(QT_REMOTEOBJECT) << "Dropping duplicate packet" << sequence << "for" << m_objectName;
+        return false;
+    }
+    qCWarning(QT_REMOTEOBJECT) << "Missed" << distance - 1 << "packets for" << m_objectName;
+    m_lastSequence = sequence;
+    // The latest value is still applied, the resync restores what was missed
+    requestResync();
+    return true;
+}
+
+void QConnectedReplicaImplementation::checkReplySequence(quint32 sequence)
+{
+    // The source sent packets before this reply that never arrived
+    const qint32 distance = qint32(sequence - m_lastSequence);
+    if (m_lastSequence != 0 && distance > 0 && !m_paused && !m_resumePending) {
+        qCWarning(QT_REMOTEOBJECT) << "Missed" << distance << "packets before a reply for" << m_objectName;
+        m_lastSequence = sequence;
+        requestResync();
+    }
+}
+
+void QConnectedReplicaImplementation::resetSequence(quint32 sequence)
+{
+    m_lastSequence = sequence;
+    m_resyncPending = false;
+}
+
+void QConnectedReplicaImplementation::setMulticastGroup(const QUrl &groupUrl, quint64 sourceId)
+{
+    m_multicastUrl = groupUrl;
+    m_multicastId = sourceId;
+    m_lastMulticastSequence = 0;
+    // Sent after the init packet, a resync is complete
+    m_resyncPending = false;
+}
+
+bool QConnectedReplicaImplementation::checkMulticastSequence(quint32 sequence)
+{
+    const qint32 distance = qint32(sequence - m_lastMulticastSequence);
+    if (m_lastMulticastSequence != 0 && distance <= 0) {
+        qCDebug(QT_REMOTEOBJECT) << "Dropping duplicate datagram" << sequence << "for" << m_objectName;
+        return false;
+    }
+    const bool missed = m_lastMulticastSequence != 0 && sequence != nextSequence(m_lastMulticastSequence);
+    if (missed)
+        qCWarning(QT_REMOTEOBJECT) << "Missed" << distance - 1 << "datagrams for" << m_objectName;
+    m_lastMulticastSequence = sequence;
+    // The latest value is still applied, the resync restores what was missed
+    if (missed)
+        requestResync();
+    return true;
+}
+
+void QConnectedReplicaImplementation::checkMulticastHeartbeat(quint32 sequence)
+{
+    // Without a datagram yet the heartbeat only tells where the source is
+    const qint32 distance = qint32(sequence - m_lastMulticastSequence);
+    const bool missed = m_lastMulticastSequence != 0 && distance > 0;
+    if (missed)
+        qCWarning(QT_REMOTEOBJECT) << "Missed" << distance << "datagrams for" << m_objectName;
+    if (m_lastMulticastSequence == 0 || missed)
+        m_lastMulticastSequence = sequence;
+    if (missed)
+        requestResync();
+}
+
+void QConnectedReplicaImplementation::requestResync()
+{
+    if (m_resyncPending || connectionToSource.isNull())
+        return;
+    // Only the root objects of a host can be re-acquired
+    if (!connectionToSource->remoteObjects().contains(m_objectName)) {
+        qCWarning(QT_REMOTEOBJECT) << "Can't resync" << m_objectName << "it is not a root object of its host";
+        return;
+    }
+
+    // The host sends a new init packet with all current values, and the
+    // number to continue from
+    qCDebug(QT_REMOTEOBJECT) << "Resyncing" << m_objectName;
+    m_resyncPending = true;
+    serializeRemoveObjectPacket(m_packet, m_objectName);
+    sendCommand();
     serializeAddObjectPacket(m_packet, m_objectName, needsDynamicInitialization());
     sendCommand();
 }
@@ -665,6 +1087,17 @@ void QConnectedReplicaImplementation::configurePrivate(QRemoteObjectReplica *rep
     and \c notified allows the developer to distinguish between these two cases.
 */
 
+/*!
+    \fn void QRemoteObjectReplica::propertySnapshotChanged()
+    \since 6.2
+
+    This signal is emitted whenever the value of one or more properties of the
+    replica changed. When the replica is initialized, it is emitted once for all
+    changed properties.
+
+    \sa propertySnapshot()
+*/
+
 /*!
     \internal
     \enum QRemoteObjectReplica::ConstructorType
@@ -677,6 +1110,15 @@ void QConnectedReplicaImplementation::configurePrivate(QRemoteObjectReplica *rep
     This property holds the replica \l QRemoteObjectReplica::State.
 */
 
+/*!
+    \property QRemoteObjectReplica::propertySnapshot
+    \since 6.2
+    \brief An immutable map of all property values of the replica, keyed by
+    property name.
+
+    \sa propertySnapshotOf()
+*/
+
 /*!
     \property QRemoteObjectReplica::node
     \brief A pointer to the node this object was acquired from.
@@ -724,6 +1166,21 @@ QRemoteObjectPendingCall QRemoteObjectReplica::sendWithReply(QMetaObject::Call c
     return d_impl->_q_sendWithReply(call, index, args);
 }
 
+/*!
+    \internal
+    \since 6.2
+
+    Calls the slot with \a index like sendWithReply(), for slots declared
+    CACHED in a .rep file. Repeated calls with the same \a args return the
+    cached reply for \a ttl milliseconds, or until the replica disconnects if
+    \a ttl is 0. Emitting the signal with index \a invalidatingSignal drops
+    the cached replies, -1 if no signal invalidates them.
+*/
+QRemoteObjectPendingCall QRemoteObjectReplica::sendWithCachedReply(int index, const QVariantList &args, int ttl, int invalidatingSignal)
+{
+    return d_impl->_q_sendWithCachedReply(index, args, ttl, invalidatingSignal);
+}
+
 /*!
     \internal
 */
@@ -794,6 +1251,148 @@ void QRemoteObjectReplica::setNode(QRemoteObjectNode *_node)
     _node->initializeReplica(this);
 }
 
+/*!
+    \since 6.2
+
+    Returns the current values of all properties of this replica, keyed by
+    property name.
+
+    The returned map is a snapshot and is not changed by later updates from the
+    \l {Source}. Internally the snapshot is only updated for the properties that
+    change, so reading it repeatedly is cheap. This allows a QML binding to
+    depend on a single value instead of on every individual property.
+
+    An empty map is returned while the replica is not initialized.
+
+    \sa propertySnapshotChanged(), propertySnapshotOf()
+*/
+QVariantMap QRemoteObjectReplica::propertySnapshot() const
+{
+    if (state() == Uninitialized)
+        return QVariantMap();
+    return static_cast<QRemoteObjectReplicaImplementation *>(d_impl.data())->propertySnapshot();
+}
+
+/*!
+    \since 6.2
+
+    Returns the current values of the properties listed in \a names, keyed by
+    property name. Names that do not match a property of this replica are
+    ignored.
+
+    \sa propertySnapshot()
+*/
+QVariantMap QRemoteObjectReplica::propertySnapshotOf(const QStringList &names) const
+{
+    const QVariantMap snapshot = propertySnapshot();
+    QVariantMap selected;
+    for (const QString &name : names) {
+        const auto it = snapshot.constFind(name);
+        if (it != snapshot.cend())
+            selected.insert(name, it.value());
+    }
+    return selected;
+}
+
+/*!
+    \since 6.2
+
+    Stops updates of the properties of this replica, and of the replicas of
+    its child objects, until resume() is called. The \l {Source} then no
+    longer sends property changes to this replica, but remembers which
+    properties changed. Signals that do not notify a property change are
+    still received, as are replies to slot calls.
+
+    Pausing is useful for replicas that are not shown at the moment, and is
+    cheaper than releasing and acquiring them again. Only replicas of objects
+    hosted by a remote node can be paused, and only the root object of a
+    hosted object tree. A \l {Source} hosted by an earlier version of Qt
+    Remote Objects ignores the request.
+
+    \sa resume(), isPaused()
+*/
+void QRemoteObjectReplica::pause()
+{
+    d_impl->setPaused(true);
+}
+
+/*!
+    \since 6.2
+
+    Resumes updates of this replica after pause(). The \l {Source} sends the
+    current value of every property that changed while the replica was
+    paused, and the notify signals of these properties are emitted.
+
+    \sa pause(), isPaused()
+*/
+void QRemoteObjectReplica::resume()
+{
+    d_impl->setPaused(false);
+}
+
+/*!
+    \since 6.2
+
+    Returns \c true if updates of this replica are paused.
+
+    \sa pause(), resume()
+*/
+bool QRemoteObjectReplica::isPaused() const
+{
+    return d_impl->isPaused();
+}
+
+/*!
+    \since 6.2
+
+    Starts a batch of calls. The slot calls and property writes made on this
+    replica after beginBatch() are not sent, but queued until submitBatch()
+    sends them to the \l {Source} together, in one packet. The \l {Source}
+    runs them in the order they were made, and answers with a single reply
+    holding the results of all of them.
+
+    The calls still return a QRemoteObjectPendingCall each, which finishes
+    when the reply of the batch arrives, with the return value of the call
+    or the QRemoteObjectPendingCall::Rejected error if the call couldn't be
+    run. Batches save round trips, packets and bookkeeping when many small
+    calls are made in a row, e.g. for bulk configuration.
+
+    Calling beginBatch() again before submitBatch() has no effect. Calls on
+    the replicas of child objects are not part of the batch. Replicas of
+    objects hosted by the same node run calls as they are made. A \l
+    {Source} hosted by an earlier version of Qt Remote Objects gets the
+    calls one by one when the batch is submitted.
+
+    \sa submitBatch()
+*/
+void QRemoteObjectReplica::beginBatch()
+{
+    d_impl->beginBatch();
+}
+
+/*!
+    \since 6.2
+
+    Sends the calls made since beginBatch() and returns a pending call that
+    finishes once the \l {Source} ran all of them. It has no return value,
+    the results are those of the pending calls returned by the calls. If the
+    \l {Source} rejected the whole batch, e.g. because of the limits set with
+    QRemoteObjectHostBase::setMaxQueuedInvokes(), the returned call and those
+    of all calls in the batch finish with the
+    QRemoteObjectPendingCall::Rejected error.
+
+    Returns an invalid pending call if the replica isn't connected to its
+    \l {Source}; the calls of the batch are then dropped, and their pending
+    calls finish with the QRemoteObjectPendingCall::Rejected error, as do
+    those of calls that couldn't be sent.
+
+    \sa beginBatch()
+*/
+QRemoteObjectPendingCall QRemoteObjectReplica::submitBatch()
+{
+    return d_impl->submitBatch();
+}
+
 /*!
     \internal
 */
@@ -845,6 +1444,13 @@ const QVariant QInProcessReplicaImplementation::getProperty(int i) const
     return connectionToSource->m_object->metaObject()->property(index).read(connectionToSource->m_object);
 }
 
+QVariantMap QInProcessReplicaImplementation::propertySnapshot()
+{
+    // Values live in the source, the map is built again after the source
+    // notified a change, see QRemoteObjectNodePrivate::connectReplica()
+    return QRemoteObjectReplicaImplementation::propertySnapshot();
+}
+
 void QInProcessReplicaImplementation::setProperties(const QVariantList &)
 {
     //TODO some verification here maybe?
@@ -895,7 +1501,14 @@ QRemoteObjectPendingCall QInProcessReplicaImplementation::_q_sendWithReply(QMeta
         return QRemoteObjectPendingCall();
     }
 
+    // A replica used as a source (i.e. by proxy()) replies with a pending call
+    const bool isPendingCall = connectionToSource->m_api->typeName(ReplicaIndex) == QByteArrayLiteral("QRemoteObjectPendingCall");
+    if (isPendingCall)
+        returnValue = QVariant::fromValue<QRemoteObjectPendingCall>(QRemoteObjectPendingCall());
+
     connectionToSource->invoke(call, ReplicaIndex, args, &returnValue);
+    if (isPendingCall)
+        return returnValue.value<QRemoteObjectPendingCall>();
     return QRemoteObjectPendingCall::fromCompletedCall(returnValue);
 }
 
@@ -43,6 +43,8 @@
 #include <QtRemoteObjects/qtremoteobjectglobal.h>
 
 #include <QtCore/qsharedpointer.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
 
 Q_MOC_INCLUDE(<QtRemoteObjects/qremoteobjectnode.h>)
 
@@ -59,6 +61,7 @@ class Q_REMOTEOBJECTS_EXPORT QRemoteObjectReplica : public QObject
     Q_OBJECT
     Q_PROPERTY(QRemoteObjectNode *node READ node WRITE setNode)
     Q_PROPERTY(State state READ state NOTIFY stateChanged)
+    Q_PROPERTY(QVariantMap propertySnapshot READ propertySnapshot NOTIFY propertySnapshotChanged)
 public:
     enum State {
         Uninitialized,
@@ -78,11 +81,21 @@ public:
     State state() const;
     QRemoteObjectNode *node() const;
     virtual void setNode(QRemoteObjectNode *node);
+    QVariantMap propertySnapshot() const;
+    Q_INVOKABLE QVariantMap propertySnapshotOf(const QStringList &names) const;
+    bool isPaused() const;
+    void beginBatch();
+    QRemoteObjectPendingCall submitBatch();
+
+public Q_SLOTS:
+    void pause();
+    void resume();
 
 Q_SIGNALS:
     void initialized();
     void notified();
     void stateChanged(State state, State oldState);
+    void propertySnapshotChanged();
 
 protected:
     enum ConstructorType {DefaultConstructor, ConstructWithNode};
@@ -92,6 +105,7 @@ protected:
     virtual void initialize();
     void send(QMetaObject::Call call, int index, const QVariantList &args);
     QRemoteObjectPendingCall sendWithReply(QMetaObject::Call call, int index, const QVariantList &args);
+    QRemoteObjectPendingCall sendWithCachedReply(int index, const QVariantList &args, int ttl, int invalidatingSignal);
 
 protected:
     void setProperties(const QVariantList &);
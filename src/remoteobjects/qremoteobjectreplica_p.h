@@ -57,8 +57,10 @@
 
 #include "qremoteobjectpacket_p.h"
 
+#include <QtCore/qcache.h>
 #include <QtCore/qcompilerdetection.h>
 #include <QtCore/qdatastream.h>
+#include <QtCore/qdeadlinetimer.h>
 #include <QtCore/qpointer.h>
 #include <QtCore/qtimer.h>
 
@@ -67,6 +69,7 @@ QT_BEGIN_NAMESPACE
 class QRemoteObjectReplica;
 class QRemoteObjectSource;
 class IoDeviceBase;
+class QRemoteObjectReplyCacheInvalidator;
 
 class QReplicaImplementationInterface
 {
@@ -79,9 +82,21 @@ public:
     virtual QRemoteObjectReplica::State state() const = 0;
     virtual bool waitForSource(int) = 0;
     virtual QRemoteObjectNode *node() const = 0;
+    // Only connected replicas can be paused
+    virtual void setPaused(bool) {}
+    virtual bool isPaused() const { return false; }
+    // Only connected replicas send calls in batches, the others run calls
+    // when they are made
+    virtual void beginBatch() {}
+    virtual QRemoteObjectPendingCall submitBatch() { return QRemoteObjectPendingCall::fromCompletedCall(QVariant()); }
 
     virtual void _q_send(QMetaObject::Call call, int index, const QVariantList &args) = 0;
     virtual QRemoteObjectPendingCall _q_sendWithReply(QMetaObject::Call call, int index, const QVariantList &args) = 0;
+    // Only connected replicas cache replies, the others run every call
+    virtual QRemoteObjectPendingCall _q_sendWithCachedReply(int index, const QVariantList &args, int, int)
+    {
+        return _q_sendWithReply(QMetaObject::InvokeMetaMethod, index, args);
+    }
 };
 
 class QStubReplicaImplementation final : public QReplicaImplementationInterface
@@ -121,11 +136,22 @@ public:
     bool waitForSource(int) override { return true; }
     virtual bool waitForFinished(const QRemoteObjectPendingCall &, int) { return true; }
     virtual void notifyAboutReply(int, const QVariant &) {}
+    virtual void notifyAboutError(int) {}
+    virtual void notifyAboutBatchReply(int, const QList<QRemoteObjectPackets::BatchResult> &) {}
     virtual void configurePrivate(QRemoteObjectReplica *);
     void emitInitialized();
     void emitNotified();
+    void emitPropertySnapshotChanged();
     QRemoteObjectNode *node() const override { return m_node; }
 
+    virtual QVariantMap propertySnapshot();
+    void updatePropertySnapshot(int i);
+    void resetPropertySnapshot();
+    // Between the two, propertySnapshotChanged() is emitted once at the end,
+    // e.g. for a packet changing many properties
+    void holdPropertySnapshotChanged();
+    void releasePropertySnapshotChanged();
+
     void _q_send(QMetaObject::Call call, int index, const QVariantList &args) override = 0;
     QRemoteObjectPendingCall _q_sendWithReply(QMetaObject::Call call, int index, const QVariantList &args) override = 0;
 
@@ -144,6 +170,12 @@ public:
     QRemoteObjectNode *m_node;
     QByteArray m_objectSignature;
     QAtomicInt m_state;
+
+    // Built on first use, then kept current by updatePropertySnapshot()
+    QVariantMap m_propertySnapshot;
+    bool m_hasPropertySnapshot = false;
+    int m_snapshotChangedHolds = 0;
+    bool m_snapshotChangedHeld = false;
 };
 
 class QConnectedReplicaImplementation final : public QRemoteObjectReplicaImplementation
@@ -165,14 +197,47 @@ public:
     QRemoteObjectPendingCall sendCommandWithReply(int serialId);
     bool waitForFinished(const QRemoteObjectPendingCall &call, int timeout) override;
     void notifyAboutReply(int ackedSerialId, const QVariant &value) override;
+    // The host didn't run the call
+    void notifyAboutError(int ackedSerialId) override;
+    void notifyAboutBatchReply(int ackedSerialId, const QList<QRemoteObjectPackets::BatchResult> &results) override;
+    void finishPendingCall(QRemoteObjectPendingCall &call, QRemoteObjectPendingCall::Error error, const QVariant &value);
     void setConnection(IoDeviceBase *conn);
     void setDisconnected();
 
+    // Sequence numbers of a sequenced connection, false if the packet is a duplicate
+    bool checkSequence(quint32 sequence);
+    void checkReplySequence(quint32 sequence);
+    void resetSequence(quint32 sequence);
+    void requestResync();
+    // The host multicasts property changes to groupUrl, in datagrams carrying
+    // sourceId; sequence numbers restart
+    void setMulticastGroup(const QUrl &groupUrl, quint64 sourceId);
+    // False if the datagram is a duplicate, resyncs on gaps
+    bool checkMulticastSequence(quint32 sequence);
+    // Resyncs if the last sequence number of the source was not received
+    void checkMulticastHeartbeat(quint32 sequence);
+    // True if the last setProperty() left property i as it was
+    bool takeUnchangedProperty(int i);
+
+    void setPaused(bool paused) override;
+    bool isPaused() const override { return m_paused; }
+    // The host sent the missed updates after a resume
+    void resumed();
+    // Child objects share the listener of their root on the host
+    void setPausedState(bool paused, bool resumePending);
+
+    void beginBatch() override;
+    QRemoteObjectPendingCall submitBatch() override;
+
     void _q_send(QMetaObject::Call call, int index, const QVariantList &args) override;
     QRemoteObjectPendingCall _q_sendWithReply(QMetaObject::Call call, int index, const QVariantList& args) override;
+    QRemoteObjectPendingCall _q_sendWithCachedReply(int index, const QVariantList &args, int ttl, int invalidatingSignal) override;
+    // Drops the replies invalidated by the signal, all of them for -1
+    void invalidateCachedReplies(int signalIndex = -1);
 
     void setDynamicMetaObject(const QMetaObject *meta) override;
     void setDynamicProperties(const QVariantList&) override;
+    QVariantMap propertySnapshot() override;
     QList<QRemoteObjectReplica *> m_parentsNeedingConnect;
     QVariantList m_propertyStorage;
     QList<int> m_childIndices;
@@ -183,6 +248,50 @@ public:
     QHash<int, QRemoteObjectPendingCall> m_pendingCalls;
     QRemoteObjectPackets::DataStreamPacket m_packet;
     QTimer m_heartbeatTimer;
+
+    quint32 m_lastSequence = 0; // 0 until known
+    bool m_resyncPending = false;
+    int m_unchangedProperty = -1;
+    bool m_paused = false;
+    // Until the host acknowledged the resume, sequence numbers have gaps
+    bool m_resumePending = false;
+    QUrl m_multicastUrl;
+    quint64 m_multicastId = 0;
+    quint32 m_lastMulticastSequence = 0; // 0 until the first datagram
+
+    // Calls made since beginBatch(), and the pending calls returned for them;
+    // null for calls without reply
+    bool m_batching = false;
+    QList<QRemoteObjectPackets::BatchCall> m_batch;
+    QList<QRemoteObjectPendingCall> m_batchCalls;
+    // Pending calls of the calls of submitted batches, by serial id of the batch
+    QHash<int, QList<QRemoteObjectPendingCall>> m_submittedBatches;
+
+    // Replies of cached slots by slot index and arguments. Calls in flight are
+    // cached as well, so identical calls share one pending call.
+    struct CachedReply
+    {
+        QRemoteObjectPendingCall call;
+        QDeadlineTimer expiry; // forever while in flight or without ttl
+        int invalidatingSignal;
+    };
+    QCache<QByteArray, CachedReply> m_replyCache;
+    QHash<int, QRemoteObjectReplyCacheInvalidator *> m_cacheInvalidators;
+};
+
+// Connected to a signal of a replica, drops the replies the signal invalidates
+class QRemoteObjectReplyCacheInvalidator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QRemoteObjectReplyCacheInvalidator(QConnectedReplicaImplementation *replica, int signalIndex);
+
+public Q_SLOTS:
+    void invalidate();
+
+private:
+    QConnectedReplicaImplementation *m_replica;
+    int m_signalIndex;
 };
 
 class QInProcessReplicaImplementation final : public QRemoteObjectReplicaImplementation
@@ -195,6 +304,7 @@ public:
     void setProperties(const QVariantList &) override;
     void setProperty(int i, const QVariant &) override;
     bool isShortCircuit() const final { return true; }
+    QVariantMap propertySnapshot() override;
 
     void _q_send(QMetaObject::Call call, int index, const QVariantList &args) override;
     QRemoteObjectPendingCall _q_sendWithReply(QMetaObject::Call call, int index, const QVariantList& args) override;
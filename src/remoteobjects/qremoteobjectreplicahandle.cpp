@@ -0,0 +1,248 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtRemoteObjects module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qremoteobjectreplicahandle.h"
+
+#include "qremoteobjectnode.h"
+#include "qremoteobjectnode_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QRemoteObjectReplicaObserver
+    \inmodule QtRemoteObjects
+    \since 6.2
+    \brief The QRemoteObjectReplicaObserver class is notified about changes of
+    the Sources watched through QRemoteObjectReplicaHandle instances.
+
+    Reimplement the functions for the notifications you need. The default
+    implementations do nothing. The observer must outlive the handles it was
+    passed for.
+
+    \sa QRemoteObjectNode::acquireHandle()
+*/
+
+/*!
+    Destroys the observer.
+*/
+QRemoteObjectReplicaObserver::~QRemoteObjectReplicaObserver()
+{
+}
+
+/*!
+    Called when \a handle received the initial property values of its Source.
+    This happens again after the Source was lost and found again.
+*/
+void QRemoteObjectReplicaObserver::initialized(const QRemoteObjectReplicaHandle &handle)
+{
+    Q_UNUSED(handle);
+}
+
+/*!
+    Called when property \a index of the Source of \a handle changed to
+    \a value. The index counts from the first property of the Source's type,
+    see QRemoteObjectReplicaHandle::property().
+*/
+void QRemoteObjectReplicaObserver::propertyChanged(const QRemoteObjectReplicaHandle &handle, int index, const QVariant &value)
+{
+    Q_UNUSED(handle);
+    Q_UNUSED(index);
+    Q_UNUSED(value);
+}
+
+/*!
+    Called when the Source of \a handle emitted a signal with \a arguments.
+    \a index is the index of the signal in
+    QRemoteObjectReplicaHandle::metaObject(), counted from its method offset.
+    The notify signals of properties are reported through propertyChanged()
+    instead.
+*/
+void QRemoteObjectReplicaObserver::signalEmitted(const QRemoteObjectReplicaHandle &handle, int index, const QVariantList &arguments)
+{
+    Q_UNUSED(handle);
+    Q_UNUSED(index);
+    Q_UNUSED(arguments);
+}
+
+/*!
+    Called when the Source of \a handle was removed or its host became
+    unreachable. The last property values stay available, and the handle is
+    initialized again if the Source comes back.
+*/
+void QRemoteObjectReplicaObserver::sourceLost(const QRemoteObjectReplicaHandle &handle)
+{
+    Q_UNUSED(handle);
+}
+
+/*!
+    \class QRemoteObjectReplicaHandle
+    \inmodule QtRemoteObjects
+    \since 6.2
+    \brief The QRemoteObjectReplicaHandle class is a lightweight, read-only
+    view of a Source.
+
+    A handle is a small value that refers to an entry in a table owned by the
+    QRemoteObjectNode that acquired it. Unlike a QRemoteObjectReplica, it is not
+    a QObject, has no timers, and doesn't support calling slots or writing
+    properties. The entry only holds the name of the Source, the property
+    values and pointers to the observer and to the type information, which
+    is shared by all Sources of the same type. This makes handles suitable
+    for tools that watch a very large number of Sources.
+
+    Changes are delivered to the QRemoteObjectReplicaObserver given to
+    QRemoteObjectNode::acquireHandle(). Properties holding a pointer to a
+    QObject are not acquired as child replicas, their value is an invalid
+    QVariant.
+
+    A node can't have a replica and a handle for the same Source. Copies of
+    a handle refer to the same entry. The entry lives until
+    release() is called on any of them or the node is destroyed, after which
+    all copies are invalid.
+*/
+
+/*!
+    \fn QRemoteObjectReplicaHandle::QRemoteObjectReplicaHandle()
+
+    Constructs an invalid handle.
+*/
+
+static QRemoteObjectNodePrivate::HandleEntry *handleEntry(const QPointer<QRemoteObjectNode> &node, int slot, quint32 generation)
+{
+    if (!node)
+        return nullptr;
+    auto d = static_cast<QRemoteObjectNodePrivate *>(QObjectPrivate::get(node.data()));
+    return d->handleEntry(slot, generation);
+}
+
+/*!
+    Returns \c true if this handle refers to an acquired Source that wasn't
+    released.
+*/
+bool QRemoteObjectReplicaHandle::isValid() const
+{
+    return handleEntry(m_node, m_slot, m_generation) != nullptr;
+}
+
+/*!
+    Returns \c true if the handle received the property values of its Source,
+    and the Source wasn't lost since.
+*/
+bool QRemoteObjectReplicaHandle::isInitialized() const
+{
+    const auto entry = handleEntry(m_node, m_slot, m_generation);
+    return entry && entry->initialized;
+}
+
+/*!
+    Returns the name of the Source.
+*/
+QString QRemoteObjectReplicaHandle::name() const
+{
+    const auto entry = handleEntry(m_node, m_slot, m_generation);
+    return entry ? entry->name : QString();
+}
+
+/*!
+    Returns the meta-object describing the type of the Source, or \c nullptr
+    while the type isn't known to the node. It is shared by all handles and dynamic
+    replicas of the same type acquired by the node.
+*/
+const QMetaObject *QRemoteObjectReplicaHandle::metaObject() const
+{
+    const auto entry = handleEntry(m_node, m_slot, m_generation);
+    return entry ? entry->meta : nullptr;
+}
+
+/*!
+    Returns the number of properties of the Source, or 0 if the handle wasn't
+    initialized yet. The values of a lost Source are kept until it is back.
+*/
+int QRemoteObjectReplicaHandle::propertyCount() const
+{
+    const auto entry = handleEntry(m_node, m_slot, m_generation);
+    return entry ? int(entry->values.size()) : 0;
+}
+
+/*!
+    Returns the value of property \a index, counted from the first property
+    of the Source's type (that is, from the property offset of metaObject()).
+*/
+QVariant QRemoteObjectReplicaHandle::property(int index) const
+{
+    const auto entry = handleEntry(m_node, m_slot, m_generation);
+    if (!entry || index < 0 || index >= entry->values.size())
+        return QVariant();
+    return entry->values.at(index);
+}
+
+/*!
+    \overload
+
+    Returns the value of the property called \a name.
+*/
+QVariant QRemoteObjectReplicaHandle::property(const char *name) const
+{
+    const auto entry = handleEntry(m_node, m_slot, m_generation);
+    if (!entry || !entry->meta)
+        return QVariant();
+    return property(entry->meta->indexOfProperty(name) - entry->meta->propertyOffset());
+}
+
+/*!
+    Returns the values of all properties of the Source.
+*/
+QVariantList QRemoteObjectReplicaHandle::properties() const
+{
+    const auto entry = handleEntry(m_node, m_slot, m_generation);
+    return entry ? entry->values : QVariantList();
+}
+
+/*!
+    Stops watching the Source and frees the node's entry. This handle and all
+    its copies become invalid.
+*/
+void QRemoteObjectReplicaHandle::release()
+{
+    if (!isValid())
+        return;
+    auto d = static_cast<QRemoteObjectNodePrivate *>(QObjectPrivate::get(m_node.data()));
+    d->releaseHandle(m_slot);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtRemoteObjects module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QREMOTEOBJECTREPLICAHANDLE_H
+#define QREMOTEOBJECTREPLICAHANDLE_H
+
+#include <QtRemoteObjects/qtremoteobjectglobal.h>
+
+#include <QtCore/qpointer.h>
+#include <QtCore/qvariant.h>
+
+QT_BEGIN_NAMESPACE
+
+class QRemoteObjectNode;
+class QRemoteObjectReplicaHandle;
+
+class Q_REMOTEOBJECTS_EXPORT QRemoteObjectReplicaObserver
+{
+public:
+    virtual ~QRemoteObjectReplicaObserver();
+
+    virtual void initialized(const QRemoteObjectReplicaHandle &handle);
+    virtual void propertyChanged(const QRemoteObjectReplicaHandle &handle, int index, const QVariant &value);
+    virtual void signalEmitted(const QRemoteObjectReplicaHandle &handle, int index, const QVariantList &arguments);
+    virtual void sourceLost(const QRemoteObjectReplicaHandle &handle);
+};
+
+class Q_REMOTEOBJECTS_EXPORT QRemoteObjectReplicaHandle
+{
+public:
+    QRemoteObjectReplicaHandle() = default;
+
+    bool isValid() const;
+    bool isInitialized() const;
+    QString name() const;
+    const QMetaObject *metaObject() const;
+    int propertyCount() const;
+    QVariant property(int index) const;
+    QVariant property(const char *name) const;
+    QVariantList properties() const;
+    void release();
+
+    friend bool operator==(const QRemoteObjectReplicaHandle &lhs, const QRemoteObjectReplicaHandle &rhs)
+    { return lhs.m_node == rhs.m_node && lhs.m_slot == rhs.m_slot && lhs.m_generation == rhs.m_generation; }
+    friend bool operator!=(const QRemoteObjectReplicaHandle &lhs, const QRemoteObjectReplicaHandle &rhs)
+    { return !(lhs == rhs); }
+
+private:
+    friend class QRemoteObjectNode;
+    friend class QRemoteObjectNodePrivate;
+    QRemoteObjectReplicaHandle(QRemoteObjectNode *node, int slot, quint32 generation)
+        : m_node(node), m_slot(slot), m_generation(generation) {}
+
+    // The node's table entry, which is reused once the handle was released
+    QPointer<QRemoteObjectNode> m_node;
+    int m_slot = -1;
+    quint32 m_generation = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -47,8 +47,15 @@
 #include "qremoteobjectabstractitemmodeladapter_p.h"
 
 #include <QtCore/qmetaobject.h>
+#include <QtCore/private/qmetaobject_p.h>
+#include <QtCore/qmutex.h>
 #include <QtCore/qvarlengtharray.h>
 #include <QtCore/qabstractitemmodel.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qrandom.h>
+#if QT_CONFIG(sharedmemory)
+#include <QtCore/qsharedmemory.h>
+#endif
 
 #include <algorithm>
 #include <iterator>
@@ -158,7 +165,10 @@ QRemoteObjectRootSource::QRemoteObjectRootSource(QObject *obj, const SourceApiMa
                                                  QObject *adapter, QRemoteObjectSourceIo *sourceIo)
     : QRemoteObjectSourceBase(obj, new Private(sourceIo, this), api, adapter)
     , m_name(api->name())
+    , m_multicastId(QRandomGenerator::global()->generate64())
 {
+    m_multicastHeartbeat.setInterval(multicastHeartbeatInterval);
+    connect(&m_multicastHeartbeat, &QTimer::timeout, this, [this]() { sendMulticastHeartbeat(); });
     d->m_sourceIo->registerSource(this);
 }
 
@@ -221,7 +231,7 @@ void QRemoteObjectSourceBase::resetObject(QObject *newObject)
     // have been replaced with real objects.  In this case, the ApiMap could be wrong and need updating.
     if (newObject && qobject_cast<QRemoteObjectDynamicReplica *>(newObject) && m_api->isDynamic()) {
         auto api = static_cast<const DynamicApiMap*>(m_api);
-        if (api->m_properties[0] == 0) { // 0 is an index into QObject itself, so this isn't a valid QtRO index
+        if (api->m_tables->properties[0] == 0) { // 0 is an index into QObject itself, so this isn't a valid QtRO index
             const auto rep = qobject_cast<QRemoteObjectDynamicReplica *>(newObject);
             auto tmp = m_api;
             m_api = new DynamicApiMap(newObject, rep->metaObject(), api->m_name, QLatin1String(rep->metaObject()->className()));
@@ -382,14 +392,80 @@ void QRemoteObjectSourceBase::handleMetaCall(int index, QMetaObject::Call call,
         return;
 
     int propertyIndex = m_api->propertyIndexFromSignal(index);
+    // Listeners reading shared state get the root object's properties with the
+    // page, everything else is sent after a scheduled page update to keep the order
+    QRemoteObjectRootSource *root = d->root;
+    const bool rootProperty = propertyIndex >= 0 && isRoot() && !m_children.contains(m_api->propertyRawIndexFromSignal(index));
+    // Replicas emit the NOTIFY signal of a value read from the page themselves,
+    // which they can only do if the signal carries nothing but the value
+    bool notifiesValueOnly = rootProperty && m_api->signalParameterCount(index) == 0;
+    if (rootProperty && m_api->signalParameterCount(index) == 1) {
+        const int internalIndex = m_api->propertyRawIndexFromSignal(index);
+        const auto target = m_api->isAdapterProperty(internalIndex) ? m_adapter : m_object;
+        notifiesValueOnly = m_api->signalParameterType(index, 0) == target->metaObject()->property(propertyIndex).metaType().id();
+    }
+    const bool sharedProperty = notifiesValueOnly && root->m_sharedStateListeners > 0;
+    // Only the changed properties are serialized for the page again
+    if (rootProperty && root->m_sharedStateListeners > 0)
+        root->m_sharedStateChanged.insert(m_api->propertyRawIndexFromSignal(index));
+    const bool multicastProperty = rootProperty && !root->m_multicastListeners.isEmpty();
+    if (!sharedProperty)
+        root->flushSharedState();
+    // Paused listeners get the current values of the properties they missed
+    // on resume, other signals are still sent to them
+    const bool skipPaused = propertyIndex >= 0 && !d->pausedListeners.isEmpty();
+    if (skipPaused) {
+        const QPair<QPointer<QRemoteObjectSourceBase>, int> missed(this, index);
+        for (auto &missedSignals : d->pausedListeners) {
+            if (!missedSignals.contains(missed))
+                missedSignals.append(missed);
+        }
+        if (d->pausedListeners.size() == d->m_listeners.size())
+            return;
+    }
+    bool unchangedProperty = false;
     if (propertyIndex >= 0) {
         const int internalIndex = m_api->propertyRawIndexFromSignal(index);
         const auto target = m_api->isAdapterProperty(internalIndex) ? m_adapter : m_object;
         const QMetaProperty mp = target->metaObject()->property(propertyIndex);
-        qCDebug(QT_REMOTEOBJECT) << "Sending Invoke Property" << (m_api->isAdapterSignal(internalIndex) ? "via adapter" : "") << internalIndex << propertyIndex << mp.name() << mp.read(target);
-
-        serializePropertyChangePacket(this, index);
-        d->m_packet.baseAddress = d->m_packet.size;
+        // A NOTIFY signal carrying only the new value saves reading the property again.
+        // With more parameters, the first one isn't necessarily the value.
+        QVariant value;
+        const int valueType = m_api->signalParameterCount(index) == 1 ? m_api->signalParameterType(index, 0) : QMetaType::UnknownType;
+        if (valueType == QMetaType::QVariant && mp.metaType().id() == QMetaType::QVariant)
+            value = *reinterpret_cast<QVariant *>(a[1]);
+        else if (valueType != QMetaType::UnknownType && valueType == mp.metaType().id())
+            value = QVariant(mp.metaType(), a[1]);
+        else
+            value = mp.read(target);
+        qCDebug(QT_REMOTEOBJECT) << "Sending Invoke Property" << (m_api->isAdapterSignal(internalIndex) ? "via adapter" : "") << internalIndex << propertyIndex << mp.name() << value;
+
+        serializePropertyChangePacket(this, index, value);
+        // The property change is not sent if the listeners already have this
+        // value, the signal still is. Pointer properties are sent every time,
+        // the child source behind them may be new.
+        if (!mp.metaType().flags().testFlag(QMetaType::PointerToQObject)) {
+            if (m_lastSentGeneration != d->listenerGeneration) {
+                m_lastSent.clear();
+                m_lastSentGeneration = d->listenerGeneration;
+            }
+            const size_t hash = qHashBits(d->m_packet.array.constData(), size_t(d->m_packet.size));
+            const auto it = m_lastSent.constFind(internalIndex);
+            unchangedProperty = it != m_lastSent.cend() && *it == hash;
+            if (!unchangedProperty)
+                m_lastSent.insert(internalIndex, hash);
+        }
+        if (unchangedProperty) {
+            // Shared state readers don't see a change on the page, they get the signal as well
+            qCDebug(QT_REMOTEOBJECT) << "Skipping unchanged property" << mp.name();
+        } else {
+            if (sharedProperty) {
+                root->scheduleSharedState();
+                if (root->m_sharedStateListeners == d->m_listeners.size())
+                    return;
+            }
+            d->m_packet.baseAddress = d->m_packet.size;
+        }
         propertyIndex = internalIndex;
     }
 
@@ -400,29 +476,84 @@ void QRemoteObjectSourceBase::handleMetaCall(int index, QMetaObject::Call call,
 
     serializeInvokePacket(d->m_packet, name(), call, index, *marshalArgs(index, a), -1, propertyIndex);
     d->m_packet.baseAddress = 0;
+    const bool multicast = multicastProperty && root->sendMulticast(d->m_packet.array, d->m_packet.size);
 
-    for (IoDeviceBase *io : qAsConst(d->m_listeners))
-        io->write(d->m_packet.array, d->m_packet.size);
+    QByteArray sequenced;
+    for (IoDeviceBase *io : qAsConst(d->m_listeners)) {
+        if (skipPaused && d->pausedListeners.contains(io))
+            continue;
+        if (sharedProperty && !unchangedProperty && io->readsSharedState())
+            continue;
+        if (multicast && root->m_multicastListeners.contains(io))
+            continue;
+        if (!io->isSequenced()) {
+            io->write(d->m_packet.array, d->m_packet.size);
+            continue;
+        }
+        // Numbered once, all sequenced listeners see the same numbers
+        if (sequenced.isEmpty())
+            sequenced = sequencedPackets(d->m_packet.array, d->m_packet.size, m_sequence);
+        io->write(sequenced);
+    }
+}
+
+void QRemoteObjectSourceBase::writeSequenced(IoDeviceBase *io, const QByteArray &data, qint64 size)
+{
+    if (io->isSequenced())
+        io->write(sequencedPackets(data, size, m_sequence, false));
+    else
+        io->write(data, size);
+}
+
+void QRemoteObjectSourceBase::writePropertyChange(IoDeviceBase *io, int index)
+{
+    const int internalIndex = m_api->propertyRawIndexFromSignal(index);
+    const auto target = m_api->isAdapterProperty(internalIndex) ? m_adapter : m_object;
+    const QMetaProperty mp = target->metaObject()->property(m_api->propertyIndexFromSignal(index));
+    serializePropertyChangePacket(this, index, mp.read(target));
+    d->m_packet.baseAddress = d->m_packet.size;
+    // Without arguments, the replica emits the notify signal with its new value
+    serializeInvokePacket(d->m_packet, name(), QMetaObject::InvokeMetaMethod, index, {}, -1, internalIndex);
+    d->m_packet.baseAddress = 0;
+    // Not numbered, other listeners don't get these packets
+    writeSequenced(io, d->m_packet.array, d->m_packet.size);
 }
 
 void QRemoteObjectRootSource::addListener(IoDeviceBase *io, bool dynamic)
 {
     d->m_listeners.append(io);
     d->isDynamic = d->isDynamic || dynamic;
+    ++d->listenerGeneration;
 
+    // Init packets carry the current sequence number, the replica continues from it
     if (dynamic) {
         d->sentTypes.clear();
         serializeInitDynamicPacket(d->m_packet, this);
-        io->write(d->m_packet.array, d->m_packet.size);
+        writeSequenced(io, d->m_packet.array, d->m_packet.size);
     } else {
         serializeInitPacket(d->m_packet, this);
-        io->write(d->m_packet.array, d->m_packet.size);
+        writeSequenced(io, d->m_packet.array, d->m_packet.size);
+    }
+    // The page holds the values the init packet had
+    if (io->readsSharedState()) {
+        ++m_sharedStateListeners;
+        publishSharedState(io);
+    } else if (!io->isSequenced() && d->m_sourceIo->m_multicastConnections.contains(io)) {
+        // Property changes go to the group once the node joined it
+        const QUrl groupUrl = d->m_sourceIo->m_multicastUrls.value(m_name);
+        if (!groupUrl.isEmpty()) {
+            serializeMulticastPacket(d->m_packet, m_name, groupUrl, m_multicastId);
+            io->write(d->m_packet.array, d->m_packet.size);
+        }
     }
 }
 
 int QRemoteObjectRootSource::removeListener(IoDeviceBase *io, bool shouldSendRemove)
 {
-    d->m_listeners.removeAll(io);
+    if (d->m_listeners.removeAll(io) && io->readsSharedState() && --m_sharedStateListeners == 0)
+        releaseSharedState();
+    m_multicastListeners.remove(io);
+    d->pausedListeners.remove(io);
     if (shouldSendRemove)
     {
         serializeRemoveObjectPacket(d->m_packet, m_api->name());
@@ -431,6 +562,168 @@ int QRemoteObjectRootSource::removeListener(IoDeviceBase *io, bool shouldSendRem
     return int(d->m_listeners.length());
 }
 
+void QRemoteObjectRootSource::releaseSharedState()
+{
+#if QT_CONFIG(sharedmemory)
+    m_sharedState.reset();
+#endif
+    m_sharedStateBuffer.clear();
+    m_sharedStateValues.clear();
+    m_sharedStateChanged.clear();
+    m_sharedStatePending = false;
+    m_sharedStateUnavailable = false;
+}
+
+void QRemoteObjectRootSource::stopSharedState(IoDeviceBase *io)
+{
+    if (!d->m_listeners.contains(io))
+        return;
+    // The values the node couldn't read are sent along, as without a page
+    updateSharedStateValues(true);
+    QByteArray state;
+    serializeSharedState(state, m_sharedStateValues);
+    if (--m_sharedStateListeners == 0)
+        releaseSharedState();
+    serializeSharedStatePacket(d->m_packet, m_name, QString(), state);
+    io->write(d->m_packet.array, d->m_packet.size);
+}
+
+void QRemoteObjectRootSource::updateSharedStateValues(bool all)
+{
+    const auto update = [this](int internalIndex) {
+        QByteArray data;
+        serializeSharedStateValue(data, this, internalIndex);
+        SharedStateValue &value = m_sharedStateValues[internalIndex];
+        // Readers skip a value that keeps its version
+        if (value.version && value.data == data)
+            return;
+        value.data = std::move(data);
+        m_sharedStateVersion = nextSequence(m_sharedStateVersion);
+        value.version = m_sharedStateVersion;
+    };
+    if (all) {
+        // Child sources are sent with packets, their listeners are tracked per root
+        for (int internalIndex = 0; internalIndex < m_api->propertyCount(); ++internalIndex) {
+            if (!m_children.contains(internalIndex))
+                update(internalIndex);
+        }
+    } else {
+        for (int internalIndex : qAsConst(m_sharedStateChanged))
+            update(internalIndex);
+    }
+    m_sharedStateChanged.clear();
+}
+
+void QRemoteObjectRootSource::scheduleSharedState()
+{
+    if (m_sharedStatePending)
+        return;
+    // Changes made in one pass of the event loop are published together
+    m_sharedStatePending = true;
+    QMetaObject::invokeMethod(this, [this]() { flushSharedState(); }, Qt::QueuedConnection);
+}
+
+void QRemoteObjectRootSource::publishSharedState(IoDeviceBase *io)
+{
+    if (!io)
+        m_sharedStatePending = false;
+    if (m_sharedStateListeners == 0)
+        return;
+
+    // A new reader needs every value, so all of them are brought up to date.
+    // Otherwise only the properties changed since the last update are.
+    updateSharedStateValues(io != nullptr);
+    if (!io && m_sharedStateVersion == m_sharedStatePublished)
+        return;
+    QString key;
+#if QT_CONFIG(sharedmemory)
+    if (!m_sharedStateUnavailable) {
+        // The page holds every value, readers decode the ones of a new version
+        serializeSharedState(m_sharedStateBuffer, m_sharedStateValues);
+        const qsizetype pageSize = qsizetype(sizeof(SharedStateHeader)) + m_sharedStateBuffer.size();
+        if (!m_sharedState || m_sharedState->size() < pageSize) {
+            // Readers attach to the new page with the next notification, the old
+            // one goes away when the last of them detached
+            QScopedPointer<QSharedMemory> page(new QSharedMemory(QStringLiteral("qtro_%1_%2_%3")
+                                                                 .arg(QCoreApplication::applicationPid())
+                                                                 .arg(quintptr(this), 0, 16)
+                                                                 .arg(++m_sharedStatePages)));
+            // Leave room for the values to grow
+            if (page->create(qMax(2 * pageSize, qsizetype(4096)))) {
+                memset(page->data(), 0, sizeof(SharedStateHeader));
+                m_sharedState.swap(page);
+            } else {
+                qCWarning(QT_REMOTEOBJECT) << "Can't create shared state page for" << m_name << page->errorString();
+                m_sharedState.reset();
+                m_sharedStateUnavailable = true;
+            }
+        }
+        if (m_sharedState && writeSharedState(m_sharedState->data(), m_sharedState->size(), m_sharedStateBuffer))
+            key = m_sharedState->key();
+    }
+#endif
+    // Without a page, the values are sent with the packet: all of them to a
+    // new reader, the ones changed since the last update to the others
+    QByteArray state;
+    if (key.isEmpty())
+        serializeSharedState(state, m_sharedStateValues, io ? 0 : m_sharedStatePublished);
+    serializeSharedStatePacket(d->m_packet, m_name, key, state);
+    if (io) {
+        io->write(d->m_packet.array, d->m_packet.size);
+        return;
+    }
+    m_sharedStatePublished = m_sharedStateVersion;
+    for (IoDeviceBase *listener : qAsConst(d->m_listeners)) {
+        // Paused listeners get what they missed on resume
+        if (listener->readsSharedState() && !d->pausedListeners.contains(listener))
+            listener->write(d->m_packet.array, d->m_packet.size);
+    }
+}
+
+bool QRemoteObjectRootSource::sendMulticast(const QByteArray &data, qint64 size)
+{
+    // Numbered per source, replicas resync when they see a gap
+    const QUrl groupUrl = d->m_sourceIo->m_multicastUrls.value(m_name);
+    if (!d->m_sourceIo->writeMulticast(groupUrl, multicastDatagram(m_name, m_multicastId, nextSequence(m_multicastSequence), data, size)))
+        return false;
+    m_multicastSequence = nextSequence(m_multicastSequence);
+    m_multicastHeartbeatsLeft = multicastHeartbeatCount;
+    if (!m_multicastHeartbeat.isActive())
+        m_multicastHeartbeat.start();
+    return true;
+}
+
+void QRemoteObjectRootSource::sendMulticastHeartbeat()
+{
+    const QUrl groupUrl = d->m_sourceIo->m_multicastUrls.value(m_name);
+    if (m_multicastHeartbeatsLeft <= 0 || m_multicastListeners.isEmpty() || groupUrl.isEmpty()) {
+        m_multicastHeartbeat.stop();
+        return;
+    }
+    --m_multicastHeartbeatsLeft;
+    d->m_sourceIo->writeMulticast(groupUrl, multicastDatagram(m_name, m_multicastId, m_multicastSequence, {}, 0));
+}
+
+void QRemoteObjectRootSource::pauseListener(IoDeviceBase *io)
+{
+    if (d->m_listeners.contains(io) && !d->pausedListeners.contains(io))
+        d->pausedListeners.insert(io, {});
+}
+
+void QRemoteObjectRootSource::resumeListener(IoDeviceBase *io)
+{
+    const auto missedSignals = d->pausedListeners.take(io);
+    // What was last sent to the other listeners is not what io has now
+    if (!missedSignals.isEmpty())
+        ++d->listenerGeneration;
+    for (const auto &missed : missedSignals) {
+        if (missed.first)
+            missed.first->writePropertyChange(io, missed.second);
+    }
+    serializeResumePacket(d->m_packet, m_api->name());
+    io->write(d->m_packet.array, d->m_packet.size);
+}
+
 int QRemoteObjectSourceBase::qt_metacall(QMetaObject::Call call, int methodId, void **a)
 {
     methodId = QObject::qt_metacall(call, methodId, a);
@@ -443,56 +736,52 @@ int QRemoteObjectSourceBase::qt_metacall(QMetaObject::Call call, int methodId, v
     return -1;
 }
 
-DynamicApiMap::DynamicApiMap(QObject *object, const QMetaObject *metaObject, const QString &name, const QString &typeName)
-    : m_name(name),
-      m_typeName(typeName),
-      m_metaObject(metaObject),
-      m_cachedMetamethodIndex(-1)
+QSharedPointer<const DynamicApiMap::Tables> DynamicApiMap::tables(const QMetaObject *metaObject)
 {
-    m_enumOffset = metaObject->enumeratorOffset();
-    m_enumCount = metaObject->enumeratorCount() - m_enumOffset;
+    static QMutex mutex;
+    static QHash<const QMetaObject *, QWeakPointer<const Tables>> cache;
+
+    // Metaobjects of dynamic replicas are built at runtime, and another type can get
+    // the address of one that was freed. Only metaobjects built by moc are cached.
+    const bool cacheable = !(QMetaObjectPrivate::get(metaObject)->flags & DynamicMetaObject);
+    QMutexLocker locker(&mutex);
+    if (cacheable) {
+        if (auto cached = cache.value(metaObject).toStrongRef())
+            return cached;
+    }
+
+    auto tables = QSharedPointer<Tables>::create();
+    tables->className = QByteArray(metaObject->className());
+    tables->enumOffset = metaObject->enumeratorOffset();
+    tables->enumCount = metaObject->enumeratorCount() - tables->enumOffset;
 
     const int propCount = metaObject->propertyCount();
     const int propOffset = metaObject->propertyOffset();
-    m_properties.reserve(propCount-propOffset);
+    tables->properties.reserve(propCount-propOffset);
     int i = 0;
     for (i = propOffset; i < propCount; ++i) {
         const QMetaProperty property = metaObject->property(i);
         const auto metaType = property.metaType();
         if (metaType.flags().testFlag(QMetaType::PointerToQObject)) {
-            auto propertyMeta = metaType.metaObject();
-            QObject *child = property.read(object).value<QObject *>();
-            if (propertyMeta->inherits(&QAbstractItemModel::staticMetaObject)) {
+            Tables::PointerProperty pointer{i, false, QByteArray()};
+            if (metaType.metaObject()->inherits(&QAbstractItemModel::staticMetaObject)) {
+                pointer.isModel = true;
                 const QByteArray name = QByteArray::fromRawData(property.name(),
                                                                 qsizetype(qstrlen(property.name())));
                 const QByteArray infoName = name.toUpper() + QByteArrayLiteral("_ROLES");
                 const int infoIndex = metaObject->indexOfClassInfo(infoName.constData());
-                QByteArray roleInfo;
                 if (infoIndex >= 0) {
                     auto ci = metaObject->classInfo(infoIndex);
-                    roleInfo = QByteArray::fromRawData(ci.value(), qsizetype(qstrlen(ci.value())));
-                }
-                m_models << ModelInfo({qobject_cast<QAbstractItemModel *>(child),
-                                       QString::fromLatin1(property.name()),
-                                       roleInfo});
-            } else {
-                const QMetaObject *meta = child ? child->metaObject() : propertyMeta;
-                QString typeName = QtRemoteObjects::getTypeNameAndMetaobjectFromClassInfo(meta);
-                if (typeName.isNull()) {
-                    typeName = QString::fromLatin1(propertyMeta->className());
-                    // TODO better way to ensure we have consistent typenames between source/replicas?
-                    if (typeName.endsWith(QLatin1String("Source")))
-                        typeName.chop(6);
+                    pointer.roleInfo = QByteArray::fromRawData(ci.value(), qsizetype(qstrlen(ci.value())));
                 }
-
-                m_subclasses << new DynamicApiMap(child, meta, QString::fromLatin1(property.name()), typeName);
             }
+            tables->pointerProperties << pointer;
         }
-        m_properties << i;
-        const int notifyIndex = metaObject->property(i).notifySignalIndex();
+        tables->properties << i;
+        const int notifyIndex = property.notifySignalIndex();
         if (notifyIndex != -1) {
-            m_signals << notifyIndex;
-            m_propertyAssociatedWithSignal.append(i-propOffset);
+            tables->signalIndexes << notifyIndex;
+            tables->propertyAssociatedWithSignal.append(i-propOffset);
             //The starting values of _signals will be the notify signals
             //So if we are processing _signal with index i, api->sourcePropertyIndex(_propertyAssociatedWithSignal.at(i))
             //will be the property that changed.  This is only valid if i < _propertyAssociatedWithSignal.size().
@@ -504,60 +793,61 @@ DynamicApiMap::DynamicApiMap(QObject *object, const QMetaObject *metaObject, con
         const QMetaMethod mm = metaObject->method(i);
         const QMetaMethod::MethodType m = mm.methodType();
         if (m == QMetaMethod::Signal) {
-            if (m_signals.indexOf(i) >= 0) //Already added as a property notifier
+            if (tables->signalIndexes.indexOf(i) >= 0) //Already added as a property notifier
                 continue;
-            m_signals << i;
+            tables->signalIndexes << i;
         } else if (m == QMetaMethod::Slot || m == QMetaMethod::Method)
-            m_methods << i;
+            tables->methods << i;
     }
-
-    m_objectSignature = QtPrivate::qtro_classinfo_signature(metaObject);
-}
-
-QByteArrayList DynamicApiMap::signalParameterNames(int index) const
-{
-    const int objectIndex = m_signals.at(index);
-    checkCache(objectIndex);
-    return m_cachedMetamethod.parameterNames();
-}
-
-int DynamicApiMap::parameterCount(int objectIndex) const
-{
-    checkCache(objectIndex);
-    return m_cachedMetamethod.parameterCount();
-}
-
-int DynamicApiMap::parameterType(int objectIndex, int paramIndex) const
-{
-    checkCache(objectIndex);
-    return m_cachedMetamethod.parameterType(paramIndex);
-}
-
-const QByteArray DynamicApiMap::signature(int objectIndex) const
-{
-    checkCache(objectIndex);
-    return m_cachedMetamethod.methodSignature();
-}
-
-QMetaMethod::MethodType DynamicApiMap::methodType(int index) const
-{
-    const int objectIndex = m_methods.at(index);
-    checkCache(objectIndex);
-    return m_cachedMetamethod.methodType();
+    tables->signalMethods.reserve(tables->signalIndexes.size());
+    for (int index : qAsConst(tables->signalIndexes))
+        tables->signalMethods << metaObject->method(index);
+    tables->methodMethods.reserve(tables->methods.size());
+    for (int index : qAsConst(tables->methods))
+        tables->methodMethods << metaObject->method(index);
+
+    tables->objectSignature = QtPrivate::qtro_classinfo_signature(metaObject);
+    if (!cacheable)
+        return tables;
+
+    // Drop the entries of classes no longer remoted while we are at it
+    for (auto it = cache.begin(); it != cache.end(); ) {
+        if (it.value().isNull())
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+    cache.insert(metaObject, tables);
+    return tables;
 }
 
-const QByteArray DynamicApiMap::typeName(int index) const
+DynamicApiMap::DynamicApiMap(QObject *object, const QMetaObject *metaObject, const QString &name, const QString &typeName)
+    : m_name(name),
+      m_typeName(typeName),
+      m_tables(tables(metaObject))
 {
-    const int objectIndex = m_methods.at(index);
-    checkCache(objectIndex);
-    return m_cachedMetamethod.typeName();
-}
+    // Only the children differ between instances
+    for (const auto &pointer : m_tables->pointerProperties) {
+        const QMetaProperty property = metaObject->property(pointer.index);
+        QObject *child = property.read(object).value<QObject *>();
+        if (pointer.isModel) {
+            m_models << ModelInfo({qobject_cast<QAbstractItemModel *>(child),
+                                   QString::fromLatin1(property.name()),
+                                   pointer.roleInfo});
+        } else {
+            const QMetaObject *propertyMeta = property.metaType().metaObject();
+            const QMetaObject *meta = child ? child->metaObject() : propertyMeta;
+            QString typeName = QtRemoteObjects::getTypeNameAndMetaobjectFromClassInfo(meta);
+            if (typeName.isNull()) {
+                typeName = QString::fromLatin1(propertyMeta->className());
+                // TODO better way to ensure we have consistent typenames between source/replicas?
+                if (typeName.endsWith(QLatin1String("Source")))
+                    typeName.chop(6);
+            }
 
-QByteArrayList DynamicApiMap::methodParameterNames(int index) const
-{
-    const int objectIndex = m_methods.at(index);
-    checkCache(objectIndex);
-    return m_cachedMetamethod.parameterNames();
+            m_subclasses << new DynamicApiMap(child, meta, QString::fromLatin1(property.name()), typeName);
+        }
+    }
 }
 
 QT_END_NAMESPACE
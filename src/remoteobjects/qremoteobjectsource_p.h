@@ -55,6 +55,9 @@
 #include <QtCore/qmetaobject.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qpointer.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qtimer.h>
 #include "qremoteobjectsource.h"
 #include "qremoteobjectpacket_p.h"
 
@@ -62,6 +65,7 @@ QT_BEGIN_NAMESPACE
 
 class QRemoteObjectSourceIo;
 class IoDeviceBase;
+class QSharedMemory;
 
 class QRemoteObjectSourceBase : public QObject
 {
@@ -83,6 +87,16 @@ public:
     bool invoke(QMetaObject::Call c, int index, const QVariantList& args, QVariant* returnValue = nullptr);
     QByteArray m_objectChecksum;
     QMap<int, QPointer<QRemoteObjectSourceBase>> m_children;
+    // Last sequence number sent to sequenced listeners
+    quint32 m_sequence = 0;
+    // Writes the packets of data to io, with sequence numbers if io wants them
+    void writeSequenced(IoDeviceBase *io, const QByteArray &data, qint64 size);
+    // Hash of the last PropertyChange packet sent per internal property index,
+    // valid while m_lastSentGeneration matches d->listenerGeneration
+    QHash<int, size_t> m_lastSent;
+    quint32 m_lastSentGeneration = 0;
+    // Sends the current value of the property notified by signal index to io
+    void writePropertyChange(IoDeviceBase *io, int index);
     struct Private {
         Private(QRemoteObjectSourceIo *io, QRemoteObjectRootSource *root) : m_sourceIo(io), isDynamic(false), root(root) {}
         QRemoteObjectSourceIo *m_sourceIo;
@@ -93,6 +107,12 @@ public:
         QSet<QString> sentTypes;
         bool isDynamic;
         QRemoteObjectRootSource *root;
+        // Bumped for every new listener, the values it got with the init packet
+        // are not what was last sent to the others
+        quint32 listenerGeneration = 0;
+        // Listeners whose replica paused, with the property notify signals
+        // (source, signal index) they missed
+        QHash<IoDeviceBase *, QList<QPair<QPointer<QRemoteObjectSourceBase>, int>>> pausedListeners;
     };
     Private *d;
     static const int qobjectPropertyOffset;
@@ -124,97 +144,148 @@ public:
     QString name() const override { return m_name; }
     void addListener(IoDeviceBase *io, bool dynamic = false);
     int removeListener(IoDeviceBase *io, bool shouldSendRemove = false);
+    void pauseListener(IoDeviceBase *io);
+    void resumeListener(IoDeviceBase *io);
+
+    // Writes the property values to the shared state page and tells io about
+    // it, or all listeners reading shared state if io is null
+    void publishSharedState(IoDeviceBase *io = nullptr);
+    void scheduleSharedState();
+    // io can't read the page, it gets the values with the packets from now on
+    void stopSharedState(IoDeviceBase *io);
+    void releaseSharedState();
+    // Publishes a scheduled update before something else is sent
+    void flushSharedState() { if (m_sharedStatePending) publishSharedState(); }
+    // Serializes the changed properties again, or all of them
+    void updateSharedStateValues(bool all);
 
     QString m_name;
+    // Property values for listeners on local sockets, see
+    // QRemoteObjectHostBase::setSharedStateEnabled()
+#if QT_CONFIG(sharedmemory)
+    QScopedPointer<QSharedMemory> m_sharedState;
+#endif
+    QByteArray m_sharedStateBuffer;
+    // The values on the page by internal index, the properties changed since
+    // they were serialized, and the version listeners were last told about
+    QMap<int, QRemoteObjectPackets::SharedStateValue> m_sharedStateValues;
+    QSet<int> m_sharedStateChanged;
+    quint32 m_sharedStateVersion = 0;
+    quint32 m_sharedStatePublished = 0;
+    int m_sharedStateListeners = 0;
+    quint32 m_sharedStatePages = 0;
+    bool m_sharedStatePending = false;
+    // Creating a page failed, the values are sent with the packets
+    bool m_sharedStateUnavailable = false;
+
+    // Sends the packets of a property change to the multicast group of this
+    // source, false if they have to be sent to the listeners
+    bool sendMulticast(const QByteArray &data, qint64 size);
+    // Listeners that joined the group, see QRemoteObjectHostBase::setMulticastUrl()
+    QSet<IoDeviceBase *> m_multicastListeners;
+    quint32 m_multicastSequence = 0;
+    // Sent in every datagram, replicas ignore those of other hosts with a
+    // source of the same name
+    quint64 m_multicastId;
+    // Repeats the last sequence number for a while after a change, so a
+    // replica notices when the last datagrams were lost
+    void sendMulticastHeartbeat();
+    QTimer m_multicastHeartbeat;
+    int m_multicastHeartbeatsLeft = 0;
 };
 
 class DynamicApiMap final : public SourceApiMap
 {
 public:
+    // Everything that only depends on the QMetaObject, built once and shared
+    // by all instances of a class
+    struct Tables
+    {
+        struct PointerProperty
+        {
+            int index;
+            bool isModel;
+            QByteArray roleInfo;
+        };
+
+        QByteArray className;
+        int enumCount;
+        int enumOffset;
+        QList<int> properties;
+        QList<int> signalIndexes;
+        QList<int> methods;
+        QList<int> propertyAssociatedWithSignal;
+        QList<QMetaMethod> signalMethods;
+        QList<QMetaMethod> methodMethods;
+        QList<PointerProperty> pointerProperties;
+        QByteArray objectSignature;
+    };
+    static QSharedPointer<const Tables> tables(const QMetaObject *metaObject);
+
     DynamicApiMap(QObject *object, const QMetaObject *metaObject, const QString &name, const QString &typeName);
     ~DynamicApiMap() override {}
     QString name() const override { return m_name; }
     QString typeName() const override { return m_typeName; }
-    QByteArray className() const override { return QByteArray(m_metaObject->className()); }
-    int enumCount() const override { return m_enumCount; }
-    int propertyCount() const override { return m_properties.size(); }
-    int signalCount() const override { return m_signals.size(); }
-    int methodCount() const override { return m_methods.size(); }
+    QByteArray className() const override { return m_tables->className; }
+    int enumCount() const override { return m_tables->enumCount; }
+    int propertyCount() const override { return m_tables->properties.size(); }
+    int signalCount() const override { return m_tables->signalIndexes.size(); }
+    int methodCount() const override { return m_tables->methods.size(); }
     int sourceEnumIndex(int index) const override
     {
         if (index < 0 || index >= enumCount())
             return -1;
-        return m_enumOffset + index;
+        return m_tables->enumOffset + index;
     }
     int sourcePropertyIndex(int index) const override
     {
         if (index < 0 || index >= propertyCount())
             return -1;
-        return m_properties.at(index);
+        return m_tables->properties.at(index);
     }
     int sourceSignalIndex(int index) const override
     {
         if (index < 0 || index >= signalCount())
             return -1;
-        return m_signals.at(index);
+        return m_tables->signalIndexes.at(index);
     }
     int sourceMethodIndex(int index) const override
     {
         if (index < 0 || index >= methodCount())
             return -1;
-        return m_methods.at(index);
+        return m_tables->methods.at(index);
     }
-    int signalParameterCount(int index) const override { return parameterCount(m_signals.at(index)); }
-    int signalParameterType(int sigIndex, int paramIndex) const override { return parameterType(m_signals.at(sigIndex), paramIndex); }
-    const QByteArray signalSignature(int index) const override { return signature(m_signals.at(index)); }
-    QByteArrayList signalParameterNames(int index) const override;
-
-    int methodParameterCount(int index) const override { return parameterCount(m_methods.at(index)); }
-    int methodParameterType(int methodIndex, int paramIndex) const override { return parameterType(m_methods.at(methodIndex), paramIndex); }
-    const QByteArray methodSignature(int index) const override { return signature(m_methods.at(index)); }
-    QMetaMethod::MethodType methodType(int index) const override;
-    const QByteArray typeName(int index) const override;
-    QByteArrayList methodParameterNames(int index) const override;
+    int signalParameterCount(int index) const override { return m_tables->signalMethods.at(index).parameterCount(); }
+    int signalParameterType(int sigIndex, int paramIndex) const override { return m_tables->signalMethods.at(sigIndex).parameterType(paramIndex); }
+    const QByteArray signalSignature(int index) const override { return m_tables->signalMethods.at(index).methodSignature(); }
+    QByteArrayList signalParameterNames(int index) const override { return m_tables->signalMethods.at(index).parameterNames(); }
+
+    int methodParameterCount(int index) const override { return m_tables->methodMethods.at(index).parameterCount(); }
+    int methodParameterType(int methodIndex, int paramIndex) const override { return m_tables->methodMethods.at(methodIndex).parameterType(paramIndex); }
+    const QByteArray methodSignature(int index) const override { return m_tables->methodMethods.at(index).methodSignature(); }
+    QMetaMethod::MethodType methodType(int index) const override { return m_tables->methodMethods.at(index).methodType(); }
+    const QByteArray typeName(int index) const override { return m_tables->methodMethods.at(index).typeName(); }
+    QByteArrayList methodParameterNames(int index) const override { return m_tables->methodMethods.at(index).parameterNames(); }
 
     int propertyIndexFromSignal(int index) const override
     {
-        if (index >= 0 && index < m_propertyAssociatedWithSignal.size())
-            return m_properties.at(m_propertyAssociatedWithSignal.at(index));
+        if (index >= 0 && index < m_tables->propertyAssociatedWithSignal.size())
+            return m_tables->properties.at(m_tables->propertyAssociatedWithSignal.at(index));
         return -1;
     }
     int propertyRawIndexFromSignal(int index) const override
     {
-        if (index >= 0 && index < m_propertyAssociatedWithSignal.size())
-            return m_propertyAssociatedWithSignal.at(index);
+        if (index >= 0 && index < m_tables->propertyAssociatedWithSignal.size())
+            return m_tables->propertyAssociatedWithSignal.at(index);
         return -1;
     }
-    QByteArray objectSignature() const override { return m_objectSignature; }
+    QByteArray objectSignature() const override { return m_tables->objectSignature; }
 
     bool isDynamic() const override { return true; }
 
-    int parameterCount(int objectIndex) const;
-    int parameterType(int objectIndex, int paramIndex) const;
-    const QByteArray signature(int objectIndex) const;
-    inline void checkCache(int objectIndex) const
-    {
-        if (objectIndex != m_cachedMetamethodIndex) {
-            m_cachedMetamethodIndex = objectIndex;
-            m_cachedMetamethod = m_metaObject->method(objectIndex);
-        }
-    }
-
     QString m_name;
     QString m_typeName;
-    int m_enumCount;
-    int m_enumOffset;
-    QList<int> m_properties;
-    QList<int> m_signals;
-    QList<int> m_methods;
-    QList<int> m_propertyAssociatedWithSignal;
-    const QMetaObject *m_metaObject;
-    mutable QMetaMethod m_cachedMetamethod;
-    mutable int m_cachedMetamethodIndex;
-    QByteArray m_objectSignature;
+    QSharedPointer<const Tables> m_tables;
 };
 
 QT_END_NAMESPACE
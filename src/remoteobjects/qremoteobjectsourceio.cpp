@@ -43,9 +43,14 @@
 #include "qremoteobjectsource_p.h"
 #include "qremoteobjectnode_p.h"
 #include "qremoteobjectpendingcall.h"
+#include "qremoteobjectabstractitemmodeladapter_p.h"
 #include "qtremoteobjectglobal.h"
 
 #include <QtCore/qstringlist.h>
+#include <QtCore/qtimer.h>
+
+#include <algorithm>
+#include <cmath>
 
 QT_BEGIN_NAMESPACE
 
@@ -59,12 +64,24 @@ QRemoteObjectSourceIo::QRemoteObjectSourceIo(const QUrl &address, QObject *paren
 {
     if (m_server == nullptr)
         qRODebug(this) << "Using" << m_address << "as external url.";
+    m_clock.start();
+    m_invokeTimer.setSingleShot(true);
+    connect(&m_invokeTimer, &QTimer::timeout, this, &QRemoteObjectSourceIo::processQueuedInvokes);
+    m_initTimer.setSingleShot(true);
+    connect(&m_initTimer, &QTimer::timeout, this, &QRemoteObjectSourceIo::sendQueuedInits);
+    connect(&m_memoryReportTimer, &QTimer::timeout, this, &QRemoteObjectSourceIo::reportMemoryUsage);
 }
 
 QRemoteObjectSourceIo::QRemoteObjectSourceIo(QObject *parent)
     : QObject(parent)
     , m_server(nullptr)
 {
+    m_clock.start();
+    m_invokeTimer.setSingleShot(true);
+    connect(&m_invokeTimer, &QTimer::timeout, this, &QRemoteObjectSourceIo::processQueuedInvokes);
+    m_initTimer.setSingleShot(true);
+    connect(&m_initTimer, &QTimer::timeout, this, &QRemoteObjectSourceIo::sendQueuedInits);
+    connect(&m_memoryReportTimer, &QTimer::timeout, this, &QRemoteObjectSourceIo::reportMemoryUsage);
 }
 
 QRemoteObjectSourceIo::~QRemoteObjectSourceIo()
@@ -123,6 +140,622 @@ bool QRemoteObjectSourceIo::disableRemoting(QObject *object)
     return true;
 }
 
+namespace {
+
+int pendingReplies(const QObject *owner)
+{
+    return owner->findChildren<QRemoteObjectPendingCallWatcher *>(QString(), Qt::FindDirectChildrenOnly).size();
+}
+
+struct SourceUsage
+{
+    qint64 marshalledArgs = 0;
+    int children = 0;
+    int modelAdapters = 0;
+    int modelPendingReplies = 0;
+};
+
+void collectSourceUsage(const QRemoteObjectSourceBase *source, SourceUsage &usage)
+{
+    usage.marshalledArgs += source->m_marshalledArgs.capacity() * qint64(sizeof(QVariant));
+    if (source->m_adapter && qobject_cast<QAbstractItemModelSourceAdapter *>(source->m_adapter)) {
+        ++usage.modelAdapters;
+        // Forwarded requests of a proxied model wait for the upstream reply
+        usage.modelPendingReplies += pendingReplies(source->m_adapter);
+    }
+    for (const auto &child : source->m_children) {
+        if (!child)
+            continue;
+        ++usage.children;
+        collectSourceUsage(child, usage);
+    }
+}
+
+} // namespace
+
+QVariantMap QRemoteObjectSourceIo::memoryUsage() const
+{
+    qint64 totalBytes = m_packet.array.capacity();
+
+    QVariantList connections;
+    for (IoDeviceBase *connection : m_connections) {
+        QIODevice *device = connection->connection();
+        QStringList sources;
+        for (QRemoteObjectRootSource *root : m_sourceRoots) {
+            if (root->d->m_listeners.contains(connection))
+                sources << root->name();
+        }
+        const qint64 queuedBytes = device ? device->bytesToWrite() : 0;
+        const qint64 receivedBytes = device ? device->bytesAvailable() : 0;
+        QVariantMap info {
+            { QStringLiteral("queuedBytes"), queuedBytes },
+            { QStringLiteral("receivedBytes"), receivedBytes },
+            { QStringLiteral("pendingReplies"), pendingReplies(connection) },
+            { QStringLiteral("sources"), sources },
+        };
+        const QString peer = connection->peerAddress();
+        if (!peer.isEmpty())
+            info.insert(QStringLiteral("peer"), peer);
+        totalBytes += queuedBytes + receivedBytes;
+        connections << info;
+    }
+
+    QVariantMap sources;
+    for (QRemoteObjectRootSource *root : m_sourceRoots) {
+        SourceUsage usage;
+        collectSourceUsage(root, usage);
+        const qint64 packetBytes = root->d->m_packet.array.capacity();
+        qint64 sentTypesBytes = 0;
+        for (const QString &type : qAsConst(root->d->sentTypes))
+            sentTypesBytes += qint64(sizeof(QString)) + type.capacity() * qint64(sizeof(QChar));
+        const qint64 sourceBytes = packetBytes + sentTypesBytes + usage.marshalledArgs
+                + root->d->m_listeners.capacity() * qint64(sizeof(IoDeviceBase *));
+        totalBytes += sourceBytes;
+        sources.insert(root->name(), QVariantMap {
+            { QStringLiteral("bytes"), sourceBytes },
+            { QStringLiteral("packetBytes"), packetBytes },
+            { QStringLiteral("sentTypesBytes"), sentTypesBytes },
+            { QStringLiteral("marshalledArgsBytes"), usage.marshalledArgs },
+            { QStringLiteral("listeners"), root->d->m_listeners.size() },
+            { QStringLiteral("multicastListeners"), root->m_multicastListeners.size() },
+            { QStringLiteral("children"), usage.children },
+            { QStringLiteral("modelAdapters"), usage.modelAdapters },
+            { QStringLiteral("modelPendingReplies"), usage.modelPendingReplies },
+        });
+    }
+
+    return QVariantMap {
+        { QStringLiteral("totalBytes"), totalBytes },
+        { QStringLiteral("queuedInits"), m_initQueue.size() },
+        { QStringLiteral("initsInFlight"), m_initsInFlight.size() },
+        { QStringLiteral("connections"), connections },
+        { QStringLiteral("sources"), sources },
+    };
+}
+
+void QRemoteObjectSourceIo::setMemoryReportInterval(int msecs)
+{
+    if (msecs > 0)
+        m_memoryReportTimer.start(msecs);
+    else
+        m_memoryReportTimer.stop();
+}
+
+void QRemoteObjectSourceIo::reportMemoryUsage()
+{
+    const QVariantMap usage = memoryUsage();
+    qRODebug(this) << "Memory usage" << m_address << "total bytes" << usage.value(QStringLiteral("totalBytes")).toLongLong();
+    for (const QVariant &connection : usage.value(QStringLiteral("connections")).toList())
+        qRODebug(this) << "  connection" << connection.toMap();
+    const QVariantMap sources = usage.value(QStringLiteral("sources")).toMap();
+    for (auto it = sources.cbegin(), end = sources.cend(); it != end; ++it)
+        qRODebug(this) << "  source" << it.key() << it.value().toMap();
+}
+
+void QRemoteObjectSourceIo::setMaxInvokeRate(int callsPerSecond, const QString &name)
+{
+    callsPerSecond = qMax(0, callsPerSecond);
+    if (name.isEmpty())
+        m_maxInvokeRate = callsPerSecond;
+    else if (callsPerSecond)
+        m_maxSourceInvokeRates.insert(name, callsPerSecond);
+    else
+        m_maxSourceInvokeRates.remove(name);
+    processQueuedInvokes();
+}
+
+void QRemoteObjectSourceIo::setMaxPendingInvokes(int count)
+{
+    m_maxPendingInvokes = qMax(0, count);
+    processQueuedInvokes();
+}
+
+void QRemoteObjectSourceIo::setMaxQueuedInvokes(int count)
+{
+    m_maxQueuedInvokes = qMax(0, count);
+    for (auto it = m_invokeQuotas.begin(), end = m_invokeQuotas.end(); it != end; ++it) {
+        while (it->queue.size() > m_maxQueuedInvokes) {
+            ++it->rejected;
+            rejectInvoke(it.key(), it->queue.takeLast(), QStringLiteral("Invoke queue is full"));
+        }
+    }
+}
+
+QVariantMap QRemoteObjectSourceIo::invokeStatistics() const
+{
+    quint64 invoked = 0, queued = 0, rejected = 0;
+    QVariantList connections;
+    for (auto it = m_invokeQuotas.cbegin(), end = m_invokeQuotas.cend(); it != end; ++it) {
+        const InvokeQuota &quota = it.value();
+        invoked += quota.invoked;
+        queued += quota.queued;
+        rejected += quota.rejected;
+        QVariantMap sources;
+        for (auto source = quota.invokedPerSource.cbegin(); source != quota.invokedPerSource.cend(); ++source)
+            sources.insert(source.key(), source.value());
+        QVariantMap info {
+            { QStringLiteral("invoked"), quota.invoked },
+            { QStringLiteral("queued"), quota.queued },
+            { QStringLiteral("rejected"), quota.rejected },
+            { QStringLiteral("pending"), quota.pending },
+            { QStringLiteral("queueLength"), quota.queue.size() },
+            { QStringLiteral("maxQueueDelay"), quota.maxQueueDelay },
+            { QStringLiteral("sources"), sources },
+        };
+        const QString peer = it.key()->peerAddress();
+        if (!peer.isEmpty())
+            info.insert(QStringLiteral("peer"), peer);
+        connections << info;
+    }
+    return QVariantMap {
+        { QStringLiteral("invoked"), invoked },
+        { QStringLiteral("queued"), queued },
+        { QStringLiteral("rejected"), rejected },
+        { QStringLiteral("connections"), connections },
+    };
+}
+
+bool QRemoteObjectSourceIo::TokenBucket::available(int rate, qint64 now)
+{
+    if (updatedAt < 0) {
+        tokens = rate;
+    } else {
+        tokens = qMin(double(rate), tokens + (now - updatedAt) * rate / 1000.0);
+    }
+    updatedAt = now;
+    return tokens >= 1;
+}
+
+qint64 QRemoteObjectSourceIo::TokenBucket::msecsUntilAvailable(int rate) const
+{
+    if (tokens >= 1)
+        return 0;
+    return qint64(std::ceil((1 - tokens) * 1000 / rate));
+}
+
+bool QRemoteObjectSourceIo::takeInvokeQuota(InvokeQuota &quota, const InvokeRequest &request, qint64 now)
+{
+    const QString &name = request.name;
+    if (m_maxPendingInvokes && quota.pending >= m_maxPendingInvokes)
+        return false;
+    if (m_maxInvokeRate && !quota.bucket.available(m_maxInvokeRate, now))
+        return false;
+    const int sourceRate = m_maxSourceInvokeRates.value(name);
+    if (sourceRate && !quota.sourceBuckets[name].available(sourceRate, now))
+        return false;
+    // A batch runs as a whole; the calls over the rate are a debt that delays
+    // the next ones
+    const int calls = request.batch.isEmpty() ? 1 : int(request.batch.size());
+    if (m_maxInvokeRate)
+        quota.bucket.tokens -= calls;
+    if (sourceRate)
+        quota.sourceBuckets[name].tokens -= calls;
+    return true;
+}
+
+void QRemoteObjectSourceIo::admitInvoke(IoDeviceBase *connection, InvokeRequest request)
+{
+    // The registry has to keep working for the node to find its sources
+    if (request.name == QLatin1String("Registry")) {
+        executeInvoke(connection, std::move(request));
+        return;
+    }
+
+    const qint64 now = m_clock.elapsed();
+    InvokeQuota &quota = m_invokeQuotas[connection];
+    // Calls already waiting go first, so a client's calls run in order
+    if (quota.queue.isEmpty() && takeInvokeQuota(quota, request, now)) {
+        executeInvoke(connection, std::move(request));
+        return;
+    }
+    if (quota.queue.size() < m_maxQueuedInvokes) {
+        qRODebug(this) << "Queueing invoke of" << request.name << "queue length" << quota.queue.size();
+        ++quota.queued;
+        request.queuedAt = now;
+        quota.queue.enqueue(std::move(request));
+        if (!m_invokeTimer.isActive())
+            processQueuedInvokes();
+        return;
+    }
+    qRODebug(this) << "Rejecting invoke of" << request.name << "from a connection over its limits";
+    ++quota.rejected;
+    rejectInvoke(connection, request, QStringLiteral("Invoke limit exceeded"));
+}
+
+void QRemoteObjectSourceIo::processQueuedInvokes()
+{
+    const qint64 now = m_clock.elapsed();
+    qint64 nextCheck = -1;
+    // Round-robin over the connections so one busy client can't starve the others
+    const QList<IoDeviceBase*> connections = m_invokeQuotas.keys();
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (IoDeviceBase *connection : connections) {
+            // Executing a call can remove connections
+            auto it = m_invokeQuotas.find(connection);
+            if (it == m_invokeQuotas.end() || it->queue.isEmpty())
+                continue;
+            if (!takeInvokeQuota(*it, it->queue.head(), now))
+                continue;
+            InvokeRequest request = it->queue.dequeue();
+            it->maxQueueDelay = qMax(it->maxQueueDelay, now - request.queuedAt);
+            executeInvoke(connection, std::move(request));
+            progress = true;
+        }
+    }
+    for (auto it = m_invokeQuotas.begin(), end = m_invokeQuotas.end(); it != end; ++it) {
+        InvokeQuota &quota = it.value();
+        if (quota.queue.isEmpty())
+            continue;
+        // Calls waiting for a pending reply are picked up once it finishes
+        if (m_maxPendingInvokes && quota.pending >= m_maxPendingInvokes)
+            continue;
+        qint64 wait = 0;
+        if (m_maxInvokeRate)
+            wait = quota.bucket.msecsUntilAvailable(m_maxInvokeRate);
+        const QString &name = quota.queue.head().name;
+        if (const int sourceRate = m_maxSourceInvokeRates.value(name))
+            wait = qMax(wait, quota.sourceBuckets[name].msecsUntilAvailable(sourceRate));
+        nextCheck = nextCheck < 0 ? wait : qMin(nextCheck, wait);
+    }
+    if (nextCheck >= 0)
+        m_invokeTimer.start(int(qMax(qint64(1), nextCheck)));
+}
+
+void QRemoteObjectSourceIo::rejectInvoke(IoDeviceBase *connection, const InvokeRequest &request, const QString &reason)
+{
+    using namespace QRemoteObjectPackets;
+
+    if (request.serialId < 0)
+        return;
+    // Older nodes only know replies, they see the rejected call return an invalid value
+    if (m_invokeErrorConnections.contains(connection))
+        serializeInvokeErrorPacket(m_packet, request.name, request.serialId, reason);
+    else
+        serializeInvokeReplyPacket(m_packet, request.name, request.serialId, QVariant());
+    if (QRemoteObjectSourceBase *source = m_sourceObjects.value(request.name))
+        source->writeSequenced(connection, m_packet.array, m_packet.size);
+    else
+        connection->write(m_packet.array, m_packet.size);
+}
+
+void QRemoteObjectSourceIo::executeInvoke(IoDeviceBase *connection, InvokeRequest request)
+{
+    using namespace QRemoteObjectPackets;
+
+    QRemoteObjectSourceBase *source = m_sourceObjects.value(request.name);
+    if (!source)
+        return;
+    const QString &name = request.name;
+    const int serialId = request.serialId;
+    if (m_invokeQuotas.contains(connection)) {
+        InvokeQuota &quota = m_invokeQuotas[connection];
+        const quint64 calls = request.batch.isEmpty() ? 1 : quint64(request.batch.size());
+        quota.invoked += calls;
+        quota.invokedPerSource[name] += calls;
+    }
+    if (!request.batch.isEmpty()) {
+        executeBatch(connection, source, std::move(request));
+        return;
+    }
+    QVariant returnValue;
+    if (!invokeSource(source, name, request.call, request.index, request.args, returnValue))
+        return;
+    // send reply if wanted
+    if (request.call != QMetaObject::InvokeMetaMethod || serialId < 0)
+        return;
+    if (returnValue.canConvert<QRemoteObjectPendingCall>()) {
+        QRemoteObjectPendingCall call = returnValue.value<QRemoteObjectPendingCall>();
+        // Watcher will be destroyed when connection is, or when the finished lambda is called
+        QRemoteObjectPendingCallWatcher *watcher = new QRemoteObjectPendingCallWatcher(call, connection);
+        QPointer<QRemoteObjectSourceBase> guard(source);
+        if (m_invokeQuotas.contains(connection))
+            ++m_invokeQuotas[connection].pending;
+        QObject::connect(watcher, &QRemoteObjectPendingCallWatcher::finished, connection, [this, name, serialId, connection, watcher, guard]() {
+            if (watcher->error() == QRemoteObjectPendingCall::NoError) {
+                if (guard)
+                    guard->d->root->flushSharedState();
+                serializeInvokeReplyPacket(this->m_packet, name, serialId, encodeVariant(watcher->returnValue()));
+                if (guard) {
+                    guard->writeSequenced(connection, m_packet.array, m_packet.size);
+                } else if (connection->isSequenced()) {
+                    quint32 unknown = 0;
+                    connection->write(sequencedPackets(m_packet.array, m_packet.size, unknown, false));
+                } else {
+                    connection->write(m_packet.array, m_packet.size);
+                }
+            }
+            watcher->deleteLater();
+            auto quota = m_invokeQuotas.find(connection);
+            if (quota != m_invokeQuotas.end() && quota->pending > 0) {
+                --quota->pending;
+                if (!quota->queue.isEmpty())
+                    processQueuedInvokes();
+            }
+        });
+    } else {
+        // The reply comes after the changes the call made
+        source->d->root->flushSharedState();
+        serializeInvokeReplyPacket(m_packet, name, serialId, encodeVariant(returnValue));
+        source->writeSequenced(connection, m_packet.array, m_packet.size);
+    }
+}
+
+bool QRemoteObjectSourceIo::invokeSource(QRemoteObjectSourceBase *source, const QString &name, int call, int index,
+                                         QVariantList &args, QVariant &returnValue)
+{
+    if (call == QMetaObject::InvokeMetaMethod) {
+        const int resolvedIndex = source->m_api->sourceMethodIndex(index);
+        if (resolvedIndex < 0) { //Invalid index
+            qROWarning(this) << "Invalid method invoke packet received.  Index =" << index <<"which is out of bounds for type"<<name;
+            //TODO - consider moving this to packet validation?
+            return false;
+        }
+        if (source->m_api->isAdapterMethod(index))
+            qRODebug(this) << "Adapter (method) Invoke-->" << name << source->m_adapter->metaObject()->method(resolvedIndex).name();
+        else {
+            qRODebug(this) << "Source (method) Invoke-->" << name << source->m_object->metaObject()->method(resolvedIndex).methodSignature();
+            auto method = source->m_object->metaObject()->method(resolvedIndex);
+            const int parameterCount = qMin(method.parameterCount(), int(args.size()));
+            for (int i = 0; i < parameterCount; i++)
+                decodeVariant(args[i], method.parameterMetaType(i));
+        }
+        auto metaType = QMetaType::fromName(source->m_api->typeName(index).constData());
+        if (!metaType.sizeOf())
+            metaType = QMetaType(QMetaType::UnknownType);
+        returnValue = QVariant(metaType, nullptr);
+        // If a Replica is used as a Source (which node->proxy() does) we can have a PendingCall return value.
+        // In this case, we need to wait for the pending call and send that.
+        if (source->m_api->typeName(index) == QByteArrayLiteral("QRemoteObjectPendingCall"))
+            returnValue = QVariant::fromValue<QRemoteObjectPendingCall>(QRemoteObjectPendingCall());
+        source->invoke(QMetaObject::InvokeMetaMethod, index, args, &returnValue);
+        return true;
+    }
+
+    const int resolvedIndex = source->m_api->sourcePropertyIndex(index);
+    if (resolvedIndex < 0) {
+        qROWarning(this) << "Invalid property invoke packet received.  Index =" << index <<"which is out of bounds for type"<<name;
+        //TODO - consider moving this to packet validation?
+        return false;
+    }
+    if (source->m_api->isAdapterProperty(index))
+        qRODebug(this) << "Adapter (write property) Invoke-->" << name << source->m_adapter->metaObject()->property(resolvedIndex).name();
+    else
+        qRODebug(this) << "Source (write property) Invoke-->" << name << source->m_object->metaObject()->property(resolvedIndex).name();
+    source->invoke(QMetaObject::WriteProperty, index, args);
+    return true;
+}
+
+void QRemoteObjectSourceIo::executeBatch(IoDeviceBase *connection, QRemoteObjectSourceBase *source, InvokeRequest request)
+{
+    using namespace QRemoteObjectPackets;
+
+    // Proxied calls finish later, the reply waits for all of them
+    struct PendingBatch
+    {
+        QList<BatchResult> results;
+        int pending = 0;
+    };
+    auto batch = QSharedPointer<PendingBatch>::create();
+    batch->results.resize(request.batch.size(), BatchResult{QRemoteObjectPendingCall::Rejected, QVariant()});
+    const QString name = request.name;
+    const int serialId = request.serialId;
+    QPointer<QRemoteObjectSourceBase> guard(source);
+
+    for (int i = 0; i < request.batch.size(); ++i) {
+        // A call can remove the source, the calls after it fail
+        if (!guard)
+            break;
+        BatchCall &call = request.batch[i];
+        QVariant returnValue;
+        if (!invokeSource(source, name, call.call, call.index, call.args, returnValue))
+            continue;
+        if (call.call == QMetaObject::InvokeMetaMethod && returnValue.canConvert<QRemoteObjectPendingCall>()) {
+            ++batch->pending;
+            auto watcher = new QRemoteObjectPendingCallWatcher(returnValue.value<QRemoteObjectPendingCall>(), connection);
+            QObject::connect(watcher, &QRemoteObjectPendingCallWatcher::finished, connection,
+                             [this, name, serialId, connection, watcher, guard, batch, i]() {
+                if (watcher->error() == QRemoteObjectPendingCall::NoError)
+                    batch->results[i] = BatchResult{QRemoteObjectPendingCall::NoError, encodeVariant(watcher->returnValue())};
+                watcher->deleteLater();
+                if (--batch->pending > 0)
+                    return;
+                if (serialId >= 0)
+                    sendBatchReply(connection, guard, name, serialId, batch->results);
+                auto quota = m_invokeQuotas.find(connection);
+                if (quota != m_invokeQuotas.end() && quota->pending > 0) {
+                    --quota->pending;
+                    if (!quota->queue.isEmpty())
+                        processQueuedInvokes();
+                }
+            });
+        } else {
+            batch->results[i] = BatchResult{QRemoteObjectPendingCall::NoError, encodeVariant(returnValue)};
+        }
+    }
+
+    if (batch->pending > 0) {
+        if (m_invokeQuotas.contains(connection))
+            ++m_invokeQuotas[connection].pending;
+    } else if (serialId >= 0) {
+        sendBatchReply(connection, guard, name, serialId, batch->results);
+    }
+}
+
+void QRemoteObjectSourceIo::sendBatchReply(IoDeviceBase *connection, QRemoteObjectSourceBase *source, const QString &name,
+                                           int serialId, const QList<QRemoteObjectPackets::BatchResult> &results)
+{
+    using namespace QRemoteObjectPackets;
+
+    // The reply comes after the changes the calls made
+    if (source)
+        source->d->root->flushSharedState();
+    serializeBatchReplyPacket(m_packet, name, serialId, results);
+    if (source) {
+        source->writeSequenced(connection, m_packet.array, m_packet.size);
+    } else if (connection->isSequenced()) {
+        quint32 unknown = 0;
+        connection->write(sequencedPackets(m_packet.array, m_packet.size, unknown, false));
+    } else {
+        connection->write(m_packet.array, m_packet.size);
+    }
+}
+
+void QRemoteObjectSourceIo::setMaxConcurrentInits(int count)
+{
+    m_maxConcurrentInits = qMax(0, count);
+    sendQueuedInits();
+}
+
+void QRemoteObjectSourceIo::setMaxInitRate(int bytesPerSecond)
+{
+    m_maxInitRate = qMax(0, bytesPerSecond);
+    m_initBytes = TokenBucket();
+    sendQueuedInits();
+}
+
+void QRemoteObjectSourceIo::setSharedStateEnabled(bool enabled)
+{
+    m_sharedStateEnabled = enabled;
+}
+
+void QRemoteObjectSourceIo::setMulticastUrl(const QString &name, const QUrl &groupUrl)
+{
+    if (groupUrl.isEmpty())
+        m_multicastUrls.remove(name);
+    else
+        m_multicastUrls.insert(name, groupUrl);
+    // Listeners that joined the previous group get changes over their connections again
+    if (QRemoteObjectRootSource *root = m_sourceRoots.value(name))
+        root->m_multicastListeners.clear();
+}
+
+bool QRemoteObjectSourceIo::writeMulticast(const QUrl &groupUrl, const QByteArray &datagram)
+{
+#if QT_CONFIG(udpsocket)
+    // Datagrams that would be fragmented are lost as a whole if one fragment is
+    if (groupUrl.isEmpty() || datagram.size() > maxDatagramSize)
+        return false;
+    if (!m_multicastSocket)
+        m_multicastSocket.reset(new QUdpSocket);
+    if (m_multicastSocket->writeDatagram(datagram, QHostAddress(groupUrl.host()), quint16(groupUrl.port())) == datagram.size())
+        return true;
+    qRODebug(this) << "Can't send to multicast group" << groupUrl << m_multicastSocket->errorString();
+#else
+    Q_UNUSED(groupUrl)
+    Q_UNUSED(datagram)
+#endif
+    return false;
+}
+
+QRemoteObjectSourceIo::InitRequest *QRemoteObjectSourceIo::findQueuedInit(IoDeviceBase *connection, const QString &name)
+{
+    for (InitRequest &request : m_initQueue) {
+        if (request.connection == connection && request.name == name)
+            return &request;
+    }
+    return nullptr;
+}
+
+void QRemoteObjectSourceIo::queueInit(IoDeviceBase *connection, const QString &name, bool isDynamic)
+{
+    // A node asking again (i.e. after a reconnect) only needs one init
+    if (InitRequest *request = findQueuedInit(connection, name)) {
+        request->isDynamic = request->isDynamic || isDynamic;
+        return;
+    }
+    const InitRequest request{connection, name, isDynamic, false, false};
+    const bool waiting = !m_initQueue.isEmpty();
+    // Nodes need the registry to find everything else
+    if (name == QLatin1String("Registry"))
+        m_initQueue.prepend(request);
+    else
+        m_initQueue.append(request);
+    // With nothing waiting, the init is sent right away if the limits allow it
+    if (!waiting)
+        sendQueuedInits();
+    else if (!m_initTimer.isActive())
+        m_initTimer.start(0);
+}
+
+void QRemoteObjectSourceIo::sendQueuedInits()
+{
+    m_initsInFlight.removeIf([](const InitInFlight &init) {
+        QIODevice *device = init.connection->connection();
+        return init.remaining <= 0 || !device || device->bytesToWrite() == 0;
+    });
+
+    const qint64 now = m_clock.elapsed();
+    for (int i = 0; i < m_initQueue.size(); ) {
+        if (m_maxConcurrentInits && m_initsInFlight.size() >= m_maxConcurrentInits)
+            return; // continued from initBytesWritten()
+        if (m_maxInitRate && !m_initBytes.available(m_maxInitRate, now)) {
+            m_initTimer.start(int(qMax(qint64(1), m_initBytes.msecsUntilAvailable(m_maxInitRate))));
+            return;
+        }
+        // Only one init per connection at a time, so updates of the objects the
+        // node already has wait behind one init at most
+        IoDeviceBase *connection = m_initQueue.at(i).connection;
+        const bool busy = std::any_of(m_initsInFlight.cbegin(), m_initsInFlight.cend(),
+                                      [connection](const InitInFlight &init) { return init.connection == connection; });
+        if (busy) {
+            ++i;
+            continue;
+        }
+
+        const InitRequest request = m_initQueue.takeAt(i);
+        QRemoteObjectRootSource *root = m_sourceRoots.value(request.name);
+        if (!root) // disabled while waiting
+            continue;
+        qRODebug(this) << "Sending init of" << request.name << "waiting inits" << m_initQueue.size();
+        root->addListener(connection, request.isDynamic);
+        const qint64 size = root->d->m_packet.size;
+        if (request.resumed)
+            root->resumeListener(connection);
+        if (request.paused)
+            root->pauseListener(connection);
+        if (m_maxInitRate)
+            m_initBytes.tokens -= size;
+        QIODevice *device = connection->connection();
+        if (const qint64 queued = device ? device->bytesToWrite() : 0)
+            m_initsInFlight.append(InitInFlight{connection, queued});
+    }
+}
+
+void QRemoteObjectSourceIo::initBytesWritten(IoDeviceBase *connection, qint64 bytes)
+{
+    bool done = false;
+    for (InitInFlight &init : m_initsInFlight) {
+        if (init.connection == connection) {
+            init.remaining -= bytes;
+            done = done || init.remaining <= 0;
+        }
+    }
+    if (done && !m_initQueue.isEmpty() && !m_initTimer.isActive())
+        m_initTimer.start(0);
+}
+
 void QRemoteObjectSourceIo::registerSource(QRemoteObjectSourceBase *source)
 {
     Q_ASSERT(source);
@@ -167,6 +800,11 @@ void QRemoteObjectSourceIo::onServerDisconnect(QObject *conn)
     const QUrl location = m_registryMapping.value(connection);
     emit serverRemoved(location);
     m_registryMapping.remove(connection);
+    m_invokeQuotas.remove(connection);
+    m_invokeErrorConnections.remove(connection);
+    m_multicastConnections.remove(connection);
+    m_initQueue.removeIf([connection](const InitRequest &request) { return request.connection == connection; });
+    m_initsInFlight.removeIf([connection](const InitInFlight &init) { return init.connection == connection; });
     connection->close();
     connection->deleteLater();
 }
@@ -195,8 +833,7 @@ void QRemoteObjectSourceIo::onServerRead(QObject *conn)
             deserializeAddObjectPacket(connection->stream(), isDynamic);
             qRODebug(this) << "AddObject" << m_rxName << isDynamic;
             if (m_sourceRoots.contains(m_rxName)) {
-                QRemoteObjectRootSource *root = m_sourceRoots[m_rxName];
-                root->addListener(connection, isDynamic);
+                queueInit(connection, m_rxName, isDynamic);
             } else {
                 qROWarning(this) << "Request to attach to non-existent RemoteObjectSource:" << m_rxName;
             }
@@ -205,6 +842,10 @@ void QRemoteObjectSourceIo::onServerRead(QObject *conn)
         case RemoveObject:
         {
             qRODebug(this) << "RemoveObject" << m_rxName;
+            // Nothing was sent yet if the init is still waiting
+            m_initQueue.removeIf([connection, this](const InitRequest &request) {
+                return request.connection == connection && request.name == m_rxName;
+            });
             if (m_sourceRoots.contains(m_rxName)) {
                 QRemoteObjectRootSource *root = m_sourceRoots[m_rxName];
                 const int count = root->removeListener(connection);
@@ -224,64 +865,91 @@ void QRemoteObjectSourceIo::onServerRead(QObject *conn)
                 const QRemoteObjectSourceLocation loc = m_rxArgs.first().value<QRemoteObjectSourceLocation>();
                 m_registryMapping[connection] = loc.second.hostUrl;
             }
-            if (m_sourceObjects.contains(m_rxName)) {
-                QRemoteObjectSourceBase *source = m_sourceObjects[m_rxName];
-                if (call == QMetaObject::InvokeMetaMethod) {
-                    const int resolvedIndex = source->m_api->sourceMethodIndex(index);
-                    if (resolvedIndex < 0) { //Invalid index
-                        qROWarning(this) << "Invalid method invoke packet received.  Index =" << index <<"which is out of bounds for type"<<m_rxName;
-                        //TODO - consider moving this to packet validation?
-                        break;
-                    }
-                    if (source->m_api->isAdapterMethod(index))
-                        qRODebug(this) << "Adapter (method) Invoke-->" << m_rxName << source->m_adapter->metaObject()->method(resolvedIndex).name();
-                    else {
-                        qRODebug(this) << "Source (method) Invoke-->" << m_rxName << source->m_object->metaObject()->method(resolvedIndex).methodSignature();
-                        auto method = source->m_object->metaObject()->method(resolvedIndex);
-                        const int parameterCount = method.parameterCount();
-                        for (int i = 0; i < parameterCount; i++)
-                            decodeVariant(m_rxArgs[i], method.parameterMetaType(i));
-                    }
-                    auto metaType = QMetaType::fromName(source->m_api->typeName(index).constData());
-                    if (!metaType.sizeOf())
-                        metaType = QMetaType(QMetaType::UnknownType);
-                    QVariant returnValue(metaType, nullptr);
-                    // If a Replica is used as a Source (which node->proxy() does) we can have a PendingCall return value.
-                    // In this case, we need to wait for the pending call and send that.
-                    if (source->m_api->typeName(index) == QByteArrayLiteral("QRemoteObjectPendingCall"))
-                        returnValue = QVariant::fromValue<QRemoteObjectPendingCall>(QRemoteObjectPendingCall());
-                    source->invoke(QMetaObject::InvokeMetaMethod, index, m_rxArgs, &returnValue);
-                    // send reply if wanted
-                    if (serialId >= 0) {
-                        if (returnValue.canConvert<QRemoteObjectPendingCall>()) {
-                            QRemoteObjectPendingCall call = returnValue.value<QRemoteObjectPendingCall>();
-                            // Watcher will be destroyed when connection is, or when the finished lambda is called
-                            QRemoteObjectPendingCallWatcher *watcher = new QRemoteObjectPendingCallWatcher(call, connection);
-                            QObject::connect(watcher, &QRemoteObjectPendingCallWatcher::finished, connection, [this, serialId, connection, watcher]() {
-                                if (watcher->error() == QRemoteObjectPendingCall::NoError) {
-                                    serializeInvokeReplyPacket(this->m_packet, this->m_rxName, serialId, encodeVariant(watcher->returnValue()));
-                                    connection->write(m_packet.array, m_packet.size);
-                                }
-                                watcher->deleteLater();
-                            });
-                        } else {
-                            serializeInvokeReplyPacket(m_packet, m_rxName, serialId, encodeVariant(returnValue));
-                            connection->write(m_packet.array, m_packet.size);
-                        }
-                    }
-                } else {
-                    const int resolvedIndex = source->m_api->sourcePropertyIndex(index);
-                    if (resolvedIndex < 0) {
-                        qROWarning(this) << "Invalid property invoke packet received.  Index =" << index <<"which is out of bounds for type"<<m_rxName;
-                        //TODO - consider moving this to packet validation?
-                        break;
-                    }
-                    if (source->m_api->isAdapterProperty(index))
-                        qRODebug(this) << "Adapter (write property) Invoke-->" << m_rxName << source->m_adapter->metaObject()->property(resolvedIndex).name();
-                    else
-                        qRODebug(this) << "Source (write property) Invoke-->" << m_rxName << source->m_object->metaObject()->property(resolvedIndex).name();
-                    source->invoke(QMetaObject::WriteProperty, index, m_rxArgs);
+            if (m_sourceObjects.contains(m_rxName))
+                admitInvoke(connection, InvokeRequest{m_rxName, call, index, m_rxArgs, serialId, 0});
+            break;
+        }
+        case BatchInvokePacket:
+        {
+            int serialId;
+            QList<BatchCall> calls;
+            deserializeBatchInvokePacket(connection->stream(), serialId, calls);
+            qRODebug(this) << "Batch of" << calls.size() << "calls to" << m_rxName;
+            // A batch is admitted as a whole, so its calls run in order
+            if (m_sourceObjects.contains(m_rxName) && !calls.isEmpty())
+                admitInvoke(connection, InvokeRequest{m_rxName, QMetaObject::InvokeMetaMethod, -1, {}, serialId, 0, std::move(calls)});
+            break;
+        }
+        case Pause:
+        case Resume:
+        {
+            qRODebug(this) << (packetType == Pause ? "Pause" : "Resume") << m_rxName;
+            QRemoteObjectRootSource *root = m_sourceRoots.value(m_rxName);
+            if (InitRequest *request = findQueuedInit(connection, m_rxName)) {
+                // Applied once the listener is added
+                request->paused = packetType == Pause;
+                request->resumed = request->resumed || packetType == Resume;
+            } else if (!root)
+                qROWarning(this) << "Request to pause or resume non-existent RemoteObjectSource:" << m_rxName;
+            else if (packetType == Pause)
+                root->pauseListener(connection);
+            else
+                root->resumeListener(connection);
+            break;
+        }
+        case MulticastPacket:
+        {
+            QUrl groupUrl;
+            quint64 sourceId = 0;
+            deserializeMulticastPacket(connection->stream(), groupUrl, sourceId);
+            // The node joined the group, property changes no longer go over the connection
+            QRemoteObjectRootSource *root = m_sourceRoots.value(m_rxName);
+            if (root && root->d->m_listeners.contains(connection) && groupUrl == m_multicastUrls.value(m_rxName)
+                    && sourceId == root->m_multicastId) {
+                qRODebug(this) << "Multicasting" << m_rxName << "to" << groupUrl;
+                root->m_multicastListeners.insert(connection);
+            }
+            break;
+        }
+        case Handshake:
+        {
+            quint32 maxFrameSize;
+            if (deserializeFrameSizeName(m_rxName, maxFrameSize)) {
+                qRODebug(this) << "Peer max frame size" << maxFrameSize;
+                connection->setPeerMaxFrameSize(maxFrameSize);
+                serializeFrameSizePacket(m_packet, connection->maxFrameSize());
+                connection->write(m_packet.array, m_packet.size);
+            } else if (m_rxName == sequenceHandshake) {
+                // Everything sent after the answer is sequenced
+                qRODebug(this) << "Sending sequence numbers";
+                serializeSequenceHandshakePacket(m_packet);
+                connection->write(m_packet.array, m_packet.size);
+                connection->setSequenced(true);
+            } else if (m_rxName == invokeErrorHandshake) {
+                qRODebug(this) << "Peer understands invoke errors";
+                m_invokeErrorConnections.insert(connection);
+            } else if (m_rxName == sharedStateHandshake) {
+                // Sequence numbers would have gaps where the page replaced packets
+                if (m_sharedStateEnabled && !connection->isSequenced()
+                    && connection->isLocal()) {
+                    qRODebug(this) << "Peer reads shared state";
+                    connection->setReadsSharedState(true);
+                }
+            } else if (m_rxName == sharedStateUnavailableHandshake) {
+                if (connection->readsSharedState()) {
+                    qRODebug(this) << "Peer can't attach to shared state";
+                    for (QRemoteObjectRootSource *root : qAsConst(m_sourceRoots))
+                        root->stopSharedState(connection);
+                    connection->setReadsSharedState(false);
                 }
+            } else if (m_rxName == multicastHandshake) {
+                qRODebug(this) << "Peer can join multicast groups";
+                m_multicastConnections.insert(connection);
+            } else if (m_rxName == batchHandshake) {
+                qRODebug(this) << "Peer sends batches of calls";
+                serializeBatchHandshakePacket(m_packet);
+                connection->write(m_packet.array, m_packet.size);
+                connection->setAcceptsBatches(true);
             }
             break;
         }
@@ -302,6 +970,15 @@ void QRemoteObjectSourceIo::handleConnection()
 void QRemoteObjectSourceIo::newConnection(IoDeviceBase *conn)
 {
     m_connections.insert(conn);
+    if (auto node = qobject_cast<QRemoteObjectNode *>(parent())) {
+        conn->setMaxFrameSize(quint32(node->maxFrameSize()));
+        conn->setMaxMessageSize(quint32(node->maxMessageSize()));
+    }
+    if (QIODevice *device = conn->connection()) {
+        connect(device, &QIODevice::bytesWritten, this, [this, conn](qint64 bytes) {
+            initBytesWritten(conn, bytes);
+        });
+    }
     connect(conn, &IoDeviceBase::readyRead, this, [this, conn]() {
         onServerRead(conn);
     });
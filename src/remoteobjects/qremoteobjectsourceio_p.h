@@ -55,8 +55,14 @@
 #include "qtremoteobjectglobal.h"
 #include "qremoteobjectpacket_p.h"
 
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qqueue.h>
 #include <QtCore/qscopedpointer.h>
+#include <QtCore/qtimer.h>
+#if QT_CONFIG(udpsocket)
+#include <QtNetwork/qudpsocket.h>
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -82,6 +88,28 @@ public:
 
     QUrl serverAddress() const;
 
+    // Approximate bytes held per connection and per root source, see
+    // QRemoteObjectHostBase::memoryUsage()
+    QVariantMap memoryUsage() const;
+
+    // Invoke admission control, see QRemoteObjectHostBase::setMaxInvokeRate()
+    void setMaxInvokeRate(int callsPerSecond, const QString &name);
+    void setMaxPendingInvokes(int count);
+    void setMaxQueuedInvokes(int count);
+    QVariantMap invokeStatistics() const;
+
+    // Paced sending of init packets, see QRemoteObjectHostBase::setMaxConcurrentInits()
+    void setMaxConcurrentInits(int count);
+    void setMaxInitRate(int bytesPerSecond);
+
+    // See QRemoteObjectHostBase::setSharedStateEnabled()
+    void setSharedStateEnabled(bool enabled);
+
+    // See QRemoteObjectHostBase::setMulticastUrl()
+    void setMulticastUrl(const QString &name, const QUrl &groupUrl);
+    // False if the datagram was not sent, it is then sent over the connections
+    bool writeMulticast(const QUrl &groupUrl, const QByteArray &datagram);
+
 public Q_SLOTS:
     void handleConnection();
     void onServerDisconnect(QObject *obj = nullptr);
@@ -95,6 +123,81 @@ Q_SIGNALS:
 public:
     void registerSource(QRemoteObjectSourceBase *source);
     void unregisterSource(QRemoteObjectSourceBase *source);
+    // See QRemoteObjectHostBase::setMemoryReportInterval()
+    void setMemoryReportInterval(int msecs);
+    void reportMemoryUsage();
+
+    struct InvokeRequest
+    {
+        QString name;
+        int call;
+        int index;
+        QVariantList args;
+        int serialId;
+        qint64 queuedAt;
+        // The calls of a batch, admitted and run together
+        QList<QRemoteObjectPackets::BatchCall> batch;
+    };
+
+    // Allows rate calls (or bytes) per second, with bursts of up to rate. Taking
+    // more than is available leaves a debt that is paid off first.
+    struct TokenBucket
+    {
+        double tokens = 0;
+        qint64 updatedAt = -1;
+        bool available(int rate, qint64 now);
+        qint64 msecsUntilAvailable(int rate) const;
+    };
+
+    struct InvokeQuota
+    {
+        TokenBucket bucket;
+        QHash<QString, TokenBucket> sourceBuckets;
+        int pending = 0;
+        QQueue<InvokeRequest> queue;
+        quint64 invoked = 0;
+        quint64 queued = 0;
+        quint64 rejected = 0;
+        qint64 maxQueueDelay = 0;
+        QHash<QString, quint64> invokedPerSource;
+    };
+
+    void admitInvoke(IoDeviceBase *connection, InvokeRequest request);
+    // Returns false if a limit doesn't allow running request now, else takes a
+    // token for each of its calls
+    bool takeInvokeQuota(InvokeQuota &quota, const InvokeRequest &request, qint64 now);
+    void executeInvoke(IoDeviceBase *connection, InvokeRequest request);
+    // Runs one call on source, returns false if index is out of bounds
+    bool invokeSource(QRemoteObjectSourceBase *source, const QString &name, int call, int index,
+                      QVariantList &args, QVariant &returnValue);
+    void executeBatch(IoDeviceBase *connection, QRemoteObjectSourceBase *source, InvokeRequest request);
+    // source is null if it was removed while calls of the batch were pending
+    void sendBatchReply(IoDeviceBase *connection, QRemoteObjectSourceBase *source, const QString &name,
+                        int serialId, const QList<QRemoteObjectPackets::BatchResult> &results);
+    void rejectInvoke(IoDeviceBase *connection, const InvokeRequest &request, const QString &reason);
+    void processQueuedInvokes();
+
+    struct InitRequest
+    {
+        IoDeviceBase *connection;
+        QString name;
+        bool isDynamic;
+        // Pause and resume received before the init was sent
+        bool paused;
+        bool resumed;
+    };
+
+    // An init is in flight until the bytes queued up to its end were written
+    struct InitInFlight
+    {
+        IoDeviceBase *connection;
+        qint64 remaining;
+    };
+
+    void queueInit(IoDeviceBase *connection, const QString &name, bool isDynamic);
+    InitRequest *findQueuedInit(IoDeviceBase *connection, const QString &name);
+    void sendQueuedInits();
+    void initBytesWritten(IoDeviceBase *connection, qint64 bytes);
 
     QHash<QIODevice*, quint32> m_readSize;
     QSet<IoDeviceBase*> m_connections;
@@ -107,6 +210,34 @@ public:
     QString m_rxName;
     QVariantList m_rxArgs;
     QUrl m_address;
+
+    int m_maxInvokeRate = 0;
+    QHash<QString, int> m_maxSourceInvokeRates;
+    int m_maxPendingInvokes = 0;
+    int m_maxQueuedInvokes = 100;
+    QHash<IoDeviceBase*, InvokeQuota> m_invokeQuotas;
+    QSet<IoDeviceBase*> m_invokeErrorConnections;
+    QElapsedTimer m_clock;
+    QTimer m_invokeTimer;
+
+    QList<InitRequest> m_initQueue;
+    QList<InitInFlight> m_initsInFlight;
+    int m_maxConcurrentInits = 16;
+    int m_maxInitRate = 0;
+    TokenBucket m_initBytes;
+    QTimer m_initTimer;
+
+    bool m_sharedStateEnabled = false;
+
+    QTimer m_memoryReportTimer;
+
+    // Groups the property changes of root sources are multicast to, by name
+    QHash<QString, QUrl> m_multicastUrls;
+    // Connections whose node can join multicast groups
+    QSet<IoDeviceBase*> m_multicastConnections;
+#if QT_CONFIG(udpsocket)
+    QScopedPointer<QUdpSocket> m_multicastSocket;
+#endif
 };
 
 QT_END_NAMESPACE
@@ -38,9 +38,14 @@
 ****************************************************************************/
 
 #include "qtremoteobjectglobal.h"
+#include "qremoteobjectpacket_p.h"
 
 #include <QtCore/qdatastream.h>
 #include <QtCore/qmetaobject.h>
+#include <QtCore/qreadwritelock.h>
+#include <QtCore/private/qmetaobject_p.h>
+
+#include <cstddef>
 
 QT_BEGIN_NAMESPACE
 
@@ -72,6 +77,21 @@ Q_LOGGING_CATEGORY(QT_REMOTEOBJECT_IO, "qt.remoteobjects.io", QtWarningMsg)
     \sa QRemoteObjectNode::acquireModel(), QRemoteObjectReplica::initialized()
 */
 
+/*!
+    \enum QtRemoteObjects::StoredPropertiesFormat
+    \since 6.2
+
+    This enum type specifies how copyStoredProperties() streams the properties
+    of a gadget.
+
+    \value VariantProperties Each property is streamed as a QVariant, including
+                             its type information. This is the format used by
+                             default, and the one dynamic replicas expect.
+    \value TypedProperties   Each property is streamed using only the data stream
+                             operators of its type. Both sides need to know the
+                             gadget type.
+*/
+
 namespace QtRemoteObjects {
 
 void copyStoredProperties(const QMetaObject *mo, const void *src, void *dst)
@@ -97,7 +117,159 @@ void copyStoredProperties(const QMetaObject *mo, const void *src, void *dst)
 #endif
 }
 
+namespace {
+
+struct StoredProperty
+{
+    const QMetaObject *enclosingMetaObject;
+    int index;
+    int relativeIndex;
+    QMetaType metaType;
+    // Whether the property can be streamed without going through QVariant
+    bool typed;
+    QByteArray variantHeader;
+};
+
+using StoredPropertyTable = QList<StoredProperty>;
+
+struct StoredPropertyTables
+{
+    QReadWriteLock lock;
+    QHash<const QMetaObject *, StoredPropertyTable> tables;
+    // Freed dynamic metaobjects leave their table behind, so these are bounded
+    QHash<const QMetaObject *, StoredPropertyTable> dynamicTables;
+};
+
+const int maxDynamicStoredPropertyTables = 256;
+
+Q_GLOBAL_STATIC(StoredPropertyTables, storedPropertyTables)
+
+StoredPropertyTable createStoredPropertyTable(const QMetaObject *mo)
+{
+    StoredPropertyTable table;
+    const int count = mo->propertyCount();
+    table.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QMetaProperty mp = mo->property(i);
+        const QMetaObject *enclosing = mp.enclosingMetaObject();
+        const QMetaType metaType = mp.metaType();
+        const bool typed = metaType.isValid() && metaType != QMetaType::fromType<QVariant>()
+                && metaType.hasRegisteredDataStreamOperators() && enclosing->d.static_metacall
+                && (QMetaObjectPrivate::get(enclosing)->flags & PropertyAccessInStaticMetaCall);
+        table.append({enclosing, i, mp.relativePropertyIndex(), metaType, typed,
+                      typed ? QRemoteObjectPackets::variantHeader(metaType) : QByteArray()});
+    }
+    return table;
+}
+
+// Dynamic metaobjects can be freed and their address reused by another one, a
+// cached table is only used while it still describes the properties of mo
+bool describes(const StoredPropertyTable &table, const QMetaObject *mo)
+{
+    if (table.size() != mo->propertyCount())
+        return false;
+    for (const auto &property : table) {
+        const QMetaProperty mp = mo->property(property.index);
+        if (mp.metaType() != property.metaType || mp.enclosingMetaObject() != property.enclosingMetaObject)
+            return false;
+    }
+    return true;
+}
+
+StoredPropertyTable storedPropertyTable(const QMetaObject *mo)
+{
+    const bool dynamic = QMetaObjectPrivate::get(mo)->flags & DynamicMetaObject;
+    auto cache = storedPropertyTables();
+    auto &tables = dynamic ? cache->dynamicTables : cache->tables;
+    {
+        QReadLocker locker(&cache->lock);
+        auto it = tables.constFind(mo);
+        if (it != tables.cend() && (!dynamic || describes(it.value(), mo)))
+            return it.value();
+    }
+    const auto table = createStoredPropertyTable(mo);
+    QWriteLocker locker(&cache->lock);
+    if (dynamic && tables.size() >= maxDynamicStoredPropertyTables && !tables.contains(mo))
+        tables.clear();
+    tables.insert(mo, table);
+    return table;
+}
+
+// Storage for a single property value, avoiding the heap for small types
+class PropertyValue
+{
+public:
+    explicit PropertyValue(QMetaType metaType)
+        : m_metaType(metaType)
+    {
+        if (size_t(metaType.sizeOf()) <= sizeof(m_buffer)
+                && size_t(metaType.alignOf()) <= alignof(std::max_align_t)) {
+            m_data = m_buffer;
+            metaType.construct(m_data);
+        } else {
+            m_data = metaType.create();
+        }
+    }
+    ~PropertyValue()
+    {
+        if (m_data == m_buffer)
+            m_metaType.destruct(m_data);
+        else
+            m_metaType.destroy(m_data);
+    }
+    void *data() const { return m_data; }
+
+private:
+    Q_DISABLE_COPY(PropertyValue)
+    QMetaType m_metaType;
+    void *m_data;
+    alignas(std::max_align_t) char m_buffer[64];
+};
+
+// Same as QMetaProperty::readOnGadget(), but reads into the property's own type
+const void *readProperty(const StoredProperty &property, const void *gadget, void *value)
+{
+    QVariant unused;
+    int status = -1;
+    void *argv[] = { value, &unused, &status };
+    property.enclosingMetaObject->d.static_metacall(reinterpret_cast<QObject *>(const_cast<void *>(gadget)),
+                                                    QMetaObject::ReadProperty, property.relativeIndex, argv);
+    // The property may have returned a pointer to its own storage instead
+    return argv[0];
+}
+
+// Same as QMetaProperty::writeOnGadget(), but writes from the property's own type
+void writeProperty(const StoredProperty &property, void *gadget, void *value)
+{
+    QVariant unused;
+    int status = -1;
+    int flags = 0;
+    void *argv[] = { value, &unused, &status, &flags };
+    property.enclosingMetaObject->d.static_metacall(reinterpret_cast<QObject *>(gadget),
+                                                    QMetaObject::WriteProperty, property.relativeIndex, argv);
+}
+
+}
+
 void copyStoredProperties(const QMetaObject *mo, const void *src, QDataStream &dst)
+{
+    copyStoredProperties(mo, src, dst, VariantProperties);
+}
+
+void copyStoredProperties(const QMetaObject *mo, QDataStream &src, void *dst)
+{
+    copyStoredProperties(mo, src, dst, VariantProperties);
+}
+
+/*!
+    \internal
+    \since 6.2
+
+    Streams the properties of the gadget \a src, described by \a mo, to \a dst
+    in the given \a format.
+*/
+void copyStoredProperties(const QMetaObject *mo, const void *src, QDataStream &dst,
+                          StoredPropertiesFormat format)
 {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 5, 0))
     if (!src) {
@@ -105,18 +277,34 @@ void copyStoredProperties(const QMetaObject *mo, const void *src, QDataStream &d
         return;
     }
 
-    for (int i = 0, end = mo->propertyCount(); i != end; ++i) {
-        const QMetaProperty mp = mo->property(i);
-        dst << mp.readOnGadget(src);
+    const auto table = storedPropertyTable(mo);
+    for (const auto &property : table) {
+        const bool typed = property.typed && (format == TypedProperties
+                || QRemoteObjectPackets::writeVariantHeader(dst, property.variantHeader));
+        if (!typed) {
+            dst << mo->property(property.index).readOnGadget(src);
+            continue;
+        }
+        PropertyValue value(property.metaType);
+        property.metaType.save(dst, readProperty(property, src, value.data()));
     }
 #else
     Q_UNUSED(mo)
     Q_UNUSED(src)
     Q_UNUSED(dst)
+    Q_UNUSED(format)
 #endif
 }
 
-void copyStoredProperties(const QMetaObject *mo, QDataStream &src, void *dst)
+/*!
+    \internal
+    \since 6.2
+
+    Reads the properties of the gadget \a dst, described by \a mo, from \a src
+    in the given \a format.
+*/
+void copyStoredProperties(const QMetaObject *mo, QDataStream &src, void *dst,
+                          StoredPropertiesFormat format)
 {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 5, 0))
     if (!dst) {
@@ -124,16 +312,25 @@ void copyStoredProperties(const QMetaObject *mo, QDataStream &src, void *dst)
         return;
     }
 
-    for (int i = 0, end = mo->propertyCount(); i != end; ++i) {
-        const QMetaProperty mp = mo->property(i);
-        QVariant v;
-        src >> v;
-        mp.writeOnGadget(dst, v);
+    const auto table = storedPropertyTable(mo);
+    for (const auto &property : table) {
+        const bool typed = property.typed && (format == TypedProperties
+                || QRemoteObjectPackets::skipVariantHeader(src, property.variantHeader));
+        if (!typed) {
+            QVariant v;
+            src >> v;
+            mo->property(property.index).writeOnGadget(dst, v);
+            continue;
+        }
+        PropertyValue value(property.metaType);
+        property.metaType.load(src, value.data());
+        writeProperty(property, dst, value.data());
     }
 #else
     Q_UNUSED(mo)
     Q_UNUSED(src)
     Q_UNUSED(dst)
+    Q_UNUSED(format)
 #endif
 }
 
@@ -128,9 +128,19 @@ namespace QtRemoteObjects {
 
 Q_NAMESPACE
 
+enum StoredPropertiesFormat {
+    VariantProperties,
+    TypedProperties
+};
+Q_ENUM_NS(StoredPropertiesFormat)
+
 Q_REMOTEOBJECTS_EXPORT void copyStoredProperties(const QMetaObject *mo, const void *src, void *dst);
 Q_REMOTEOBJECTS_EXPORT void copyStoredProperties(const QMetaObject *mo, const void *src, QDataStream &dst);
 Q_REMOTEOBJECTS_EXPORT void copyStoredProperties(const QMetaObject *mo, QDataStream &src, void *dst);
+Q_REMOTEOBJECTS_EXPORT void copyStoredProperties(const QMetaObject *mo, const void *src, QDataStream &dst,
+                                                 StoredPropertiesFormat format);
+Q_REMOTEOBJECTS_EXPORT void copyStoredProperties(const QMetaObject *mo, QDataStream &src, void *dst,
+                                                 StoredPropertiesFormat format);
 
 QString getTypeNameAndMetaobjectFromClassInfo(const QMetaObject *& meta);
 
@@ -152,6 +162,18 @@ void copyStoredProperties(QDataStream &src, T *dst)
     copyStoredProperties(&T::staticMetaObject, src, dst);
 }
 
+template <typename T>
+void copyStoredProperties(const T *src, QDataStream &dst, StoredPropertiesFormat format)
+{
+    copyStoredProperties(&T::staticMetaObject, src, dst, format);
+}
+
+template <typename T>
+void copyStoredProperties(QDataStream &src, T *dst, StoredPropertiesFormat format)
+{
+    copyStoredProperties(&T::staticMetaObject, src, dst, format);
+}
+
 enum QRemoteObjectPacketTypeEnum
 {
     Invalid = 0,
@@ -165,7 +187,14 @@ enum QRemoteObjectPacketTypeEnum
     PropertyChangePacket,
     ObjectList,
     Ping,
-    Pong
+    Pong,
+    Pause,
+    Resume,
+    InvokeErrorPacket,
+    SharedStatePacket,
+    MulticastPacket,
+    BatchInvokePacket,
+    BatchReplyPacket
 };
 Q_ENUM_NS(QRemoteObjectPacketTypeEnum)
 
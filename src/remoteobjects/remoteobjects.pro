@@ -22,6 +22,7 @@ HEADERS += \
     qconnection_local_backend_p.h \
     qconnection_tcpip_backend_p.h \
     qconnectionfactories_p.h \
+    qconnectionpool_p.h \
     qremoteobjectabstractitemmodeladapter_p.h \
     qremoteobjectabstractitemmodelreplica.h \
     qremoteobjectabstractitemmodelreplica_p.h \
@@ -36,6 +37,7 @@ HEADERS += \
     qremoteobjectregistrysource_p.h \
     qremoteobjectreplica.h \
     qremoteobjectreplica_p.h \
+    qremoteobjectreplicahandle.h \
     qremoteobjectsettingsstore.h \
     qremoteobjectsource.h \
     qremoteobjectsource_p.h \
@@ -46,6 +48,7 @@ SOURCES += \
     qconnection_local_backend.cpp \
     qconnection_tcpip_backend.cpp \
     qconnectionfactories.cpp \
+    qconnectionpool.cpp \
     qremoteobjectabstractitemmodeladapter.cpp \
     qremoteobjectabstractitemmodelreplica.cpp \
     qremoteobjectdynamicreplica.cpp \
@@ -55,11 +58,20 @@ SOURCES += \
     qremoteobjectregistry.cpp \
     qremoteobjectregistrysource.cpp \
     qremoteobjectreplica.cpp \
+    qremoteobjectreplicahandle.cpp \
     qremoteobjectsettingsstore.cpp \
     qremoteobjectsource.cpp \
     qremoteobjectsourceio.cpp \
     qtremoteobjectglobal.cpp
 
+linux {
+    SOURCES += \
+        qconnection_epoll_backend.cpp
+
+    HEADERS += \
+        qconnection_epoll_backend_p.h
+}
+
 qnx {
     SOURCES += \
         qconnection_qnx_backend.cpp \
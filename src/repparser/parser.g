@@ -50,7 +50,7 @@
 %token prop "[prop][ \\t]*PROP[ \\t]*\\((?<args>[^\\)]+)\\);?[ \\t]*"
 %token use_enum "[use_enum]USE_ENUM[ \\t]*\\((?<name>[^\\)]*)\\);?[ \\t]*"
 %token signal "[signal][ \\t]*SIGNAL[ \\t]*\\([ \\t]*(?<name>\\S+)[ \\t]*\\((?<args>[^\\)]*)\\)[ \\t]*\\);?[ \\t]*"
-%token slot "[slot][ \\t]*SLOT[ \\t]*\\((?<type>[^\\(]*)\\((?<args>[^\\)]*)\\)[ \\t]*\\);?[ \\t]*"
+%token slot "[slot][ \\t]*SLOT[ \\t]*\\((?<type>[^\\(]*)\\((?<args>[^\\)]*)\\)[ \\t]*\\)[ \\t]*(?<cached>CACHED[ \\t]*(\\((?<cacheargs>[^\\)]*)\\))?)?;?[ \\t]*"
 %token model "[model][ \\t]*MODEL[ \\t]+(?<name>[A-Za-z_][A-Za-z0-9_]+)\\((?<args>[^\\)]+)\\)[ \\t]*;?[ \\t]*"
 %token childrep "[childrep][ \\t]*CLASS[ \\t]+(?<name>[A-Za-z_][A-Za-z0-9_]+)\\((?<type>[^\\)]+)\\)[ \\t]*;?[ \\t]*"
 %token start "[start][ \\t]*\\{[ \\t]*"
@@ -97,6 +97,8 @@ struct ASTProperty
     Modifier modifier;
     bool persisted;
     bool isPointer;
+    // Generated setters don't compare the new value with the old one
+    bool noCompare = false;
 };
 Q_DECLARE_TYPEINFO(ASTProperty, Q_RELOCATABLE_TYPE);
 
@@ -139,6 +141,11 @@ struct ASTFunction
     QString returnType;
     QString name;
     QList<ASTDeclaration> params;
+
+    // Replicas serve repeated calls of a CACHED slot from a cache
+    bool cached = false;
+    int cacheTtl = 0; // in ms, 0 keeps replies until they are invalidated
+    QString cacheInvalidatedBy; // a signal or property of the class
 };
 Q_DECLARE_TYPEINFO(ASTFunction, Q_RELOCATABLE_TYPE);
 
@@ -265,10 +272,14 @@ private:
 
     bool parseProperty(ASTClass &astClass, const QString &propertyDeclaration);
     /// A helper function to parse modifier flag of property declaration
-    bool parseModifierFlag(const QString &flag, ASTProperty::Modifier &modifier, bool &persisted);
+    bool parseModifierFlag(const QString &flag, ASTProperty::Modifier &modifier, bool &persisted, bool &noCompare);
 
     bool parseRoles(ASTModel &astModel, const QString &modelRoles);
 
+    /// Parses the options of a CACHED slot, "ttl = <ms>, invalidate = <signal or property>"
+    bool parseCacheOptions(ASTFunction &slot, const QString &options);
+    bool checkCachedSlots(const ASTClass &astClass);
+
     AST m_ast;
 
     ASTClass m_astClass;
@@ -411,11 +422,12 @@ void RepParser::reset()
     //setDebug();
 }
 
-bool RepParser::parseModifierFlag(const QString &flag, ASTProperty::Modifier &modifier, bool &persisted)
+bool RepParser::parseModifierFlag(const QString &flag, ASTProperty::Modifier &modifier, bool &persisted, bool &noCompare)
 {
     QRegularExpression regex(QStringLiteral("\\s*,\\s*"));
     QStringList flags = flag.split(regex);
     persisted = flags.removeAll(QStringLiteral("PERSISTED")) > 0;
+    noCompare = flags.removeAll(QStringLiteral("NOCOMPARE")) > 0;
     if (flags.length() == 0)
         return true;
     if (flags.length() > 1) {
@@ -470,6 +482,7 @@ bool RepParser::parseProperty(ASTClass &astClass, const QString &propertyDeclara
     QString propertyDefaultValue;
     ASTProperty::Modifier propertyModifier = ASTProperty::ReadPush;
     bool persisted = false;
+    bool noCompare = false;
 
     // parse type declaration which could be a nested template as well
     bool inTemplate = false;
@@ -527,7 +540,7 @@ bool RepParser::parseProperty(ASTClass &astClass, const QString &propertyDeclara
                 propertyDefaultValue = input.left(whitespaceIndex).trimmed();
 
             const QString flag = input.mid(whitespaceIndex + 1).trimmed();
-            if (!parseModifierFlag(flag, propertyModifier, persisted))
+            if (!parseModifierFlag(flag, propertyModifier, persisted, noCompare))
                 return false;
         }
     } else { // there is no default value
@@ -539,12 +552,13 @@ bool RepParser::parseProperty(ASTClass &astClass, const QString &propertyDeclara
             propertyName = input.left(whitespaceIndex).trimmed();
 
             const QString flag = input.mid(whitespaceIndex + 1).trimmed();
-            if (!parseModifierFlag(flag, propertyModifier, persisted))
+            if (!parseModifierFlag(flag, propertyModifier, persisted, noCompare))
                 return false;
         }
     }
 
     astClass.properties << ASTProperty(propertyType, propertyName, propertyDefaultValue, propertyModifier, persisted);
+    astClass.properties.last().noCompare = noCompare;
     if (persisted)
         astClass.hasPersisted = true;
     return true;
@@ -563,6 +577,60 @@ bool RepParser::parseRoles(ASTModel &astModel, const QString &modelRoles)
     return true;
 }
 
+bool RepParser::parseCacheOptions(ASTFunction &slot, const QString &options)
+{
+    slot.cached = true;
+    if (slot.returnType == QLatin1String("void")) {
+        setErrorString(QLatin1String("SLOT: CACHED requires a return type (%1)").arg(slot.name));
+        return false;
+    }
+
+    const QString input = options.trimmed();
+    if (input.isEmpty())
+        return true;
+
+    static const QRegularExpression re(QStringLiteral("^\\s*(?<key>[A-Za-z_]+)\\s*=\\s*(?<value>\\S+)\\s*$"));
+    const QStringList optionStrings = input.split(QChar(QLatin1Char(',')));
+    for (const QString &option : optionStrings) {
+        const QRegularExpressionMatch match = re.match(option);
+        const QString key = match.captured(QStringLiteral("key"));
+        const QString value = match.captured(QStringLiteral("value"));
+        bool ok = match.hasMatch();
+        if (key == QLatin1String("ttl")) {
+            slot.cacheTtl = value.toInt(&ok);
+            ok = ok && slot.cacheTtl >= 0;
+        } else if (key == QLatin1String("invalidate")) {
+            slot.cacheInvalidatedBy = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            setErrorString(QLatin1String("SLOT: Invalid CACHED option: %1").arg(option.trimmed()));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RepParser::checkCachedSlots(const ASTClass &astClass)
+{
+    for (const ASTFunction &slot : astClass.slotsList) {
+        if (slot.cacheInvalidatedBy.isEmpty())
+            continue;
+        bool found = false;
+        for (const ASTFunction &signal : astClass.signalsList)
+            found = found || signal.name == slot.cacheInvalidatedBy;
+        for (const ASTProperty &property : astClass.properties)
+            found = found || (property.name == slot.cacheInvalidatedBy && property.modifier != ASTProperty::Constant);
+        if (!found) {
+            setErrorString(QLatin1String("SLOT: CACHED %1 is invalidated by %2, which is no signal or changing property of %3")
+                           .arg(slot.name, slot.cacheInvalidatedBy, astClass.name));
+            return false;
+        }
+    }
+    return true;
+}
+
 AST RepParser::ast() const
 {
     return m_ast;
@@ -724,6 +792,8 @@ Class: ClassStart Start Stop;
 /.
     case $rule_number:
     {
+        if (!checkCachedSlots(m_astClass))
+            return false;
         m_ast.classes.append(m_astClass);
     }
     break;
@@ -844,6 +914,10 @@ Slot: slot;
         RepParser::TypeParser parseType;
         parseType.parseArguments(argString);
         parseType.appendParams(slot);
+
+        if (!captured().value(QLatin1String("cached")).isEmpty()
+                && !parseCacheOptions(slot, captured().value(QLatin1String("cacheargs"))))
+            return false;
         m_astClass.slotsList << slot;
     }
     break;
@@ -57,6 +57,11 @@ public Q_SLOTS:
 
     QString myTestString() override { return _myTestString; }
     void setMyTestString(QString value) override { _myTestString = value; }
+    QString cachedTestString(int id) override { ++cachedTestStringCalls; return _myTestString + QString::number(id); }
+    QString expiringTestString(int id) override { ++cachedTestStringCalls; return _myTestString + QString::number(id); }
+
+public:
+    int cachedTestStringCalls = 0;
 
 private:
     bool _purchasedPart;
@@ -34,10 +34,14 @@
 #include <QFileInfo>
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QUdpSocket>
+#include <QNetworkDatagram>
+#include <QtEndian>
 
 #include <QRemoteObjectReplica>
 #include <QRemoteObjectNode>
 #include <QRemoteObjectSettingsStore>
+#include <QRemoteObjectReplicaHandle>
 #include "engine.h"
 #include "speedometer.h"
 #include "rep_engine_replica.h"
@@ -65,6 +69,29 @@ Q_SIGNALS:
     void send(const QByteArray &data);
 };
 
+class TestPreviousValueNotify : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int value READ value WRITE setValue NOTIFY valueChanged)
+
+public:
+    int value() const { return m_value; }
+    void setValue(int value)
+    {
+        if (value == m_value)
+            return;
+        const int previous = m_value;
+        m_value = value;
+        emit valueChanged(previous, value);
+    }
+
+Q_SIGNALS:
+    void valueChanged(int previous, int current);
+
+private:
+    int m_value = 0;
+};
+
 class TestDynamicBase : public QObject
 {
     Q_OBJECT
@@ -154,10 +181,15 @@ class tst_Integration: public QObject
 
     void setupHost(bool useRegistry=false)
     {
-        QFETCH_GLOBAL(QUrl, hostUrl);
-        QFETCH_GLOBAL(QUrl, registryUrl);
         host = new QRemoteObjectHost;
         SET_NODE_NAME(*host);
+        listenHost(useRegistry);
+    }
+
+    void listenHost(bool useRegistry=false)
+    {
+        QFETCH_GLOBAL(QUrl, hostUrl);
+        QFETCH_GLOBAL(QUrl, registryUrl);
         if (!hostUrl.isEmpty()) {
             host->setHostUrl(hostUrl);
             if (useRegistry)
@@ -170,10 +202,15 @@ class tst_Integration: public QObject
 
     void setupClient(bool useRegistry=false)
     {
-        QFETCH_GLOBAL(QUrl, hostUrl);
-        QFETCH_GLOBAL(QUrl, registryUrl);
         client = new QRemoteObjectNode;
         Q_SET_OBJECT_NAME(*client);
+        connectClient(useRegistry);
+    }
+
+    void connectClient(bool useRegistry=false)
+    {
+        QFETCH_GLOBAL(QUrl, hostUrl);
+        QFETCH_GLOBAL(QUrl, registryUrl);
         if (!hostUrl.isEmpty())
         {
             if (useRegistry)
@@ -187,6 +224,16 @@ class tst_Integration: public QObject
         }
     }
 
+    // A client sharing its connection to hostUrl with the other nodes of the test
+    void setupSharedClient()
+    {
+        QFETCH_GLOBAL(QUrl, hostUrl);
+        client = new QRemoteObjectNode;
+        Q_SET_OBJECT_NAME(*client);
+        client->setSharedConnectionsEnabled(true);
+        client->connectToNode(hostUrl);
+    }
+
     void setupRegistry()
     {
         QFETCH_GLOBAL(QUrl, registryUrl);
@@ -215,6 +262,10 @@ private slots:
         QTest::newRow("qnx") << QUrl(QLatin1String("qnx:replica")) << QUrl(QLatin1String("qnx:registry"));
 #endif
         QTest::newRow("local") << QUrl(QLatin1String("local:replicaLocalIntegration")) << QUrl(QLatin1String("local:registryLocalIntegration"));
+#ifdef Q_OS_LINUX
+        QTest::newRow("tcp+epoll") << QUrl(QLatin1String("tcp+epoll://127.0.0.1:65511")) << QUrl(QLatin1String("tcp+epoll://127.0.0.1:65512"));
+        QTest::newRow("local+epoll") << QUrl(QLatin1String("local+epoll:replicaEpollIntegration")) << QUrl(QLatin1String("local+epoll:registryEpollIntegration"));
+#endif
         QTest::newRow("external") << QUrl() << QUrl();
     }
 
@@ -712,6 +763,678 @@ private slots:
         QCOMPARE(engine_r->rpm(), e.rpm());
     }
 
+    void unchangedNotifyTest()
+    {
+        setupHost();
+        Engine e;
+        host->enableRemoting(&e);
+
+        setupClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        QSignalSpy spy(engine_r.data(), &EngineReplica::rpmChanged);
+        e.setRpm(2345);
+        QTRY_COMPARE(engine_r->rpm(), 2345);
+        QCOMPARE(spy.count(), 1);
+
+        // Notifying without a change only forwards the signal
+        emit e.rpmChanged(2345);
+        emit e.rpmChanged(2345);
+        QTRY_COMPARE(spy.count(), 3);
+        QCOMPARE(spy.last().at(0).toInt(), 2345);
+        QCOMPARE(engine_r->rpm(), 2345);
+        e.setRpm(3456);
+        QTRY_COMPARE(engine_r->rpm(), 3456);
+        QCOMPARE(spy.count(), 4);
+        QCOMPARE(spy.last().at(0).toInt(), 3456);
+    }
+
+    void multiArgumentNotifyTest()
+    {
+        setupHost();
+        TestPreviousValueNotify t;
+        host->enableRemoting(&t, QStringLiteral("previousValue"));
+
+        setupClient();
+
+        const QScopedPointer<QRemoteObjectDynamicReplica> rep(client->acquireDynamic(QStringLiteral("previousValue")));
+        QVERIFY(rep->waitForSource());
+        QCOMPARE(rep->property("value").toInt(), 0);
+
+        // The first argument has the property's type, but isn't the new value
+        t.setValue(5);
+        QTRY_COMPARE(rep->property("value").toInt(), 5);
+        t.setValue(7);
+        QTRY_COMPARE(rep->property("value").toInt(), 7);
+    }
+
+    void pauseResumeTest()
+    {
+        setupHost();
+        Engine e;
+        e.setRpm(1000);
+        host->enableRemoting(&e);
+
+        setupClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        QCOMPARE(engine_r->rpm(), 1000);
+        QSignalSpy spy(engine_r.data(), &EngineReplica::rpmChanged);
+
+        engine_r->pause();
+        QVERIFY(engine_r->isPaused());
+        // A reply is received while paused, and means the host saw the pause
+        QRemoteObjectPendingReply<QString> reply = engine_r->myTestString();
+        QVERIFY(reply.waitForFinished());
+
+        e.setRpm(2000);
+        e.setRpm(3000);
+        reply = engine_r->myTestString();
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(engine_r->rpm(), 1000);
+        QCOMPARE(spy.count(), 0);
+
+        // Only the latest value is sent on resume
+        engine_r->resume();
+        QVERIFY(!engine_r->isPaused());
+        QTRY_COMPARE(engine_r->rpm(), 3000);
+        QCOMPARE(spy.count(), 1);
+
+        e.setRpm(4000);
+        QTRY_COMPARE(engine_r->rpm(), 4000);
+        QCOMPARE(spy.count(), 2);
+    }
+
+    void sharedPauseResumeTest()
+    {
+        QFETCH_GLOBAL(QUrl, hostUrl);
+        if (hostUrl.isEmpty())
+            QSKIP("Only nodes connecting to a url share connections");
+
+        setupHost();
+        Engine e;
+        e.setRpm(1000);
+        host->enableRemoting(&e);
+
+        setupSharedClient();
+        QRemoteObjectNode client2;
+        client2.setSharedConnectionsEnabled(true);
+        client2.connectToNode(hostUrl);
+
+        const QScopedPointer<EngineReplica> engine_r1(client->acquire<EngineReplica>());
+        QVERIFY(engine_r1->waitForSource());
+        const QScopedPointer<EngineReplica> engine_r2(client2.acquire<EngineReplica>());
+        QVERIFY(engine_r2->waitForSource());
+        QSignalSpy spy1(engine_r1.data(), &EngineReplica::rpmChanged);
+        QSignalSpy spy2(engine_r2.data(), &EngineReplica::rpmChanged);
+
+        // Paused on one node only, the other one still gets every update
+        engine_r1->pause();
+        QRemoteObjectPendingReply<QString> reply = engine_r1->myTestString();
+        QVERIFY(reply.waitForFinished());
+        e.setRpm(2000);
+        e.setRpm(3000);
+        QTRY_COMPARE(engine_r2->rpm(), 3000);
+        QCOMPARE(spy2.count(), 2);
+        reply = engine_r1->myTestString();
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(engine_r1->rpm(), 1000);
+        QCOMPARE(spy1.count(), 0);
+
+        engine_r1->resume();
+        QTRY_COMPARE(engine_r1->rpm(), 3000);
+        QCOMPARE(spy1.count(), 1);
+
+        // Paused on both nodes, the host holds the updates back
+        engine_r1->pause();
+        engine_r2->pause();
+        reply = engine_r2->myTestString();
+        QVERIFY(reply.waitForFinished());
+        e.setRpm(4000);
+        reply = engine_r2->myTestString();
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(engine_r1->rpm(), 3000);
+        QCOMPARE(engine_r2->rpm(), 3000);
+
+        engine_r1->resume();
+        QTRY_COMPARE(engine_r1->rpm(), 4000);
+        QCOMPARE(spy1.count(), 2);
+        QVERIFY(engine_r2->isPaused());
+        reply = engine_r2->myTestString();
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(engine_r2->rpm(), 3000);
+
+        engine_r2->resume();
+        QTRY_COMPARE(engine_r2->rpm(), 4000);
+        QCOMPARE(spy2.count(), 3);
+
+        e.setRpm(5000);
+        QTRY_COMPARE(engine_r1->rpm(), 5000);
+        QTRY_COMPARE(engine_r2->rpm(), 5000);
+    }
+
+    void invokeLimitTest()
+    {
+        setupHost();
+        Engine e;
+        host->enableRemoting(&e);
+        QVERIFY(host->setMaxInvokeRate(1));
+        QVERIFY(host->setMaxQueuedInvokes(0));
+
+        setupClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+
+        // The burst exceeds the rate, nothing waits in a queue
+        QList<QRemoteObjectPendingReply<QString>> replies;
+        for (int i = 0; i < 5; ++i)
+            replies << engine_r->myTestString();
+        int rejected = 0;
+        for (auto &reply : replies) {
+            QVERIFY(reply.waitForFinished());
+            if (reply.error() == QRemoteObjectPendingCall::Rejected)
+                ++rejected;
+        }
+        QCOMPARE(replies.first().error(), QRemoteObjectPendingCall::NoError);
+        QCOMPARE(replies.first().returnValue(), e.myTestString());
+        QVERIFY(rejected > 0);
+
+        const QVariantMap stats = host->invokeStatistics();
+        QCOMPARE(stats.value(QStringLiteral("rejected")).toInt(), rejected);
+        QCOMPARE(stats.value(QStringLiteral("invoked")).toInt(), 5 - rejected);
+        QCOMPARE(stats.value(QStringLiteral("queued")).toInt(), 0);
+
+        QVERIFY(host->setMaxInvokeRate(0));
+        QRemoteObjectPendingReply<QString> reply = engine_r->myTestString();
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.error(), QRemoteObjectPendingCall::NoError);
+    }
+
+    void pacedInitTest()
+    {
+        setupHost();
+        Engine e;
+        e.setRpm(1000);
+        host->enableRemoting(&e);
+        Speedometer s;
+        s.setMph(88);
+        host->enableRemoting(&s);
+        QVERIFY(host->setMaxConcurrentInits(1));
+        // Less than one init packet per second, which holds the name, the
+        // signature and the values of the source
+        const int rate = 64;
+        QVERIFY(host->setMaxInitRate(rate));
+
+        setupClient();
+
+        // Every replica is initialized, one after the other
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        const QScopedPointer<SpeedometerReplica> speedometer_r(client->acquire<SpeedometerReplica>());
+        QElapsedTimer timer;
+        timer.start();
+        qint64 engineInitializedAt = -1;
+        bool speedometerWasInitialized = true;
+        int queuedInits = -1;
+        connect(engine_r.data(), &EngineReplica::initialized, this, [&]() {
+            engineInitializedAt = timer.elapsed();
+            speedometerWasInitialized = speedometer_r->isInitialized();
+            queuedInits = host->memoryUsage().value(QStringLiteral("queuedInits")).toInt();
+        });
+        QVERIFY(engine_r->waitForSource());
+        QVERIFY(speedometer_r->waitForSource());
+        const qint64 speedometerInitializedAt = timer.elapsed();
+        QCOMPARE(engine_r->rpm(), 1000);
+        QCOMPARE(speedometer_r->mph(), 88);
+        QTRY_COMPARE(host->memoryUsage().value(QStringLiteral("queuedInits")).toInt(), 0);
+
+        // The init of the speedometer waited in the queue for a later pass,
+        // until the budget the engine's init used up was refilled
+        QVERIFY(engineInitializedAt >= 0);
+        QVERIFY(!speedometerWasInitialized);
+        QCOMPARE(queuedInits, 1);
+        QVERIFY(speedometerInitializedAt - engineInitializedAt >= 1000 / rate);
+
+        // Initialized replicas still get updates right away
+        e.setRpm(2000);
+        QTRY_COMPARE(engine_r->rpm(), 2000);
+    }
+
+    void sharedStateTest()
+    {
+        setupHost();
+        Engine e;
+        e.setRpm(1000);
+        host->enableRemoting(&e);
+        QVERIFY(host->setSharedStateEnabled(true));
+
+        setupClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        QCOMPARE(engine_r->rpm(), 1000);
+
+        // Clients on local sockets read the values from shared memory
+        QSignalSpy rpmSpy(engine_r.data(), &EngineReplica::rpmChanged);
+        e.setRpm(2000);
+        QTRY_COMPARE(engine_r->rpm(), 2000);
+        QCOMPARE(rpmSpy.count(), 1);
+        QCOMPARE(rpmSpy.takeFirst().at(0).toInt(), 2000);
+
+        // Changes in one pass of the event loop may arrive together
+        e.setRpm(2100);
+        e.setRpm(2200);
+        QTRY_COMPARE(engine_r->rpm(), 2200);
+        QVERIFY(!rpmSpy.isEmpty());
+        QCOMPARE(rpmSpy.last().at(0).toInt(), 2200);
+
+        // Values that didn't change keep their version on the page
+        QSignalSpy startedSpy(engine_r.data(), &EngineReplica::startedChanged);
+        e.setRpm(2300);
+        QTRY_COMPARE(engine_r->rpm(), 2300);
+        QCOMPARE(startedSpy.count(), 0);
+        QVERIFY(!engine_r->started());
+        QCOMPARE(engine_r->cylinders(), e.cylinders());
+
+        // The reply of a call comes after the changes it made
+        QRemoteObjectPendingReply<bool> reply = engine_r->start();
+        QVERIFY(reply.waitForFinished());
+        QVERIFY(reply.returnValue());
+        QVERIFY(engine_r->started());
+
+        // Signals carrying more than the new value arrive as they were emitted
+        TestPreviousValueNotify t;
+        host->enableRemoting(&t, QStringLiteral("previousValue"));
+        const QScopedPointer<QRemoteObjectDynamicReplica> rep(client->acquireDynamic(QStringLiteral("previousValue")));
+        QVERIFY(rep->waitForSource());
+        QSignalSpy valueSpy(rep.data(), SIGNAL(valueChanged(int,int)));
+        t.setValue(5);
+        QTRY_COMPARE(valueSpy.count(), 1);
+        QCOMPARE(valueSpy.first().at(0).toInt(), 0);
+        QCOMPARE(valueSpy.first().at(1).toInt(), 5);
+        QCOMPARE(rep->property("value").toInt(), 5);
+    }
+
+    void multicastTest()
+    {
+        setupHost();
+        Engine e;
+        e.setRpm(1000);
+        host->enableRemoting(&e);
+        QVERIFY(!host->setMulticastUrl(QStringLiteral("Engine"), QUrl(QStringLiteral("udp://127.0.0.1:65513"))));
+        QVERIFY(host->setMulticastUrl(QStringLiteral("Engine"), QUrl(QStringLiteral("udp://239.255.43.21:65513"))));
+
+        setupClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        QCOMPARE(engine_r->rpm(), 1000);
+        const auto multicastListeners = [this]() {
+            const QVariantMap sources = host->memoryUsage().value(QStringLiteral("sources")).toMap();
+            return sources.value(QStringLiteral("Engine")).toMap().value(QStringLiteral("multicastListeners")).toInt();
+        };
+        if (!QTest::qWaitFor([&]() { return multicastListeners() == 1; }, 2000))
+            QSKIP("Can't join multicast groups on this machine");
+
+        QSignalSpy spy(engine_r.data(), &EngineReplica::rpmChanged);
+        for (int i = 1; i <= 10; ++i)
+            e.setRpm(1000 + i);
+        QTRY_COMPARE(engine_r->rpm(), 1010);
+        QCOMPARE(spy.last().at(0).toInt(), 1010);
+
+        // Only property changes of the Source and their notify signals are
+        // taken from a datagram, anything else anyone sends is dropped
+        const QHostAddress group(QStringLiteral("239.255.43.21"));
+        QUdpSocket socket;
+        QVERIFY(socket.bind(QHostAddress::AnyIPv4, 65513, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint));
+        QVERIFY(socket.joinMulticastGroup(group));
+        e.setRpm(1011);
+        QTRY_COMPARE(engine_r->rpm(), 1011);
+        // The datagram of the change, not a heartbeat repeating an earlier one
+        quint32 sequence = 0;
+        QString name;
+        quint64 sourceId = 0;
+        const auto readChange = [&]() {
+            while (socket.hasPendingDatagrams()) {
+                const QByteArray data = socket.receiveDatagram().data();
+                QDataStream header(data);
+                header.setVersion(QDataStream::Qt_5_12);
+                header >> sequence >> name >> sourceId;
+                if (!header.atEnd())
+                    return true;
+            }
+            return false;
+        };
+        QTRY_VERIFY(readChange());
+        QCOMPARE(name, QStringLiteral("Engine"));
+        const auto packet = [](QtRemoteObjects::QRemoteObjectPacketTypeEnum type, const QString &objectName,
+                               const std::function<void(QDataStream &)> &payload) {
+            QByteArray data;
+            QDataStream ds(&data, QIODevice::WriteOnly);
+            ds.setVersion(QDataStream::Qt_5_12);
+            ds << quint32(0) << quint16(type) << objectName;
+            payload(ds);
+            ds.device()->seek(0);
+            ds << quint32(data.size() - sizeof(quint32));
+            return data;
+        };
+        const auto datagram = [&](quint32 sequence, const QByteArray &packets) {
+            QByteArray data;
+            QDataStream ds(&data, QIODevice::WriteOnly);
+            ds.setVersion(QDataStream::Qt_5_12);
+            ds << sequence << name << sourceId;
+            return data + packets;
+        };
+        const int rpmIndex = EngineReplica::staticMetaObject.indexOfProperty("rpm") - EngineReplica::staticMetaObject.propertyOffset();
+        const auto rpmChange = [&](const QString &objectName, int rpm) {
+            return packet(QtRemoteObjects::PropertyChangePacket, objectName, [&](QDataStream &ds) { ds << rpmIndex << QVariant(rpm); });
+        };
+        // A change of another object and a signal that isn't a notify signal
+        const QByteArray invoke = packet(QtRemoteObjects::InvokePacket, name, [](QDataStream &ds) {
+            ds << int(QMetaObject::InvokeMetaMethod) << 0 << quint32(1) << QVariant(5000) << -1 << -1;
+        });
+        const int signalCount = spy.count();
+        socket.writeDatagram(datagram(sequence + 1, rpmChange(QStringLiteral("Other"), 5000) + invoke), group, 65513);
+        socket.writeDatagram(datagram(sequence + 2, rpmChange(name, 1500)), group, 65513);
+        QTRY_COMPARE(engine_r->rpm(), 1500);
+        QCOMPARE(spy.count(), signalCount);
+
+        // Calls and their replies still use the connection
+        e.setMyTestString(QStringLiteral("multicast"));
+        QRemoteObjectPendingReply<QString> reply = engine_r->myTestString();
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("multicast"));
+
+        // Without a group, changes go over the connection again
+        QVERIFY(host->setMulticastUrl(QStringLiteral("Engine"), QUrl()));
+        QCOMPARE(multicastListeners(), 0);
+        e.setRpm(3000);
+        QTRY_COMPARE(engine_r->rpm(), 3000);
+    }
+
+    void batchTest()
+    {
+        setupHost();
+        Engine e;
+        e.setRpm(1000);
+        host->enableRemoting(&e);
+
+        setupClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+
+        // The calls run in order, the results come with the reply of the batch
+        engine_r->beginBatch();
+        engine_r->setRpm(1500);
+        engine_r->increaseRpm(100);
+        engine_r->setMyTestString(QStringLiteral("batch"));
+        QRemoteObjectPendingReply<QString> testString = engine_r->myTestString();
+        QRemoteObjectPendingReply<bool> started = engine_r->start();
+        QRemoteObjectPendingReply<bool> startedAgain = engine_r->start();
+        QVERIFY(!testString.isFinished());
+        QRemoteObjectPendingCall batch = engine_r->submitBatch();
+        QVERIFY(batch.waitForFinished());
+        QCOMPARE(batch.error(), QRemoteObjectPendingCall::NoError);
+        QVERIFY(testString.isFinished());
+        QCOMPARE(testString.returnValue(), QStringLiteral("batch"));
+        QVERIFY(started.isFinished());
+        QVERIFY(started.returnValue());
+        QVERIFY(startedAgain.isFinished());
+        QVERIFY(!startedAgain.returnValue());
+        QCOMPARE(e.rpm(), 1600);
+        QTRY_COMPARE(engine_r->rpm(), 1600);
+
+        // An empty batch is finished right away
+        engine_r->beginBatch();
+        batch = engine_r->submitBatch();
+        QVERIFY(batch.isFinished());
+        QCOMPARE(batch.error(), QRemoteObjectPendingCall::NoError);
+    }
+
+    void cachedSlotTest()
+    {
+        setupHost();
+        Engine e;
+        e.setRpm(1000);
+        e.setMyTestString(QStringLiteral("first"));
+        host->enableRemoting(&e);
+
+        setupClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+
+        // Identical calls in flight share one call
+        QRemoteObjectPendingReply<QString> reply = engine_r->cachedTestString(1);
+        QRemoteObjectPendingReply<QString> sameReply = engine_r->cachedTestString(1);
+        QRemoteObjectPendingReply<QString> otherReply = engine_r->cachedTestString(2);
+        QVERIFY(reply.waitForFinished());
+        QVERIFY(otherReply.waitForFinished());
+        QVERIFY(sameReply.isFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("first1"));
+        QCOMPARE(sameReply.returnValue(), QStringLiteral("first1"));
+        QCOMPARE(otherReply.returnValue(), QStringLiteral("first2"));
+        QCOMPARE(e.cachedTestStringCalls, 2);
+
+        // Repeated calls are served from the cache
+        e.setMyTestString(QStringLiteral("second"));
+        reply = engine_r->cachedTestString(1);
+        QVERIFY(reply.isFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("first1"));
+        QCOMPARE(e.cachedTestStringCalls, 2);
+
+        // A change of rpm invalidates the cached replies
+        QSignalSpy spy(engine_r.data(), &EngineReplica::rpmChanged);
+        e.setRpm(1500);
+        QVERIFY(spy.wait());
+        reply = engine_r->cachedTestString(1);
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("second1"));
+        QCOMPARE(e.cachedTestStringCalls, 3);
+    }
+
+    void cachedSlotExpiryTest()
+    {
+        setupHost();
+        Engine e;
+        e.setMyTestString(QStringLiteral("first"));
+        host->enableRemoting(&e);
+
+        setupClient();
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+
+        QRemoteObjectPendingReply<QString> reply = engine_r->expiringTestString(1);
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("first1"));
+        QCOMPARE(e.cachedTestStringCalls, 1);
+
+        // The reply is kept for its ttl of 200ms
+        e.setMyTestString(QStringLiteral("second"));
+        QElapsedTimer timer;
+        timer.start();
+        reply = engine_r->expiringTestString(1);
+        QVERIFY(reply.isFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("first1"));
+        QCOMPARE(e.cachedTestStringCalls, 1);
+
+        // and asked for again once it expired
+        QTest::qWait(qMax(0, 400 - int(timer.elapsed())));
+        reply = engine_r->expiringTestString(1);
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("second1"));
+        QCOMPARE(e.cachedTestStringCalls, 2);
+    }
+
+    void cachedSlotCacheSizeTest()
+    {
+        setupHost();
+        Engine e;
+        e.setMyTestString(QStringLiteral("first"));
+        host->enableRemoting(&e);
+
+        // Replicas of a node with a cache size of 0 keep no replies
+        client = new QRemoteObjectNode;
+        Q_SET_OBJECT_NAME(*client);
+        QCOMPARE(client->replyCacheSize(), 128);
+        client->setReplyCacheSize(-1);
+        QCOMPARE(client->replyCacheSize(), 0);
+        connectClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        QRemoteObjectPendingReply<QString> reply = engine_r->cachedTestString(1);
+        QVERIFY(reply.waitForFinished());
+        reply = engine_r->cachedTestString(1);
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("first1"));
+        QCOMPARE(e.cachedTestStringCalls, 2);
+    }
+
+    void cachedSlotDisconnectTest()
+    {
+        QFETCH_GLOBAL(QUrl, hostUrl);
+        if (hostUrl.isEmpty())
+            QSKIP("The host doesn't own the connection");
+
+        setupHost();
+        Engine e;
+        e.setMyTestString(QStringLiteral("first"));
+        host->enableRemoting(&e);
+
+        setupClient();
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+
+        QRemoteObjectPendingReply<QString> reply = engine_r->cachedTestString(1);
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("first1"));
+        reply = engine_r->cachedTestString(1);
+        QVERIFY(reply.isFinished());
+        QCOMPARE(e.cachedTestStringCalls, 1);
+
+        // Losing the connection drops the cached replies, the call can't be
+        // answered anymore
+        delete host;
+        host = nullptr;
+        QTRY_COMPARE(engine_r->state(), QRemoteObjectReplica::Suspect);
+        reply = engine_r->cachedTestString(1);
+        QVERIFY(!reply.isFinished());
+        QCOMPARE(reply.error(), QRemoteObjectPendingCall::InvalidMessage);
+    }
+
+    void replicaHandleTest()
+    {
+        struct Observer : QRemoteObjectReplicaObserver
+        {
+            void initialized(const QRemoteObjectReplicaHandle &handle) override { initializedNames << handle.name(); }
+            void propertyChanged(const QRemoteObjectReplicaHandle &handle, int index, const QVariant &value) override
+            {
+                changes << qMakePair(handle.name(), QByteArray(handle.metaObject()->property(index + handle.metaObject()->propertyOffset()).name()));
+                lastValue = value;
+            }
+            QStringList initializedNames;
+            QList<QPair<QString, QByteArray>> changes;
+            QVariant lastValue;
+        } observer;
+
+        setupHost();
+        Engine e1, e2;
+        e1.setRpm(1000);
+        e2.setRpm(2000);
+        host->enableRemoting(&e1, QStringLiteral("EngineA"));
+        host->enableRemoting(&e2, QStringLiteral("EngineB"));
+
+        setupClient();
+
+        QRemoteObjectReplicaHandle a = client->acquireHandle(QStringLiteral("EngineA"), &observer);
+        QVERIFY(a.isValid());
+        QTRY_VERIFY(a.isInitialized());
+        // The second handle of the type is initialized without the type definition
+        QRemoteObjectReplicaHandle b = client->acquireHandle(QStringLiteral("EngineB"), &observer);
+        QVERIFY(!b.isInitialized());
+        QTRY_VERIFY(b.isInitialized());
+        QCOMPARE(observer.initializedNames, QStringList({QStringLiteral("EngineA"), QStringLiteral("EngineB")}));
+        QCOMPARE(a.metaObject(), b.metaObject());
+        QCOMPARE(a.property("rpm").toInt(), 1000);
+        QCOMPARE(b.property("rpm").toInt(), 2000);
+        QVERIFY(!client->acquireHandle(QStringLiteral("EngineA"), &observer).isValid());
+
+        e2.setRpm(2500);
+        QTRY_COMPARE(b.property("rpm").toInt(), 2500);
+        QCOMPARE(observer.changes.size(), 1);
+        QCOMPARE(observer.changes.first(), qMakePair(QStringLiteral("EngineB"), QByteArray("rpm")));
+        QCOMPARE(observer.lastValue.toInt(), 2500);
+
+        const QRemoteObjectReplicaHandle copy = b;
+        b.release();
+        QVERIFY(!b.isValid());
+        QVERIFY(!copy.isValid());
+        QCOMPARE(a.property("rpm").toInt(), 1000);
+
+        // A lost Source leaves the handle valid, but no longer initialized
+        QVERIFY(host->disableRemoting(&e1));
+        QTRY_VERIFY(!a.isInitialized());
+        QVERIFY(a.isValid());
+        QCOMPARE(a.property("rpm").toInt(), 1000);
+
+        // Plain QObjects have no signature, each handle gets its own type
+        TestDynamic dynamic;
+        dynamic.setOtherValue(5);
+        TestPreviousValueNotify notify;
+        notify.setValue(7);
+        host->enableRemoting(&dynamic, QStringLiteral("plainA"));
+        host->enableRemoting(&notify, QStringLiteral("plainB"));
+        QRemoteObjectReplicaHandle plainA = client->acquireHandle(QStringLiteral("plainA"), &observer);
+        QTRY_VERIFY(plainA.isInitialized());
+        QRemoteObjectReplicaHandle plainB = client->acquireHandle(QStringLiteral("plainB"), &observer);
+        QTRY_VERIFY(plainB.isInitialized());
+        QVERIFY(plainA.metaObject() != plainB.metaObject());
+        QVERIFY(plainA.metaObject()->indexOfProperty("otherValue") >= 0);
+        QCOMPARE(plainB.metaObject()->indexOfProperty("otherValue"), -1);
+        QCOMPARE(plainA.property("otherValue").toInt(), 5);
+        QCOMPARE(plainB.property("value").toInt(), 7);
+    }
+
+    void propertySnapshotTest()
+    {
+        setupHost();
+        Engine e;
+        e.setRpm(1234);
+        host->enableRemoting(&e);
+
+        setupClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        const QVariantMap snapshot = engine_r->propertySnapshot();
+        QCOMPARE(snapshot.value(QStringLiteral("rpm")).toInt(), 1234);
+        QCOMPARE(snapshot.value(QStringLiteral("cylinders")).toInt(), e.cylinders());
+
+        QSignalSpy spy(engine_r.data(), &QRemoteObjectReplica::propertySnapshotChanged);
+        e.setRpm(2345);
+        QTRY_COMPARE(engine_r->propertySnapshot().value(QStringLiteral("rpm")).toInt(), 2345);
+        QVERIFY(spy.count() > 0);
+        // snapshots handed out earlier are not changed
+        QCOMPARE(snapshot.value(QStringLiteral("rpm")).toInt(), 1234);
+
+        const QVariantMap selected = engine_r->propertySnapshotOf({QStringLiteral("rpm"), QStringLiteral("noSuchProperty")});
+        QCOMPARE(selected.size(), 1);
+        QCOMPARE(selected.value(QStringLiteral("rpm")).toInt(), 2345);
+
+        // In process, the snapshot is kept until the source notifies a change
+        const QScopedPointer<EngineReplica> engine_r_inProc(host->acquire<EngineReplica>());
+        QVERIFY(engine_r_inProc->waitForSource());
+        QCOMPARE(engine_r_inProc->propertySnapshot().value(QStringLiteral("rpm")).toInt(), 2345);
+        QSignalSpy inProcSpy(engine_r_inProc.data(), &QRemoteObjectReplica::propertySnapshotChanged);
+        e.setRpm(3456);
+        QCOMPARE(inProcSpy.count(), 1);
+        QCOMPARE(engine_r_inProc->propertySnapshot().value(QStringLiteral("rpm")).toInt(), 3456);
+    }
+
     void dynamicNotifyTest()
     {
         setupHost();
@@ -1112,6 +1835,235 @@ private slots:
         QCOMPARE(speedometer_r->mph(), s.mph());
     }
 
+    void sharedConnectionTest()
+    {
+        QFETCH_GLOBAL(QUrl, hostUrl);
+        if (hostUrl.isEmpty())
+            QSKIP("Only nodes connecting to a url share connections");
+
+        setupHost();
+        Engine e;
+        host->enableRemoting(&e);
+        e.setRpm(1234);
+        e.setStarted(false);
+
+        setupSharedClient();
+        QRemoteObjectNode client2;
+        client2.setSharedConnectionsEnabled(true);
+        client2.connectToNode(hostUrl);
+
+        const QScopedPointer<EngineReplica> engine_r1(client->acquire<EngineReplica>());
+        QVERIFY(engine_r1->waitForSource());
+        e.setRpm(2345);
+        QTRY_COMPARE(engine_r1->rpm(), 2345);
+
+        // The second node is initialized by the shared connection, the host
+        // keeps one connection with one listener
+        QSignalSpy stateSpy(engine_r1.data(), &QRemoteObjectReplica::stateChanged);
+        QScopedPointer<EngineReplica> engine_r2(client2.acquire<EngineReplica>());
+        QVERIFY(engine_r2->waitForSource());
+        QCOMPARE(engine_r1->rpm(), e.rpm());
+        QCOMPARE(engine_r2->rpm(), e.rpm());
+        QCOMPARE(stateSpy.count(), 0);
+        QVariantMap usage = host->memoryUsage();
+        QCOMPARE(usage.value(QStringLiteral("connections")).toList().size(), 1);
+        QCOMPARE(usage.value(QStringLiteral("sources")).toMap().value(QStringLiteral("Engine")).toMap()
+                      .value(QStringLiteral("listeners")).toInt(), 1);
+
+        // Nodes of other threads share the connection as well
+        QAtomicInt threadRpm = 0;
+        QScopedPointer<QThread> thread(QThread::create([&threadRpm, hostUrl]() {
+            QRemoteObjectNode threadNode;
+            threadNode.setSharedConnectionsEnabled(true);
+            threadNode.connectToNode(hostUrl);
+            const QScopedPointer<EngineReplica> engine_r3(threadNode.acquire<EngineReplica>());
+            if (engine_r3->waitForSource())
+                threadRpm.storeRelaxed(engine_r3->rpm());
+        }));
+        thread->start();
+        QTRY_VERIFY(thread->isFinished());
+        QCOMPARE(threadRpm.loadRelaxed(), 2345);
+        usage = host->memoryUsage();
+        QCOMPARE(usage.value(QStringLiteral("connections")).toList().size(), 1);
+
+        e.setRpm(4321);
+        QTRY_COMPARE(engine_r1->rpm(), 4321);
+        QTRY_COMPARE(engine_r2->rpm(), 4321);
+
+        QRemoteObjectPendingReply<bool> reply = engine_r2->start();
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.returnValue(), true);
+        QTRY_COMPARE(engine_r1->started(), true);
+
+        QRemoteObjectPendingReply<QString> stringReply = engine_r1->myTestString();
+        QVERIFY(stringReply.waitForFinished());
+        QCOMPARE(stringReply.returnValue(), e.myTestString());
+
+        // Batches of both nodes are answered to the node that sent them
+        e.setMyTestString(QStringLiteral("shared"));
+        engine_r1->beginBatch();
+        QRemoteObjectPendingReply<bool> started1 = engine_r1->start();
+        QRemoteObjectPendingCall batch1 = engine_r1->submitBatch();
+        engine_r2->beginBatch();
+        QRemoteObjectPendingReply<QString> string2 = engine_r2->myTestString();
+        QRemoteObjectPendingCall batch2 = engine_r2->submitBatch();
+        QVERIFY(batch1.waitForFinished());
+        QVERIFY(batch2.waitForFinished());
+        QCOMPARE(batch1.error(), QRemoteObjectPendingCall::NoError);
+        QCOMPARE(batch2.error(), QRemoteObjectPendingCall::NoError);
+        QVERIFY(started1.isFinished());
+        QCOMPARE(started1.returnValue(), false);
+        QVERIFY(string2.isFinished());
+        QCOMPARE(string2.returnValue(), QStringLiteral("shared"));
+
+        // A node that didn't enable sharing opens its own connection
+        QRemoteObjectNode client3;
+        client3.connectToNode(hostUrl);
+        const QScopedPointer<EngineReplica> engine_r3(client3.acquire<EngineReplica>());
+        QVERIFY(engine_r3->waitForSource());
+        usage = host->memoryUsage();
+        QCOMPARE(usage.value(QStringLiteral("connections")).toList().size(), 2);
+
+        // The remaining replica keeps receiving changes
+        engine_r2.reset();
+        QTest::qWait(100);
+        e.setRpm(42);
+        QTRY_COMPARE(engine_r1->rpm(), 42);
+    }
+
+    void sequenceNumbersTest()
+    {
+        setupHost();
+        Engine e;
+        host->enableRemoting(&e);
+        e.setRpm(1000);
+        client = new QRemoteObjectNode;
+        Q_SET_OBJECT_NAME(*client);
+        client->setSequenceNumbersEnabled(true);
+        connectClient();
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        QCOMPARE(engine_r->rpm(), 1000);
+
+        QSignalSpy spy(engine_r.data(), &EngineReplica::rpmChanged);
+        for (int i = 1; i <= 10; ++i)
+            e.setRpm(1000 + i);
+        QTRY_COMPARE(spy.count(), 10);
+        QCOMPARE(engine_r->rpm(), 1010);
+
+        e.setMyTestString(QStringLiteral("sequenced"));
+        QRemoteObjectPendingReply<QString> reply = engine_r->myTestString();
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.returnValue(), QStringLiteral("sequenced"));
+        // A second replica is initialized from the sequenced connection as well
+        const QScopedPointer<EngineReplica> engine_r2(client->acquire<EngineReplica>());
+        QVERIFY(engine_r2->waitForSource());
+        QCOMPARE(engine_r2->rpm(), 1010);
+    }
+
+    void sequenceGapTest()
+    {
+        QFETCH_GLOBAL(QUrl, hostUrl);
+        if (!hostUrl.isEmpty())
+            QSKIP("Packets are only dropped between external QIODevices");
+
+        setupHost();
+        Engine e;
+        host->enableRemoting(&e);
+        e.setRpm(1000);
+
+        // The client is connected through a relay, which drops the next
+        // `drop` property change and signal packets of the host
+        QTcpSocket relayOut;
+        relayOut.connectToHost(QHostAddress::LocalHost, tcpServer->serverPort());
+        QVERIFY(relayOut.waitForConnected(5000));
+        QVERIFY(tcpServer->waitForNewConnection(5000));
+        QTcpSocket *clientSide = tcpServer->nextPendingConnection();
+        int drop = 0;
+        QByteArray buffer;
+        QObject relay;
+        connect(socketClient, &QIODevice::readyRead, &relay, [&]() {
+            buffer += socketClient->readAll();
+            while (buffer.size() >= qsizetype(sizeof(quint32))) {
+                const qsizetype size = sizeof(quint32) + qFromBigEndian<quint32>(buffer.constData());
+                if (buffer.size() < size)
+                    return;
+                const quint16 type = qFromBigEndian<quint16>(buffer.constData() + sizeof(quint32));
+                if (drop > 0 && (type == QtRemoteObjects::PropertyChangePacket || type == QtRemoteObjects::InvokePacket))
+                    --drop;
+                else
+                    relayOut.write(buffer.constData(), size);
+                buffer.remove(0, size);
+            }
+        });
+        connect(&relayOut, &QIODevice::readyRead, &relay, [&]() {
+            socketClient->write(relayOut.readAll());
+        });
+
+        client = new QRemoteObjectNode;
+        Q_SET_OBJECT_NAME(*client);
+        client->setSequenceNumbersEnabled(true);
+        client->addClientSideConnection(clientSide);
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        QCOMPARE(engine_r->rpm(), 1000);
+        QCOMPARE(engine_r->started(), false);
+
+        // Both packets of the started change are lost
+        drop = 2;
+        e.setStarted(true);
+        QTRY_COMPARE(drop, 0);
+        QTest::qWait(100);
+        QCOMPARE(engine_r->started(), false);
+
+        // The next change reveals the gap, the replica applies it and
+        // resyncs to get the lost value
+        e.setRpm(2000);
+        QTRY_COMPARE(engine_r->rpm(), 2000);
+        QTRY_COMPARE(engine_r->started(), true);
+        QCOMPARE(engine_r->state(), QRemoteObjectReplica::Valid);
+
+        // Updates after the resync arrive in sequence again
+        QSignalSpy spy(engine_r.data(), &EngineReplica::rpmChanged);
+        e.setRpm(2001);
+        QTRY_COMPARE(spy.count(), 1);
+        QCOMPARE(engine_r->rpm(), 2001);
+    }
+
+    void memoryUsageTest()
+    {
+        setupHost();
+        QVERIFY(host->memoryUsage().value(QStringLiteral("sources")).toMap().isEmpty());
+
+        Engine e;
+        host->enableRemoting(&e);
+        setupClient();
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+
+        const QVariantMap usage = host->memoryUsage();
+        QVERIFY(usage.value(QStringLiteral("totalBytes")).toLongLong() > 0);
+
+        const QVariantList connections = usage.value(QStringLiteral("connections")).toList();
+        QCOMPARE(connections.size(), 1);
+        QCOMPARE(connections.first().toMap().value(QStringLiteral("sources")).toStringList(),
+                 QStringList(QStringLiteral("Engine")));
+
+        const QVariantMap engine = usage.value(QStringLiteral("sources")).toMap()
+                                        .value(QStringLiteral("Engine")).toMap();
+        QCOMPARE(engine.value(QStringLiteral("listeners")).toInt(), 1);
+        QVERIFY(engine.value(QStringLiteral("packetBytes")).toLongLong() > 0);
+
+        // The usage is logged periodically on request
+        QLoggingCategory::setFilterRules("qt.remoteobjects.warning=false\nqt.remoteobjects.debug=true");
+        QTest::ignoreMessage(QtDebugMsg, QRegularExpression(QStringLiteral("Memory usage .* total bytes")));
+        QVERIFY(host->setMemoryReportInterval(10));
+        QTest::qWait(50);
+        QVERIFY(host->setMemoryReportInterval(0));
+        QLoggingCategory::setFilterRules("qt.remoteobjects.warning=false");
+    }
+
     void rawDynamicReplicaTest()
     {
         setupHost();
@@ -1294,6 +2246,100 @@ private slots:
         QVERIFY(host->disableRemoting(&t));
     }
 
+    void fragmentedDataTest()
+    {
+        // Packets larger than 1000 bytes are sent as fragments, both ways
+        TestLargeData t;
+        Engine e;
+        host = new QRemoteObjectHost;
+        SET_NODE_NAME(*host);
+        host->setMaxFrameSize(1000);
+        listenHost();
+        host->enableRemoting(&t, QStringLiteral("large"));
+        host->enableRemoting(&e);
+        client = new QRemoteObjectNode;
+        Q_SET_OBJECT_NAME(*client);
+        client->setMaxFrameSize(1000);
+        connectClient();
+
+        const QScopedPointer<QRemoteObjectDynamicReplica> rep(client->acquireDynamic(QStringLiteral("large")));
+        QVERIFY(rep->waitForSource());
+        const QMetaMethod mm = rep->metaObject()->method(rep->metaObject()->indexOfSignal("send(QByteArray)"));
+        QSignalSpy spy(rep.data(), QByteArray(QByteArrayLiteral("2")+mm.methodSignature().constData()));
+        const QByteArray data(100000, 'y');
+        emit t.send(data);
+        emit t.send(QByteArray("small"));
+        QTRY_COMPARE(spy.count(), 2);
+        QVERIFY(spy.at(0).at(0).toByteArray() == data);
+        QCOMPARE(spy.at(1).at(0).toByteArray(), QByteArray("small"));
+
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        const QString text(50000, QLatin1Char('x'));
+        engine_r->setMyTestString(text);
+        QRemoteObjectPendingReply<QString> reply = engine_r->myTestString();
+        QVERIFY(reply.waitForFinished());
+        QCOMPARE(reply.returnValue(), text);
+
+        QFETCH_GLOBAL(QUrl, hostUrl);
+        if (hostUrl.isEmpty())
+            return;
+
+        // The message size only bounds packets reassembled from fragments
+        QRemoteObjectNode wholeClient;
+        wholeClient.setMaxMessageSize(50000);
+        wholeClient.connectToNode(hostUrl);
+        const QScopedPointer<QRemoteObjectDynamicReplica> wholeRep(wholeClient.acquireDynamic(QStringLiteral("large")));
+        QVERIFY(wholeRep->waitForSource());
+        QSignalSpy wholeSpy(wholeRep.data(), QByteArray(QByteArrayLiteral("2")+mm.methodSignature().constData()));
+
+        QRemoteObjectNode fragmentClient;
+        fragmentClient.setMaxFrameSize(1000);
+        fragmentClient.setMaxMessageSize(50000);
+        fragmentClient.connectToNode(hostUrl);
+        const QScopedPointer<QRemoteObjectDynamicReplica> fragmentRep(fragmentClient.acquireDynamic(QStringLiteral("large")));
+        QVERIFY(fragmentRep->waitForSource());
+        QSignalSpy stateSpy(fragmentRep.data(), &QRemoteObjectReplica::stateChanged);
+
+        emit t.send(data);
+        QTRY_COMPARE(wholeSpy.count(), 1);
+        QVERIFY(wholeSpy.at(0).at(0).toByteArray() == data);
+        QTRY_VERIFY(!stateSpy.isEmpty());
+        QCOMPARE(stateSpy.first().at(0).value<QRemoteObjectReplica::State>(), QRemoteObjectReplica::Suspect);
+    }
+
+    void hostClosedConnectionTest()
+    {
+        QFETCH_GLOBAL(QUrl, hostUrl);
+        if (hostUrl.isEmpty())
+            QSKIP("The host doesn't own the connection");
+
+        // The host closes a connection sending a too large packet
+        Engine e;
+        host = new QRemoteObjectHost;
+        SET_NODE_NAME(*host);
+        host->setMaxFrameSize(1000);
+        host->setMaxMessageSize(50000);
+        listenHost();
+        host->enableRemoting(&e);
+        const auto connections = [this]() {
+            return host->memoryUsage().value(QStringLiteral("connections")).toList().size();
+        };
+
+        setupClient();
+        const QScopedPointer<EngineReplica> engine_r(client->acquire<EngineReplica>());
+        QVERIFY(engine_r->waitForSource());
+        QCOMPARE(connections(), 1);
+
+        QSignalSpy stateSpy(engine_r.data(), &QRemoteObjectReplica::stateChanged);
+        engine_r->setMyTestString(QString(50000, QLatin1Char('x')));
+        QTRY_VERIFY(!stateSpy.isEmpty());
+        QCOMPARE(stateSpy.first().at(0).value<QRemoteObjectReplica::State>(), QRemoteObjectReplica::Suspect);
+        // and forgets about it like about one the client closed
+        QTRY_COMPARE(connections(), 0);
+        QCOMPARE(e.myTestString(), QString());
+    }
+
     void PODTest()
     {
         setupHost();
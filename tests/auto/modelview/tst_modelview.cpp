@@ -29,6 +29,7 @@
 #include "../shared/model_utilities.h"
 
 #include <QtTest/QtTest>
+#include <QCryptographicHash>
 #include <QAbstractItemModelTester>
 #include <QMetaType>
 #include <QRemoteObjectReplica>
@@ -550,6 +551,11 @@ private slots:
     void testCacheData_data();
     void testCacheData();
 
+    void testColumnWindow();
+    void testMergedDataChanged();
+    void testPersistedCache();
+    void testCorruptPersistedCache();
+
     void cleanup();
 };
 
@@ -1241,6 +1247,191 @@ void TestModelView::testChildSelection()
     QVERIFY(replicaSelectionModel->currentIndex().parent().isValid());
 }
 
+void TestModelView::testColumnWindow()
+{
+    _SETUP_TEST_
+    QList<int> roles = { Qt::DisplayRole };
+    QStandardItemModel wideModel(4, 100);
+    for (int row = 0; row < wideModel.rowCount(); ++row) {
+        for (int column = 0; column < wideModel.columnCount(); ++column)
+            wideModel.setData(wideModel.index(row, column), QString("%1,%2").arg(row).arg(column));
+    }
+    wideModel.item(1, 0)->appendRow(new QStandardItem(QString("child")));
+    basicServer.enableRemoting(&wideModel, "wideModel", roles);
+
+    QScopedPointer<QAbstractItemModelReplica> model(client.acquireModel("wideModel", QtRemoteObjects::FetchRootSize, roles));
+    QCOMPARE(model->columnWindowSize(), 64);
+    model->setColumnWindowSize(16);
+    QCOMPARE(model->columnWindowSize(), 16);
+    QTRY_COMPARE(model->rowCount(), wideModel.rowCount());
+    QCOMPARE(model->columnCount(), wideModel.columnCount());
+
+    const QModelIndex index = model->index(1, 40);
+    model->data(index);
+    QTRY_VERIFY(model->hasData(index, Qt::DisplayRole));
+    QCOMPARE(model->data(index), QVariant(QString("1,40")));
+
+    // Only the window of columns holding the index was fetched
+    QVERIFY(model->hasData(model->index(1, 32), Qt::DisplayRole));
+    QVERIFY(model->hasData(model->index(1, 47), Qt::DisplayRole));
+    QVERIFY(!model->hasData(model->index(1, 0), Qt::DisplayRole));
+    QVERIFY(!model->hasData(model->index(1, 48), Qt::DisplayRole));
+    // A window without the first column still tells whether the row has children
+    QVERIFY(model->hasChildren(model->index(1, 0)));
+    const QModelIndex other = model->index(2, 40);
+    model->data(other);
+    QTRY_VERIFY(model->hasData(other, Qt::DisplayRole));
+    QVERIFY(!model->hasChildren(model->index(2, 0)));
+
+    const QModelIndex first = model->index(1, 0);
+    model->data(first);
+    QTRY_VERIFY(model->hasData(first, Qt::DisplayRole));
+    QCOMPARE(model->data(first), QVariant(QString("1,0")));
+    QCOMPARE(model->data(index), QVariant(QString("1,40")));
+}
+
+void TestModelView::testMergedDataChanged()
+{
+    _SETUP_TEST_
+    QList<int> roles = { Qt::DisplayRole };
+    QStandardItemModel simpleModel(10, 2);
+    for (int row = 0; row < simpleModel.rowCount(); ++row) {
+        for (int column = 0; column < simpleModel.columnCount(); ++column)
+            simpleModel.setData(simpleModel.index(row, column), QString("%1,%2").arg(row).arg(column));
+    }
+    basicServer.enableRemoting(&simpleModel, "mergedModel", roles);
+
+    QScopedPointer<QAbstractItemModelReplica> model(client.acquireModel("mergedModel", QtRemoteObjects::FetchRootSize, roles));
+    QTRY_VERIFY(model->isInitialized());
+    QTRY_COMPARE(model->rowCount(), simpleModel.rowCount());
+    QTest::qWait(100);
+
+    QSignalSpy spy(model.data(), &QAbstractItemModelReplica::dataChanged);
+    // Two overlapping fetches, sent before any of them is answered
+    for (int row = 0; row <= 4; ++row)
+        model->data(model->index(row, 0));
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::MetaCall);
+    for (int row = 2; row <= 8; ++row)
+        model->data(model->index(row, 0));
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::MetaCall);
+
+    QTRY_VERIFY(model->hasData(model->index(8, 1), Qt::DisplayRole));
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+    const QModelIndex topLeft = spy.first().at(0).value<QModelIndex>();
+    const QModelIndex bottomRight = spy.first().at(1).value<QModelIndex>();
+    QCOMPARE(topLeft, model->index(0, 0));
+    QCOMPARE(bottomRight, model->index(8, 1));
+    QCOMPARE(spy.first().at(2).value<QList<int>>(), roles);
+    QCOMPARE(model->data(model->index(3, 1)), QVariant(QString("3,1")));
+}
+
+void TestModelView::testPersistedCache()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    _SETUP_TEST_
+    QCOMPARE(client.modelCacheRows(), 100);
+    client.setModelCacheDirectory(cacheDir.path());
+    client.setModelCacheRows(2);
+    QList<int> roles = { Qt::DisplayRole };
+    QStandardItemModel simpleModel(3, 2);
+    for (int row = 0; row < simpleModel.rowCount(); ++row) {
+        for (int column = 0; column < simpleModel.columnCount(); ++column)
+            simpleModel.setData(simpleModel.index(row, column), QString("%1,%2").arg(row).arg(column));
+    }
+    basicServer.enableRemoting(&simpleModel, "persistedModel", roles);
+
+    const QString cacheFile = QDir(cacheDir.path()).filePath("persistedModel.qtromodel");
+    {
+        QScopedPointer<QAbstractItemModelReplica> model(client.acquireModel("persistedModel", QtRemoteObjects::PrefetchData, roles));
+        QTRY_VERIFY(model->isInitialized());
+        QTRY_COMPARE(model->rowCount(), simpleModel.rowCount());
+        QTRY_VERIFY(model->hasData(model->index(2, 1), Qt::DisplayRole));
+        QVERIFY(!QFile::exists(cacheFile));
+    }
+    QVERIFY(QFile::exists(cacheFile));
+
+    // A node without a cache directory doesn't use it
+    QRemoteObjectNode uncached;
+    QScopedPointer<QAbstractItemModelReplica> empty(uncached.acquireModel("persistedModel", QtRemoteObjects::PrefetchData, roles));
+    QCOMPARE(empty->rowCount(), 0);
+
+    // Without a connection, the next replica starts with the persisted rows
+    QRemoteObjectNode offline;
+    offline.setModelCacheDirectory(cacheDir.path());
+    QScopedPointer<QAbstractItemModelReplica> model(offline.acquireModel("persistedModel", QtRemoteObjects::PrefetchData, roles));
+    QVERIFY(!model->isInitialized());
+    QCOMPARE(model->rowCount(), simpleModel.rowCount());
+    QCOMPARE(model->columnCount(), simpleModel.columnCount());
+    QCOMPARE(model->availableRoles(), roles);
+    QCOMPARE(model->data(model->index(0, 0)), QVariant(QString("0,0")));
+    QCOMPARE(model->data(model->index(1, 1)), QVariant(QString("1,1")));
+    QVERIFY(!model->hasData(model->index(2, 1), Qt::DisplayRole));
+
+    // and replaces it with the source's data once connected
+    simpleModel.setData(simpleModel.index(0, 0), QString("changed"));
+    offline.setRegistryUrl(registryServer.registryUrl());
+    QTRY_VERIFY(model->isInitialized());
+    QTRY_COMPARE(model->data(model->index(0, 0)), QVariant(QString("changed")));
+}
+
+// The key the replica stores its cache with
+static QByteArray persistedCacheKey(const QString &name, const QHash<int, QByteArray> &roleNames, int columnCount)
+{
+    QList<int> roles = roleNames.keys();
+    std::sort(roles.begin(), roles.end());
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << name << qint32(columnCount);
+    for (int role : roles)
+        out << qint32(role) << roleNames.value(role);
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+void TestModelView::testCorruptPersistedCache()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    const QHash<int, QByteArray> roleNames = { { Qt::DisplayRole, "display" } };
+    {
+        // A cache claiming more rows than are ever persisted
+        QFile file(QDir(cacheDir.path()).filePath("corruptModel.qtromodel"));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << quint32(0x5154524d) << quint8(3) << QString("corruptModel") << persistedCacheKey("corruptModel", roleNames, 1);
+        out << QList<int>{ Qt::DisplayRole } << roleNames << QSize(1, 1000000);
+        out << qint32(0) << qint32(0) << qint32(1000000);
+    }
+    {
+        // A cache of another source
+        QFile file(QDir(cacheDir.path()).filePath("otherModel.qtromodel"));
+        QVERIFY(QFile::copy(QDir(cacheDir.path()).filePath("corruptModel.qtromodel"), file.fileName()));
+    }
+    {
+        // A cache whose key doesn't match its roles
+        QFile file(QDir(cacheDir.path()).filePath("mismatchedModel.qtromodel"));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << quint32(0x5154524d) << quint8(3) << QString("mismatchedModel") << persistedCacheKey("mismatchedModel", roleNames, 2);
+        out << QList<int>{ Qt::DisplayRole } << roleNames << QSize(1, 1);
+        out << qint32(0) << qint32(0) << qint32(0);
+    }
+
+    QRemoteObjectNode offline;
+    offline.setModelCacheDirectory(cacheDir.path());
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Ignoring corrupt model cache"));
+    QScopedPointer<QAbstractItemModelReplica> corrupt(offline.acquireModel("corruptModel"));
+    QScopedPointer<QAbstractItemModelReplica> other(offline.acquireModel("otherModel"));
+    QScopedPointer<QAbstractItemModelReplica> mismatched(offline.acquireModel("mismatchedModel"));
+    QCOMPARE(corrupt->rowCount(), 0);
+    QCOMPARE(other->rowCount(), 0);
+    QCOMPARE(mismatched->rowCount(), 0);
+}
+
 void TestModelView::cleanup()
 {
     // wait for delivery of RemoveObject events to the source
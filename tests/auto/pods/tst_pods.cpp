@@ -39,6 +39,8 @@ class tst_pods : public QObject {
 private Q_SLOTS:
     void testConstructors();
     void testMarshalling();
+    void testVariantFormatCompatibility();
+    void testTypedMarshalling();
 };
 
 
@@ -77,6 +79,63 @@ void tst_pods::testMarshalling()
     }
 }
 
+void tst_pods::testVariantFormatCompatibility()
+{
+    // Use the version of QtRO connections, which lets properties skip the QVariant
+    const auto version = QDataStream::Qt_5_12;
+    const PodIFS pod(1, 2.5f, QStringLiteral("three"));
+
+    QByteArray expected;
+    {
+        QDataStream ds(&expected, QIODevice::WriteOnly);
+        ds.setVersion(version);
+        ds << QVariant(pod.i()) << QVariant(pod.f()) << QVariant(pod.s());
+    }
+
+    QByteArray ba;
+    {
+        QDataStream ds(&ba, QIODevice::WriteOnly);
+        ds.setVersion(version);
+        ds << pod;
+    }
+    QCOMPARE(ba, expected);
+
+    QDataStream ds(expected);
+    ds.setVersion(version);
+    PodIFS result;
+    ds >> result;
+    QCOMPARE(ds.status(), QDataStream::Ok);
+    QCOMPARE(result.i(), pod.i());
+    QCOMPARE(result.f(), pod.f());
+    QCOMPARE(result.s(), pod.s());
+}
+
+void tst_pods::testTypedMarshalling()
+{
+    const PodIFS pod(1, 2.5f, QStringLiteral("three"));
+
+    QByteArray ba;
+    {
+        QDataStream ds(&ba, QIODevice::WriteOnly);
+        QtRemoteObjects::copyStoredProperties(&pod, ds, QtRemoteObjects::TypedProperties);
+    }
+
+    QByteArray expected;
+    {
+        QDataStream ds(&expected, QIODevice::WriteOnly);
+        ds << pod.i() << pod.f() << pod.s();
+    }
+    QCOMPARE(ba, expected);
+
+    QDataStream ds(ba);
+    PodIFS result;
+    QtRemoteObjects::copyStoredProperties(ds, &result, QtRemoteObjects::TypedProperties);
+    QCOMPARE(ds.status(), QDataStream::Ok);
+    QCOMPARE(result.i(), pod.i());
+    QCOMPARE(result.f(), pod.f());
+    QCOMPARE(result.s(), pod.s());
+}
+
 QTEST_APPLESS_MAIN(tst_pods)
 
 #include "tst_pods.moc"
@@ -451,6 +451,12 @@ void ProxyTest::testTopLevelModel()
     QSignalSpy tracksSpy(replica, &QAbstractItemModelReplica::initialized);
     QVERIFY(tracksSpy.wait());
     QTRY_COMPARE(replica->rowCount(), model.rowCount());
+
+    // Data is fetched through the proxy, not read from its (initially empty) cache
+    for (int row = 0; row < model.rowCount(); ++row) {
+        const QModelIndex index = replica->index(row, 0);
+        QTRY_COMPARE(replica->data(index, Qt::DisplayRole), model.data(model.index(row, 0), Qt::DisplayRole));
+    }
 }
 
 QTEST_MAIN(ProxyTest)
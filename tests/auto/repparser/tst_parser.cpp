@@ -43,8 +43,12 @@ private Q_SLOTS:
     void testBasic();
     void testProperties_data();
     void testProperties();
+    void testPropertyNoCompare_data();
+    void testPropertyNoCompare();
     void testSlots_data();
     void testSlots();
+    void testCachedSlots_data();
+    void testCachedSlots();
     void testSignals_data();
     void testSignals();
     void testPods_data();
@@ -177,6 +181,50 @@ void tst_Parser::testProperties()
     QCOMPARE(property.persisted, expectedPersistence);
 }
 
+void tst_Parser::testPropertyNoCompare_data()
+{
+    QTest::addColumn<QString>("propertyDeclaration");
+    QTest::addColumn<ASTProperty::Modifier>("expectedModifier");
+    QTest::addColumn<bool>("expectedPersistence");
+    QTest::addColumn<bool>("expectedNoCompare");
+
+    QTest::newRow("default") << "PROP(QList<int> foo)" << ASTProperty::ReadPush << false << false;
+    QTest::newRow("nocompare") << "PROP(QList<int> foo NOCOMPARE)" << ASTProperty::ReadPush << false << true;
+    QTest::newRow("readonly, nocompare") << "PROP(QList<int> foo READONLY, NOCOMPARE)" << ASTProperty::ReadOnly << false << true;
+    QTest::newRow("nocompare, persisted") << "PROP(QList<int> foo NOCOMPARE, PERSISTED)" << ASTProperty::ReadPush << true << true;
+    QTest::newRow("withValue") << "PROP(int foo=1 READWRITE, NOCOMPARE)" << ASTProperty::ReadWrite << false << true;
+}
+
+void tst_Parser::testPropertyNoCompare()
+{
+    QFETCH(QString, propertyDeclaration);
+    QFETCH(ASTProperty::Modifier, expectedModifier);
+    QFETCH(bool, expectedPersistence);
+    QFETCH(bool, expectedNoCompare);
+
+    QTemporaryFile file;
+    file.open();
+    QTextStream stream(&file);
+    stream << "class TestClass" << Qt::endl;
+    stream << "{" << Qt::endl;
+    stream << propertyDeclaration << Qt::endl;
+    stream << "};" << Qt::endl;
+    file.seek(0);
+
+    RepParser parser(file);
+    QVERIFY(parser.parse());
+
+    const AST ast = parser.ast();
+    QCOMPARE(ast.classes.count(), 1);
+    const QList<ASTProperty> properties = ast.classes.first().properties;
+    QCOMPARE(properties.count(), 1);
+
+    const ASTProperty property = properties.first();
+    QCOMPARE(property.modifier, expectedModifier);
+    QCOMPARE(property.persisted, expectedPersistence);
+    QCOMPARE(property.noCompare, expectedNoCompare);
+}
+
 void tst_Parser::testSlots_data()
 {
     QTest::addColumn<QString>("slotDeclaration");
@@ -227,6 +275,56 @@ void tst_Parser::testSlots()
     QCOMPARE(QString("%1 %2(%3)").arg(slot.returnType).arg(slot.name).arg(slot.paramsAsString()), expectedSlot);
 }
 
+void tst_Parser::testCachedSlots_data()
+{
+    QTest::addColumn<QString>("slotDeclaration");
+    QTest::addColumn<QString>("expectedSlot");
+    QTest::addColumn<int>("expectedTtl");
+    QTest::addColumn<QString>("expectedInvalidatedBy");
+
+    QTest::newRow("cached") << "SLOT(QString nameForId(int id)) CACHED" << "QString nameForId(int id)" << 0 << QString();
+    QTest::newRow("cachedwithsemicolon") << "SLOT(QString nameForId(int id)) CACHED;" << "QString nameForId(int id)" << 0 << QString();
+    QTest::newRow("cachedwithttl") << "SLOT(QString nameForId(int id)) CACHED(ttl = 5000)" << "QString nameForId(int id)" << 5000 << QString();
+    QTest::newRow("cachedwithsignal") << "SLOT(QString nameForId(int id)) CACHED(invalidate=namesChanged)" << "QString nameForId(int id)" << 0 << "namesChanged";
+    QTest::newRow("cachedwithproperty") << "SLOT(QString nameForId(int id))CACHED ( ttl = 10 , invalidate = names );" << "QString nameForId(int id)" << 10 << "names";
+}
+
+void tst_Parser::testCachedSlots()
+{
+    QFETCH(QString, slotDeclaration);
+    QFETCH(QString, expectedSlot);
+    QFETCH(int, expectedTtl);
+    QFETCH(QString, expectedInvalidatedBy);
+
+    QTemporaryFile file;
+    file.open();
+    QTextStream stream(&file);
+    stream << "class TestClass" << Qt::endl;
+    stream << "{" << Qt::endl;
+    stream << "PROP(QStringList names)" << Qt::endl;
+    stream << "SIGNAL(namesChanged())" << Qt::endl;
+    stream << slotDeclaration << Qt::endl;
+    stream << "SLOT(int uncached())" << Qt::endl;
+    stream << "};" << Qt::endl;
+    file.seek(0);
+
+    RepParser parser(file);
+    QVERIFY(parser.parse());
+
+    const AST ast = parser.ast();
+    QCOMPARE(ast.classes.count(), 1);
+
+    const ASTClass astClass = ast.classes.first();
+    const QList<ASTFunction> slotsList = astClass.slotsList;
+    QCOMPARE(slotsList.count(), 2);
+    ASTFunction slot = slotsList.first();
+    QCOMPARE(QString("%1 %2(%3)").arg(slot.returnType).arg(slot.name).arg(slot.paramsAsString()), expectedSlot);
+    QVERIFY(slot.cached);
+    QCOMPARE(slot.cacheTtl, expectedTtl);
+    QCOMPARE(slot.cacheInvalidatedBy, expectedInvalidatedBy);
+    QVERIFY(!slotsList.last().cached);
+}
+
 void tst_Parser::testSignals_data()
 {
     QTest::addColumn<QString>("signalDeclaration");
@@ -492,6 +590,10 @@ void tst_Parser::testInvalid_data()
     QTest::newRow("signal_noargs") << "class Foo\n{\nSIGNAL()\n}" << ".?Unknown token encountered";
     QTest::newRow("slot_outsideclass") << "SLOT(void foo())" << ".?SLOT: Can only be used in class scope";
     QTest::newRow("slot_noargs") << "class Foo\n{\nSLOT()\n}" << ".?Unknown token encountered";
+    QTest::newRow("slot_cachedvoid") << "class Foo\n{\nSLOT(void foo()) CACHED\n}" << ".?SLOT: CACHED requires a return type .foo.";
+    QTest::newRow("slot_cachedbadttl") << "class Foo\n{\nSLOT(int foo()) CACHED(ttl = -1)\n}" << ".?SLOT: Invalid CACHED option: ttl = -1";
+    QTest::newRow("slot_cachedunknownoption") << "class Foo\n{\nSLOT(int foo()) CACHED(size = 3)\n}" << ".?SLOT: Invalid CACHED option: size = 3";
+    QTest::newRow("slot_cachedunknowninvalidator") << "class Foo\n{\nSLOT(int foo()) CACHED(invalidate = bar)\n}" << ".?SLOT: CACHED foo is invalidated by bar, which is no signal or changing property of Foo";
     QTest::newRow("model_outsideclass") << "MODEL foo" << ".?Unknown token encountered";
     QTest::newRow("class_outsideclass") << "CLASS foo" << ".?Unknown token encountered";
     QTest::newRow("preprecessor_line_inclass") << "class Foo\n{\n#define foo\n}" << ".?Unknown token encountered";
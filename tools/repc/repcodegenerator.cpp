@@ -100,6 +100,20 @@ static QList<ASTFunction> transformEnumParams(const ASTClass& classContext, cons
     return localList;
 }
 
+// The index of the signal dropping the cached replies of a CACHED slot, -1 without one
+static QString cacheInvalidatorIndex(const ASTClass &classContext, const QString &className, const ASTFunction &slot)
+{
+    if (slot.cacheInvalidatedBy.isEmpty())
+        return QStringLiteral("-1");
+    const QList<ASTFunction> signalsList = transformEnumParams(classContext, classContext.signalsList, className);
+    for (const ASTFunction &signal : signalsList) {
+        if (signal.name == slot.cacheInvalidatedBy)
+            return QStringLiteral("%1::staticMetaObject.indexOfSignal(\"%2(%3)\")").arg(className, signal.name, signal.paramsAsString(ASTFunction::Normalized));
+    }
+    // The parser only accepts signals and properties that change
+    return QStringLiteral("%1::staticMetaObject.property(%1::staticMetaObject.indexOfProperty(\"%2\")).notifySignalIndex()").arg(className, slot.cacheInvalidatedBy);
+}
+
 /*
   Returns \c true if the type is a built-in type.
 */
@@ -406,10 +420,16 @@ void RepCodeGenerator::generateSimpleSetter(QTextStream &out, const ASTProperty
         out << " override";
     out << Qt::endl;
     out << "    {" << Qt::endl;
-    out << "        if (" << property.name << " != m_" << property.name << ") {" << Qt::endl;
-    out << "            m_" << property.name << " = " << property.name << ";" << Qt::endl;
-    out << "            Q_EMIT " << property.name << "Changed(m_" << property.name << ");" << Qt::endl;
-    out << "        }" << Qt::endl;
+    // The argument is taken by value, so callers can move large values all the way into storage
+    if (property.noCompare) {
+        out << "        m_" << property.name << " = std::move(" << property.name << ");" << Qt::endl;
+        out << "        Q_EMIT " << property.name << "Changed(m_" << property.name << ");" << Qt::endl;
+    } else {
+        out << "        if (" << property.name << " != m_" << property.name << ") {" << Qt::endl;
+        out << "            m_" << property.name << " = std::move(" << property.name << ");" << Qt::endl;
+        out << "            Q_EMIT " << property.name << "Changed(m_" << property.name << ");" << Qt::endl;
+        out << "        }" << Qt::endl;
+    }
     out << "    }" << Qt::endl;
 }
 
@@ -860,8 +880,14 @@ void RepCodeGenerator::generateClass(Mode mode, QTextStream &out, const ASTClass
             out << "" << Qt::endl;
             out << "Q_SIGNALS:" << Qt::endl;
             for (const ASTProperty &property : astClass.properties) {
-                if (property.modifier != ASTProperty::Constant)
-                    out << "    void " << property.name << "Changed(" << fullyQualifiedTypeName(astClass, className, typeForMode(property, mode)) << " " << property.name << ");" << Qt::endl;
+                if (property.modifier == ASTProperty::Constant)
+                    continue;
+                const auto type = fullyQualifiedTypeName(astClass, className, typeForMode(property, mode));
+                // Sources emit their stored value, passing it by reference spares a copy of large types
+                if (mode == SOURCE && !property.isPointer)
+                    out << "    void " << property.name << "Changed(const " << type << " &" << property.name << ");" << Qt::endl;
+                else
+                    out << "    void " << property.name << "Changed(" << type << " " << property.name << ");" << Qt::endl;
             }
 
             const QList<ASTFunction> signalsList = transformEnumParams(astClass, astClass.signalsList, className);
@@ -892,7 +918,7 @@ void RepCodeGenerator::generateClass(Mode mode, QTextStream &out, const ASTClass
                     if (mode != REPLICA) {
                         out << "    virtual void push" << cap(property.name) << "(" << type << " " << property.name << ")" << Qt::endl;
                         out << "    {" << Qt::endl;
-                        out << "        set" << cap(property.name) << "(" << property.name << ");" << Qt::endl;
+                        out << "        set" << cap(property.name) << "(std::move(" << property.name << "));" << Qt::endl;
                         out << "    }" << Qt::endl;
                     } else {
                         out << "    void push" << cap(property.name) << "(" << type << " " << property.name << ")" << Qt::endl;
@@ -920,6 +946,8 @@ void RepCodeGenerator::generateClass(Mode mode, QTextStream &out, const ASTClass
                         out << "    QRemoteObjectPendingReply<" << returnType << "> " << slot.name << "(" << slot.paramsAsString()<< ")" << Qt::endl;
                     out << "    {" << Qt::endl;
                     out << "        static int __repc_index = " << className << "::staticMetaObject.indexOfSlot(\"" << slot.name << "(" << slot.paramsAsString(ASTFunction::Normalized) << ")\");" << Qt::endl;
+                    if (slot.cached && !isVoid)
+                        out << "        static int __repc_invalidator = " << cacheInvalidatorIndex(astClass, className, slot) << ";" << Qt::endl;
                     out << "        QVariantList __repc_args;" << Qt::endl;
                     const auto &paramNames = slot.paramNames();
                     if (!paramNames.isEmpty()) {
@@ -930,6 +958,9 @@ void RepCodeGenerator::generateClass(Mode mode, QTextStream &out, const ASTClass
                     }
                     if (isVoid)
                         out << "        send(QMetaObject::InvokeMetaMethod, __repc_index, __repc_args);" << Qt::endl;
+                    else if (slot.cached)
+                        out << "        return QRemoteObjectPendingReply<" << returnType << ">(sendWithCachedReply(__repc_index, __repc_args, "
+                            << slot.cacheTtl << ", __repc_invalidator));" << Qt::endl;
                     else
                         out << "        return QRemoteObjectPendingReply<" << returnType << ">(sendWithReply(QMetaObject::InvokeMetaMethod, __repc_index, __repc_args));" << Qt::endl;
                     out << "    }" << Qt::endl;